@@ -5,7 +5,17 @@
 
 // std
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+#ifdef SUPERSTRING_THREAD_SAFE
+#include <atomic>
+#endif
 
 /*-- declarations --*/
 
@@ -23,8 +33,18 @@ public:
         ASCII,
         UTF8,
         UTF16BE,
-        UTF32
-        // TODO: Support LE version of UTF-16
+        UTF32,
+        UTF16LE
+    };
+
+    //*-- Access
+    /**
+     * Expected way of reading the text data of a mapped file, see `SuperString::Map`.
+     */
+    enum class Access {
+        Normal,
+        Sequential, // from start to end, pages are read ahead and may be dropped soon after
+        Random // no read-ahead
     };
 
     //*-- Error
@@ -36,7 +56,8 @@ public:
         Unexpected, // Something that never happen, Unreachable code
         RangeError,
         InvalidByteSequence,
-        NotFound
+        NotFound,
+        IOError
     };
 
     //*-- Byte
@@ -52,8 +73,15 @@ public:
     template<class T, class E>
     class Result {
     private:
-        char *_ok;
-        char *_err;
+        enum class State: char {
+            Empty,
+            Ok,
+            Err
+        };
+
+        // the Ok or Err value lives inline, no heap allocation is made
+        alignas(T) alignas(E) char _storage[sizeof(T) > sizeof(E) ? sizeof(T) : sizeof(E)];
+        State _state;
 
     public:
         //*- Constructors
@@ -66,6 +94,8 @@ public:
 
         Result(const SuperString::Result<T, E> &other) /*copy*/;
 
+        Result(SuperString::Result<T, E> &&other) /*move*/;
+
         //*- Destructor
 
         ~Result();
@@ -90,7 +120,12 @@ public:
         /**
          * Returns the success value.
          */
-        T ok() const;
+        T ok() const &;
+
+        /**
+         * Returns the success value, moved out of this temporary result.
+         */
+        T ok() &&;
 
         //*- Setters
 
@@ -107,6 +142,246 @@ public:
         //*- Operators
 
         SuperString::Result<T, E> &operator=(const SuperString::Result<T, E> &other);
+
+        SuperString::Result<T, E> &operator=(SuperString::Result<T, E> &&other);
+
+    private:
+        void clear();
+    };
+
+private:
+    // forward declaration
+    class StringSequence;
+
+public:
+    //*-- Cursor
+    /**
+     * `Cursor` is a bidirectional iterator over the code units of a string,
+     * it keeps the path from the root sequence down to the current leaf so
+     * that moving to a neighbour is amortized O(1).
+     */
+    class Cursor {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef int reference;
+
+    private:
+        struct Frame {
+            const StringSequence *_sequence;
+            std::size_t _offset; // index in the string of the index 0 of `_sequence`
+            std::size_t _startIndex; // range of the string visible through `_sequence`
+            std::size_t _endIndex;
+        };
+
+        const StringSequence *_root;
+        std::size_t _length;
+        std::size_t _index;
+        Frame *_frames;
+        std::size_t _depth;
+        std::size_t _capacity;
+        // the text data holding the current code unit
+        const Byte *_bytes;
+        SuperString::Encoding _encoding;
+        const Byte *_data; // whole UTF-8 text data, when it may be malformed, NULL otherwise
+        const Byte *_end;
+        std::size_t _chunkStartIndex;
+        std::size_t _chunkEndIndex;
+
+    public:
+        //*- Constructors
+
+        Cursor();
+
+        Cursor(const SuperString::Cursor &other) /*copy*/;
+
+        //*- Destructor
+
+        ~Cursor();
+
+        //*- Getters
+
+        /**
+         * Returns the index of the code unit this cursor is on.
+         */
+        std::size_t index() const;
+
+        //*- Operators
+
+        /**
+         * Returns the code unit this cursor is on; on a malformed UTF-8 character, the same value as
+         * `codeUnitAt(index()).ok()`.
+         */
+        int operator*() const;
+
+        SuperString::Cursor &operator++();
+
+        SuperString::Cursor operator++(int);
+
+        SuperString::Cursor &operator--();
+
+        SuperString::Cursor operator--(int);
+
+        bool operator==(const SuperString::Cursor &other) const;
+
+        bool operator!=(const SuperString::Cursor &other) const;
+
+        SuperString::Cursor &operator=(const SuperString::Cursor &other);
+
+    private:
+        Cursor(const StringSequence *root, std::size_t index);
+
+        void seek(std::size_t index);
+
+        bool stepBack();
+
+        void push(const StringSequence *sequence, std::size_t offset, std::size_t startIndex, std::size_t endIndex);
+
+        void pop();
+
+        friend class SuperString;
+    };
+
+    //*-- Chunk
+    /**
+     * A contiguous run of the text data of a string, as it is stored in memory,
+     * UTF-32 data is made of native `int`s.
+     */
+    class Chunk {
+    private:
+        const Byte *_bytes;
+        std::size_t _memoryLength;
+        SuperString::Encoding _encoding;
+        std::size_t _length;
+
+    public:
+        //*- Constructors
+
+        Chunk(const SuperString::Byte *bytes, std::size_t memoryLength, SuperString::Encoding encoding,
+              std::size_t length);
+
+        //*- Getters
+
+        /**
+         * Returns the first byte of this chunk.
+         */
+        const SuperString::Byte *bytes() const;
+
+        /**
+         * Returns the number of bytes in this chunk.
+         */
+        std::size_t memoryLength() const;
+
+        /**
+         * Returns the encoding of the bytes of this chunk.
+         */
+        SuperString::Encoding encoding() const;
+
+        /**
+         * Returns the number of code units in this chunk.
+         */
+        std::size_t length() const;
+    };
+
+    //*-- ChunkCallback
+    /**
+     * A function called on each chunk of a string, returning false stops the iteration.
+     */
+    typedef std::function<bool(const SuperString::Chunk &)> ChunkCallback;
+
+    //*-- MatchCallback
+    /**
+     * A function called on each match of a pattern set, with the id of the pattern and the index
+     * where the match starts, returning false stops the iteration.
+     */
+    typedef std::function<bool(std::size_t, std::size_t)> MatchCallback;
+
+    //*-- RangeCallback
+    /**
+     * A function called on each range of a string, with its start index, inclusive, and its end index,
+     * exclusive, returning false stops the iteration.
+     */
+    typedef std::function<bool(std::size_t, std::size_t)> RangeCallback;
+
+    //*-- StringCallback
+    /**
+     * A function called on each string of a sequence of strings, returning false stops the iteration.
+     */
+    typedef std::function<bool(const SuperString &)> StringCallback;
+
+    //*-- PatternSet
+    /**
+     * `PatternSet` is a set of patterns compiled into an Aho-Corasick automaton over code units,
+     * so that all of them are searched in a single pass over a string.
+     */
+    class PatternSet {
+    private:
+        static const std::size_t ASCII_TARGETS_LIMIT = 1 << 20; // entries of the table of ASCII transitions
+
+        std::size_t _count;
+        std::size_t *_lengths;
+        std::size_t *_nextPatterns; // the next pattern equal to each pattern, or `_count`
+        // the trie of the patterns, its states are numbered in breadth-first order from the root 0,
+        // and the edges of each state are sorted by code unit
+        std::size_t _stateCount;
+        unsigned int *_edgeStarts; // the edges of the state `s` are in [_edgeStarts[s], _edgeStarts[s + 1])
+        int *_edgeCodeUnits;
+        unsigned int *_edgeTargets;
+        unsigned int *_fails; // the state of the longest proper suffix of each state
+        std::size_t *_patterns; // the first pattern ending at each state, or `_count`
+        unsigned int *_outputs; // the first state along the fails of each state where a pattern ends, or 0
+        unsigned int _rootTargets[128]; // the edges of the root for ASCII code units, or 0
+        // the transitions of every state for ASCII code units, grouped in classes of code units that
+        // behave the same, NULL when the set is too large for the table to stay in cache
+        unsigned int *_asciiTargets;
+        Byte _asciiClasses[128]; // the class 0 is for code units that are in no pattern
+        std::size_t _classCount;
+
+    public:
+        //*- Constructors
+
+        /**
+         * Compiles the [count] [patterns], the id of a pattern is its position in [patterns],
+         * empty patterns never match.
+         */
+        PatternSet(const SuperString *patterns, std::size_t count);
+
+        PatternSet(const SuperString::PatternSet &other) = delete;
+
+        //*- Destructor
+
+        ~PatternSet();
+
+        //*- Getters
+
+        /**
+         * Returns the number of patterns in this set.
+         */
+        std::size_t count() const;
+
+        //*- Operators
+
+        SuperString::PatternSet &operator=(const SuperString::PatternSet &other) = delete;
+
+    private:
+        /**
+         * Returns the target of the edge of [state] for [codeUnit], or 0 if there is none.
+         */
+        unsigned int target(unsigned int state, int codeUnit) const;
+
+        /**
+         * Returns the state reached from [state] after [codeUnit].
+         */
+        unsigned int advance(unsigned int state, int codeUnit) const;
+
+        /**
+         * Calls [callback] on the matches in [string], see `SuperString::forEachMatch`.
+         */
+        bool match(const SuperString &string, const SuperString::MatchCallback &callback) const;
+
+        friend class SuperString;
     };
 
     //*-- SuperString
@@ -123,6 +398,11 @@ public:
      */
     SuperString(const SuperString &other) /*copy*/;
 
+    /**
+     * Constructs a new string by taking the content of [other], that is left empty.
+     */
+    SuperString(SuperString &&other) noexcept /*move*/;
+
     //*- Destructor
 
     /**
@@ -147,6 +427,11 @@ public:
      */
     std::size_t length() const;
 
+    /**
+     * Returns the depth of the tree of sequences this string is made of, 0 for a single leaf.
+     */
+    std::size_t depth() const;
+
     //*- Methods
 
     /**
@@ -154,6 +439,28 @@ public:
      */
     SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const;
 
+    /**
+     * Returns a cursor on the first code unit of this string.
+     */
+    SuperString::Cursor begin() const;
+
+    /**
+     * Returns a cursor past the last code unit of this string.
+     */
+    SuperString::Cursor end() const;
+
+    /**
+     * Calls [callback] on each chunk of this string, in order and without copying
+     * any data, returns false if [callback] stopped the iteration.
+     */
+    bool forEachChunk(const SuperString::ChunkCallback &callback) const;
+
+    /**
+     * Calls [callback] on each chunk of the substring from [startIndex] to [endIndex],
+     * returns false if [callback] stopped the iteration or if the range is invalid.
+     */
+    bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex, std::size_t endIndex) const;
+
     /**
      * Compares this to [other].
      */
@@ -161,9 +468,10 @@ public:
 
     /**
      * Returns the position of the first occurrence of [other] in this string,
-     * if not found, it returns SuperString::Error::NotFound.
+     * if not found, it returns SuperString::Error::NotFound. The text data is scanned by [threads]
+     * threads, see `forEachPiece`.
      */
-    SuperString::Result<std::size_t, SuperString::Error> indexOf(SuperString other) const;
+    SuperString::Result<std::size_t, SuperString::Error> indexOf(SuperString other, std::size_t threads = 1) const;
 
     /**
      * Returns the position of the last occurrence of [other] in this string,
@@ -171,6 +479,67 @@ public:
      */
     SuperString::Result<std::size_t, SuperString::Error> lastIndexOf(SuperString other) const;
 
+    /**
+     * Calls [callback] on each occurrence of the patterns of [patterns] in this string, overlapping ones
+     * included, in the order they end, returns false if [callback] stopped the iteration.
+     */
+    bool forEachMatch(const SuperString::PatternSet &patterns, const SuperString::MatchCallback &callback) const;
+
+    /**
+     * Returns a hash of the code units of this string, that doesn't depend on their encoding nor on how
+     * the string was built, computed once per sequence.
+     */
+    std::size_t hash() const;
+
+    /**
+     * Calls [callback] on the range of each piece of this string between occurrences of [delimiter],
+     * empty ones included, returns false if [callback] stopped the iteration. An empty [delimiter]
+     * doesn't split the string. When [threads] isn't 1, the text data is scanned in parallel by that
+     * many threads, one per core when 0, and [callback] is still called in order by the calling thread.
+     */
+    bool forEachPiece(const SuperString &delimiter, const SuperString::RangeCallback &callback,
+                      std::size_t threads = 1) const;
+
+    /**
+     * Calls [callback] on the range of each line of this string, without its "\n" or "\r\n" terminator,
+     * returns false if [callback] stopped the iteration. A terminator at the end doesn't start a line.
+     * The text data is scanned by [threads] threads, see `forEachPiece`.
+     */
+    bool forEachLine(const SuperString::RangeCallback &callback, std::size_t threads = 1) const;
+
+    /**
+     * Returns the number of occurrences of [other] in this string that don't overlap, the ones that
+     * `forEachPiece` splits at. The text data is scanned by [threads] threads, see `forEachPiece`.
+     */
+    std::size_t count(const SuperString &other, std::size_t threads = 1) const;
+
+    /**
+     * Calls [callback] on each piece of this string between occurrences of [delimiter], see `forEachPiece`,
+     * as a substring sharing the text data of this string.
+     */
+    bool split(const SuperString &delimiter, const SuperString::StringCallback &callback,
+               std::size_t threads = 1) const;
+
+    /**
+     * Appends the pieces of this string between occurrences of [delimiter] to [pieces], see `split`, and
+     * returns their number. When [isBatched], they are counted first so that their sequence nodes, and
+     * the room in [pieces], are allocated at once.
+     */
+    std::size_t split(const SuperString &delimiter, std::vector<SuperString> &pieces, bool isBatched = false,
+                      std::size_t threads = 1) const;
+
+    /**
+     * Calls [callback] on each line of this string, see `forEachLine`, as a substring sharing the text
+     * data of this string.
+     */
+    bool splitLines(const SuperString::StringCallback &callback, std::size_t threads = 1) const;
+
+    /**
+     * Appends the lines of this string to [lines], see `splitLines`, and returns their number, batched
+     * as in `split`.
+     */
+    std::size_t splitLines(std::vector<SuperString> &lines, bool isBatched = false, std::size_t threads = 1) const;
+
     /**
      * Returns the substring of this sequence that extends
      * from [startIndex], inclusive, to [endIndex], exclusive.
@@ -192,6 +561,18 @@ public:
      */
     bool print(std::ostream &stream, std::size_t startIndex, std::size_t endIndex) const;
 
+    /**
+     * Writes the whole string in UTF-8 to the file descriptor [fd], in a few `writev` calls that take
+     * large chunks from where they are, and returns the number of bytes written, otherwise
+     * `SuperString::Error::IOError` with `errno` telling why.
+     */
+    SuperString::Result<std::size_t, SuperString::Error> writeTo(int fd) const;
+
+    /**
+     * Same as above, to the file descriptor of [file] once its buffered output is flushed.
+     */
+    SuperString::Result<std::size_t, SuperString::Error> writeTo(std::FILE *file) const;
+
     /**
      * Returns the string without any leading and trailing whitespace.
      */
@@ -207,6 +588,14 @@ public:
      */
     SuperString trimRight() const;
 
+    /**
+     * Returns the string as a single leaf, its text copied in the narrowest encoding that holds all
+     * its characters: ASCII, UTF-16BE without surrogate pairs, or UTF-32, UTF-8 if [isUTF8]. Unless
+     * thread-safe, the sequence of this string then refers to the leaf, for all the strings sharing it.
+     * A string that is already a leaf is returned as it is, if in UTF-8 when [isUTF8].
+     */
+    SuperString flatten(bool isUTF8 = false) const;
+
     // TODO: delete this two methods
     std::size_t keepingCost() const;
 
@@ -219,122 +608,538 @@ public:
      */
     SuperString operator+(const SuperString &other) const;
 
-    /**
-     * Creates a new string by concatenating this string with itself a
-     * number of [times].
-     */
-    SuperString operator*(std::size_t times) const;
+    /**
+     * Creates a new string by concatenating this string with itself a
+     * number of [times].
+     */
+    SuperString operator*(std::size_t times) const;
+
+    /**
+     * Assigns [other] to this string.
+     */
+    SuperString &operator=(const SuperString &other);
+
+    /**
+     * Assigns the content of [other] to this string, [other] is left empty.
+     */
+    SuperString &operator=(SuperString &&other) noexcept;
+
+    /**
+     * Returns `SuperString::TRUE` if this is equal to [other].
+     */
+    bool operator==(const SuperString &other) const;
+
+    //*- Statics
+
+    /**
+     * Creates a string for the given `const char *` [chars] (UTF-8 default as encoding),
+     * without copying the data of [chars].
+     */
+    static SuperString Const(const char *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+
+    /**
+     * Creates a string for the given `const int *` [chars] (UTF-32 default as encoding),
+     * without copying the data of [chars].
+     */
+    static SuperString Const(const int *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF32);
+
+    /**
+     * Creates a string for the given `const SuperString::Byte *` [bytes] (UTF-8 default as encoding),
+     * without copying the data of [bytes].
+     */
+    static SuperString
+    Const(const SuperString::Byte *bytes, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+
+    /**
+     * Creates a string for the given `const char *` [chars] (UTF-8 default as encoding),
+     * by copying the data of [chars].
+     */
+    static SuperString Copy(const char *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+
+    /**
+     * Creates a string for the given `const int *` [chars] (UTF-32 default as encoding),
+     * by copying the data of [chars].
+     */
+    static SuperString Copy(const int *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF32);
+
+    /**
+     * Creates a string for the given `const SuperString::Byte *` [bytes] (UTF-8 default as encoding),
+     * by copying the data of [bytes].
+     */
+    static SuperString
+    Copy(const SuperString::Byte *bytes, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+
+    /**
+     * Creates a string for the [memoryLength] bytes at [chars] (UTF-8 default as encoding), without copying
+     * them. No terminator is needed nor searched, the bytes may hold NULs, which are characters as any other.
+     */
+    static SuperString
+    Const(const char *chars, std::size_t memoryLength, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+
+    /**
+     * Same as `Const(const char *, std::size_t, ...)`, for `const SuperString::Byte *` [bytes].
+     */
+    static SuperString Const(const SuperString::Byte *bytes, std::size_t memoryLength,
+                             SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+
+    /**
+     * Creates a string for the [memoryLength] bytes at [chars] (UTF-8 default as encoding), by copying
+     * them. No terminator is needed nor searched, the bytes may hold NULs, which are characters as any other.
+     */
+    static SuperString
+    Copy(const char *chars, std::size_t memoryLength, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+
+    /**
+     * Same as `Copy(const char *, std::size_t, ...)`, for `const SuperString::Byte *` [bytes].
+     */
+    static SuperString Copy(const SuperString::Byte *bytes, std::size_t memoryLength,
+                            SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+
+    /**
+     * Creates a string for the [memoryLength] bytes of UTF-16 data at [chars], without copying them,
+     * in the byte order told by their byte order mark, which is not part of the string. Without one,
+     * the data is in the byte order of [encoding], `SuperString::Encoding::UTF16BE` as Unicode assumes.
+     */
+    static SuperString ConstUTF16(const char *chars, std::size_t memoryLength,
+                                  SuperString::Encoding encoding = SuperString::Encoding::UTF16BE);
+
+    /**
+     * Same as `ConstUTF16(const char *, ...)`, for `const SuperString::Byte *` [bytes].
+     */
+    static SuperString ConstUTF16(const SuperString::Byte *bytes, std::size_t memoryLength,
+                                  SuperString::Encoding encoding = SuperString::Encoding::UTF16BE);
+
+    /**
+     * Same as `ConstUTF16(const char *, ...)`, by copying the bytes of [chars].
+     */
+    static SuperString CopyUTF16(const char *chars, std::size_t memoryLength,
+                                 SuperString::Encoding encoding = SuperString::Encoding::UTF16BE);
+
+    /**
+     * Same as `CopyUTF16(const char *, ...)`, for `const SuperString::Byte *` [bytes].
+     */
+    static SuperString CopyUTF16(const SuperString::Byte *bytes, std::size_t memoryLength,
+                                 SuperString::Encoding encoding = SuperString::Encoding::UTF16BE);
+
+    /**
+     * Creates a string for the given `const char *` [chars] (UTF-8 default as encoding),
+     * without copying the data of [chars], if it is well-formed. Otherwise returns
+     * `SuperString::Error::InvalidByteSequence`, and sets [invalidOffset], when given,
+     * to the byte offset of the first ill-formed sequence.
+     */
+    static SuperString::Result<SuperString, SuperString::Error>
+    ConstValidated(const char *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF8,
+                   std::size_t *invalidOffset = NULL);
+
+    /**
+     * Same as `ConstValidated(const char *, ...)`, for `const int *` [chars] (UTF-32 default as encoding).
+     */
+    static SuperString::Result<SuperString, SuperString::Error>
+    ConstValidated(const int *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF32,
+                   std::size_t *invalidOffset = NULL);
+
+    /**
+     * Same as `ConstValidated(const char *, ...)`, for `const SuperString::Byte *` [bytes].
+     */
+    static SuperString::Result<SuperString, SuperString::Error>
+    ConstValidated(const SuperString::Byte *bytes, SuperString::Encoding encoding = SuperString::Encoding::UTF8,
+                   std::size_t *invalidOffset = NULL);
+
+    /**
+     * Creates a string for the given `const char *` [chars] (UTF-8 default as encoding),
+     * by copying the data of [chars], if it is well-formed. Otherwise returns
+     * `SuperString::Error::InvalidByteSequence`, and sets [invalidOffset], when given,
+     * to the byte offset of the first ill-formed sequence.
+     */
+    static SuperString::Result<SuperString, SuperString::Error>
+    CopyValidated(const char *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF8,
+                  std::size_t *invalidOffset = NULL);
+
+    /**
+     * Same as `CopyValidated(const char *, ...)`, for `const int *` [chars] (UTF-32 default as encoding).
+     */
+    static SuperString::Result<SuperString, SuperString::Error>
+    CopyValidated(const int *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF32,
+                  std::size_t *invalidOffset = NULL);
+
+    /**
+     * Same as `CopyValidated(const char *, ...)`, for `const SuperString::Byte *` [bytes].
+     */
+    static SuperString::Result<SuperString, SuperString::Error>
+    CopyValidated(const SuperString::Byte *bytes, SuperString::Encoding encoding = SuperString::Encoding::UTF8,
+                  std::size_t *invalidOffset = NULL);
+
+    /**
+     * Creates a string for the text data of the file at [path] (UTF-8 default as encoding), mapped
+     * read-only in memory and unmapped with the string, so that only the pages read are loaded,
+     * with the system told about the expected [access]. Otherwise returns `SuperString::Error::IOError`,
+     * `errno` telling why. The text data is the whole file, NULs included, and the file must not
+     * shrink while mapped.
+     */
+    static SuperString::Result<SuperString, SuperString::Error>
+    Map(const char *path, SuperString::Encoding encoding = SuperString::Encoding::UTF8,
+        SuperString::Access access = SuperString::Access::Normal);
+
+    /**
+     * Sets the functions that the memory of sequence nodes is taken from, and given back to,
+     * `std::malloc` and `std::free` by default. Should be called before any string is created.
+     * Small nodes are taken in blocks, only given back by `trimNodes`.
+     */
+    static void setAllocator(void *(*allocate)(std::size_t size), void (*deallocate)(void *pointer));
+
+    /**
+     * Returns the number of sequence nodes currently alive.
+     */
+    static std::size_t liveNodes();
+
+    /**
+     * Returns the largest number of sequence nodes that were alive at once.
+     */
+    static std::size_t peakNodes();
+
+    /**
+     * Gives the blocks of sequence nodes that are all free back to the allocator, and returns
+     * the number of bytes given back. The free nodes kept by other running threads are left alone.
+     */
+    static std::size_t trimNodes();
+
+private:
+    // forward declaration
+    class ReferenceStringSequence;
+
+    class Finder;
+
+    class CopyASCIISequence;
+
+    class CopyUTF8Sequence;
+
+    template<class Codec>
+    class CopyUTF16Sequence;
+
+    class CopyUTF32Sequence;
+
+    class UTF16BE;
+
+    class UTF16LE;
+
+    //*-- SuperString
+    StringSequence *_sequence;
+
+    //*- Constructors
+
+    SuperString(StringSequence *sequence);
+
+    //*- Methods
+
+    /**
+     * Returns the substring from [startIndex] to [endIndex], an empty leaf when it is empty, and this
+     * string itself when it is the whole string.
+     */
+    SuperString piece(std::size_t startIndex, std::size_t endIndex) const;
+
+    /**
+     * Calls [callback] on the index of each occurrence of [codeUnit], and whether it follows the ASCII
+     * code unit [previous], the text data being scanned by [threads] threads, see `forEachPiece`.
+     */
+    bool forEachBreak(int codeUnit, int previous, const std::function<bool(std::size_t, bool)> &callback,
+                      std::size_t threads) const;
+
+    /**
+     * Finds the breaks of `forEachBreak` with [threads] threads, into [breaks] for each task, as their index
+     * relative to the task shifted left, plus whether they follow [previous], the index of the first
+     * character of each task, then the length of this string, being in [shifts]. Returns false when the
+     * string is too short for more than one task.
+     */
+    bool findBreaks(int codeUnit, int previous, std::size_t threads, std::vector<std::vector<std::size_t>> &breaks,
+                    std::vector<std::size_t> &shifts) const;
+
+    /**
+     * Returns the number of occurrences of [codeUnit], the text data being scanned by [threads] threads.
+     */
+    std::size_t countBreaks(int codeUnit, std::size_t threads) const;
+
+    /**
+     * Appends to [pieces] the pieces between the breaks found by `findBreaks`, or the lines when [isLines],
+     * and returns their number, their substrings being made by the tasks too, or returns `(std::size_t) -1`
+     * when the string is too short for more than one task.
+     */
+    std::size_t splitBreaks(int codeUnit, int previous, bool isLines, std::vector<SuperString> &pieces,
+                            std::size_t threads) const;
+
+    /**
+     * Calls [callback] on the breaks in [chunk], see `forEachBreak`, with memchr over ASCII and UTF-8 data
+     * when [codeUnit] is ASCII, [index] being the one of its first character and [last] the code unit before
+     * it, updated to its last one.
+     */
+    static bool scanBreaks(const SuperString::Chunk &chunk, std::size_t index, int codeUnit, int previous, int &last,
+                           const std::function<bool(std::size_t, bool)> &callback);
+
+    /**
+     * Calls [callback] on the index of each occurrence of the needle of [finder] that doesn't overlap
+     * the previous one, the text data being scanned by [threads] threads, see `forEachPiece`.
+     */
+    bool forEachOccurrence(const SuperString::Finder &finder, const std::function<bool(std::size_t)> &callback,
+                           std::size_t threads) const;
+
+    /**
+     * Returns the index of the first occurrence of the needle of [finder], the text data being scanned
+     * by [threads] threads, see `forEachPiece`.
+     */
+    SuperString::Result<std::size_t, SuperString::Error>
+    findFirst(const SuperString::Finder &finder, std::size_t threads) const;
+
+    /**
+     * Calls [callback] on the index of each occurrence of the needle of [finder] that starts in the
+     * segments [first, last) of [segments], relative to the first one, and returns the number of
+     * characters in these segments, or up to the occurrence where [callback] stopped.
+     */
+    static std::size_t scanOccurrences(const SuperString::Finder &finder, const std::vector<SuperString::Chunk> &segments,
+                                       std::size_t first, std::size_t last,
+                                       const std::function<bool(std::size_t)> &callback);
+
+    //*-- Parallel scans (internal)
+    static const std::size_t PARTITION_SIZE = 1 << 18; // bytes of text data scanned by each task
+
+    /**
+     * Cuts the text data of this string at character boundaries into [segments], grouped in tasks of
+     * about `PARTITION_SIZE` bytes, the ones of the task `t` being in [tasks[t], tasks[t + 1]). The
+     * length of a segment cut from a larger chunk is counted by its task, see `countSegment`.
+     */
+    void partition(std::vector<SuperString::Chunk> &segments, std::vector<std::size_t> &tasks) const;
+
+    /**
+     * Returns [segment] with its length, counted if it wasn't.
+     */
+    static SuperString::Chunk countSegment(const SuperString::Chunk &segment);
+
+    /**
+     * Calls [task] on each number of [0, count), from up to [threads] threads that take the next number
+     * when done with theirs, the calling thread included, one per core when 0.
+     */
+    static void runTasks(std::size_t count, std::size_t threads, const std::function<void(std::size_t)> &task);
+
+    //*-- Atomic<T> (internal)
+    /**
+     * The type of the fields that may be written while the sequence is shared,
+     * atomic when built with `SUPERSTRING_THREAD_SAFE`.
+     */
+#ifdef SUPERSTRING_THREAD_SAFE
+    template<class T>
+    using Atomic = std::atomic<T>;
+#else
+    template<class T>
+    using Atomic = T;
+#endif
+
+    //*-- NodePool (internal)
+    /**
+     * Free lists of sequence nodes by size class, refilled with slabs from the backing
+     * allocator, one set of lists for each thread when thread-safe. A thread keeps at most
+     * `CACHE_LIMIT` free nodes of a class, the others go to lists shared by all threads, as do
+     * the lists of a finished thread. Blocks are given back by `trim`, once all their nodes are free.
+     */
+    class NodePool {
+    public:
+        static const std::size_t GRANULARITY = 16;
+        static const std::size_t CLASSES = 10; // nodes up to 160 bytes, larger ones come from the allocator
+        static const std::size_t SLAB_SIZE = 4096;
+        static const std::size_t CACHE_LIMIT = 512;
+
+    private:
+        struct FreeNode {
+            FreeNode *_next;
+        };
+
+        // the head of a block taken from the allocator, its nodes follow
+        struct Block {
+            Block *_next;
+            std::size_t _nodeSize;
+            std::size_t _count;
+            std::size_t _free; // only counted while trimming
+        };
+
+        static const std::size_t HEADER_SIZE = (sizeof(Block) + GRANULARITY - 1) / GRANULARITY * GRANULARITY;
+
+        struct Cache {
+            FreeNode *_lists[CLASSES];
+            std::size_t _counts[CLASSES];
+
+            //*- Constructors
+
+            Cache();
+
+            //*- Destructor
+
+            ~Cache();
+        };
+
+    public:
+        //*- Methods
+
+        static void *allocate(std::size_t size);
+
+        static void deallocate(void *pointer, std::size_t size);
+
+        /**
+         * Makes sure that the free list of this thread holds [count] nodes of [size] bytes, the missing
+         * ones taken from the backing allocator at once.
+         */
+        static void reserve(std::size_t size, std::size_t count);
+
+        /**
+         * Allocates [count] nodes of [size] bytes into [nodes], the free ones of this thread first, then the
+         * missing ones taken from the backing allocator at once.
+         */
+        static void allocateMany(std::size_t size, std::size_t count, void **nodes);
+
+        /**
+         * Gives the blocks whose nodes are all free back to the allocator, and returns their size in bytes.
+         */
+        static std::size_t trim();
+
+    private:
+        static void *(*_allocate)(std::size_t size);
+        static void (*_deallocate)(void *pointer);
+        static FreeNode *_shared[CLASSES]; // nodes over the limit of a thread, and lists left by finished threads
+        static Block *_blocks;
+        static Atomic<std::size_t> _liveNodes;
+        static Atomic<std::size_t> _peakNodes;
 
-    /**
-     * Assigns [other] to this string.
-     */
-    SuperString &operator=(const SuperString &other);
+        static Cache &cache();
 
-    /**
-     * Returns `SuperString::TRUE` if this is equal to [other].
-     */
-    bool operator==(const SuperString &other) const;
+        static FreeNode *refill(std::size_t sizeClass, std::size_t *count);
 
-    //*- Statics
+        /**
+         * Takes a block of [count] nodes of [nodeSize] bytes from the allocator, and returns its first node.
+         */
+        static Byte *allocateBlock(std::size_t nodeSize, std::size_t count);
 
-    /**
-     * Creates a string for the given `const char *` [chars] (UTF-8 default as encoding),
-     * without copying the data of [chars].
-     */
-    static SuperString Const(const char *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+        /**
+         * Moves the free nodes of [sizeClass] in [cache] to the shared list, all but [kept] of them.
+         */
+        static void flush(Cache &cache, std::size_t sizeClass, std::size_t kept);
 
-    /**
-     * Creates a string for the given `const int *` [chars] (UTF-32 default as encoding),
-     * without copying the data of [chars].
-     */
-    static SuperString Const(const int *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF32);
+        static void count(bool isAllocation, std::size_t nodes = 1);
 
-    /**
-     * Creates a string for the given `const SuperString::Byte *` [bytes] (UTF-8 default as encoding),
-     * without copying the data of [bytes].
-     */
-    static SuperString
-    Const(const SuperString::Byte *bytes, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+        friend class SuperString;
+    };
 
+    //*-- UTF8Index (internal)
     /**
-     * Creates a string for the given `const char *` [chars] (UTF-8 default as encoding),
-     * by copying the data of [chars].
+     * A sparse codepoint-to-byte-offset index over UTF-8 data, built lazily on
+     * first lookup: one checkpoint every `UTF8Index::STEP` codepoints, plus the
+     * last resolved position so that sequential lookups don't decode anything twice
+     * (not kept when thread-safe).
      */
-    static SuperString Copy(const char *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+    class UTF8Index {
+    private:
+        enum class Status {
+            NotBuilt,
+            Built,
+            Identity // pure ASCII data, codepoint index == byte offset
+        };
 
-    /**
-     * Creates a string for the given `const int *` [chars] (UTF-32 default as encoding),
-     * by copying the data of [chars].
-     */
-    static SuperString Copy(const int *chars, SuperString::Encoding encoding = SuperString::Encoding::UTF32);
+        std::size_t *_checkpoints;
+        std::size_t _lastIndex;
+        std::size_t _lastOffset;
+        Atomic<Status> _status;
 
-    /**
-     * Creates a string for the given `const SuperString::Byte *` [bytes] (UTF-8 default as encoding),
-     * by copying the data of [bytes].
-     */
-    static SuperString
-    Copy(const SuperString::Byte *bytes, SuperString::Encoding encoding = SuperString::Encoding::UTF8);
+    public:
+        static const std::size_t STEP = 128;
 
-private:
-    // forward declaration
-    class StringSequence;
+        //*- Constructors
 
-    class ReferenceStringSequence;
+        UTF8Index();
 
-    class CopyASCIISequence;
+        //*- Destructor
 
-    class CopyUTF8Sequence;
+        ~UTF8Index();
 
-    class CopyUTF16BESequence;
+        //*- Getters
 
-    class CopyUTF32Sequence;
+        /**
+         * Returns the memory used by the checkpoints of an index over [length] codepoints.
+         */
+        std::size_t memoryLength(std::size_t length) const;
 
-    //*-- SuperString
-    StringSequence *_sequence;
+        //*- Methods
 
-    //*- Constructors
+        /**
+         * Returns the byte offset of the codepoint at [index] within [bytes],
+         * which holds [length] codepoints; [index] may be equal to [length].
+         */
+        std::size_t offset(const SuperString::Byte *bytes, std::size_t length, std::size_t index) const;
 
-    SuperString(StringSequence *sequence);
+    private:
+        void build(const SuperString::Byte *bytes, std::size_t length);
+    };
 
-    //*-- SingleLinkedList<E> (internal)
-    template<class E>
-    class SingleLinkedList {
-    public:
-        // forward declaration
-        template<class Ei>
-        class Node;
+    //*-- Finder (internal)
+    /**
+     * Searches a needle in a range of a sequence: inside each chunk by a byte search for the needle
+     * in the encoding of the chunk, and across chunk boundaries by following the partial matches
+     * code point by code point, as in Knuth-Morris-Pratt.
+     */
+    class Finder {
+    private:
+        int *_codeUnits;
+        std::size_t *_fallbacks; // length of the longest proper border of each prefix of the needle
+        std::size_t _length;
+        Byte *_utf8; // NULL when the needle has code units out of Unicode
+        std::size_t _utf8Length;
+        Byte *_utf16be;
+        Byte *_utf16le;
+        std::size_t _utf16Length; // of both byte orders
+        bool _isASCII;
 
-        Node<E> *_head;
-        Node<E> *_tail;
     public:
         //*- Constructors
 
-        SingleLinkedList();
+        Finder(const SuperString &needle);
 
         //*- Destructor
 
-        ~SingleLinkedList();
+        ~Finder();
 
         //*- Getters
 
+        /**
+         * Returns the length of the needle.
+         */
         std::size_t length() const;
 
         //*- Methods
 
-        void push(E value);
+        /**
+         * Returns the index of the first occurrence of the needle within [startIndex, endIndex)
+         * of [sequence], or of the last one when [isLast], otherwise `SuperString::Error::NotFound`.
+         */
+        SuperString::Result<std::size_t, SuperString::Error>
+        find(const StringSequence *sequence, std::size_t startIndex, std::size_t endIndex, bool isLast) const;
 
-        void remove(E value);
+        /**
+         * Calls [callback] on the index of each occurrence of the needle that ends in [chunk], overlapping
+         * ones included, [index] being the one of the first character of [chunk], and [state] the length of
+         * the partial match before it, updated to the one after it. Returns false if [callback] stopped.
+         */
+        bool scan(const SuperString::Chunk &chunk, std::size_t index, std::size_t &state,
+                  const std::function<bool(std::size_t)> &callback) const;
 
-        template<class Ei>
-        class Node {
-        public:
-            Ei _data;
-            Node<E> *_next;
+    private:
+        /**
+         * Returns the length of the longest prefix of the needle matched after [codeUnit],
+         * [state] being the one matched before.
+         */
+        std::size_t advance(std::size_t state, int codeUnit) const;
 
-            //*- Constructors
+        /**
+         * Decodes the character at [pointer], before [end], in the given [encoding], and moves [pointer] past it.
+         */
+        static int decode(const Byte *&pointer, const Byte *end, SuperString::Encoding encoding);
 
-            Node(E data);
-        };
+        friend class SuperString;
+
+        friend class PatternSet;
     };
 
     //*-- Pair<T, U>
@@ -363,17 +1168,78 @@ private:
         void second(U $1);
     };
 
+    //*-- Summary (internal)
+    /**
+     * What a reference sequence knows about its subtree, computed once
+     * when it is created and kept up to date when it is reconstructed.
+     */
+    struct Summary {
+        std::size_t _length; // in codepoints
+        std::size_t _memoryLength; // bytes of text data kept alive
+        std::size_t _depth;
+    };
+
+    //*-- Piece (internal)
+    /**
+     * The part of a sequence around a given index, either one of its
+     * sub-sequences or its own text data.
+     */
+    struct Piece {
+        const StringSequence *_sequence; // NULL when the piece is text data
+        std::size_t _startIndex; // range covered by the piece in the sequence
+        std::size_t _endIndex;
+        std::size_t _shift; // index in `_sequence` of `_startIndex`
+        const Byte *_bytes; // text data at the given index, NULL when the piece is a sequence
+        SuperString::Encoding _encoding;
+        const Byte *_data; // whole UTF-8 text data, when it may be malformed, NULL otherwise
+        const Byte *_end;
+
+        //*- Constructors
+
+        Piece(const StringSequence *sequence, std::size_t startIndex, std::size_t endIndex, std::size_t shift);
+
+        Piece(const Byte *bytes, SuperString::Encoding encoding, std::size_t startIndex, std::size_t endIndex,
+              const Byte *data = NULL, const Byte *end = NULL);
+    };
+
+    //*-- Referencer (internal)
+    /**
+     * A link from a sequence to a reference sequence built on it, stored inside the
+     * reference sequence, one for each sequence it refers to, so that linking costs no allocation.
+     */
+    struct Referencer {
+        ReferenceStringSequence *_sequence;
+        std::size_t _cost; // reconstruction cost counted in the freeing cost of the referred sequence
+        Referencer *_previous;
+        Referencer *_next;
+
+        //*- Constructors
+
+        Referencer();
+    };
+
     //*-- StringSequence (abstract|internal)
     class StringSequence {
     private:
-        std::size_t _refCount;
-        SingleLinkedList<ReferenceStringSequence *> _referencers;
+        Atomic<std::size_t> _refCount;
+        Referencer *_referencers;
+        Atomic<std::size_t> _freeingCost; // sum of the costs of `_referencers`
+        Atomic<std::uint64_t> _hash; // the hash of the code units plus one, 0 until computed
 
     public:
         // Constructors
 
         StringSequence();
 
+        //*- Operators
+
+        /**
+         * Allocates sequence nodes from `NodePool`.
+         */
+        static void *operator new(std::size_t size);
+
+        static void operator delete(void *pointer, std::size_t size);
+
         //*- Destructor
 
         /**
@@ -398,6 +1264,21 @@ private:
          */
         virtual std::size_t length() const = 0;
 
+        /**
+         * Returns the number of bytes of text data kept alive by this sequence.
+         */
+        virtual std::size_t memoryLength() const = 0;
+
+        /**
+         * Returns the depth of this sequence, leaves have a depth of 0.
+         */
+        virtual std::size_t depth() const;
+
+        /**
+         * Returns true if this is a concatenation.
+         */
+        virtual bool isConcatenation() const;
+
         //*- Methods
 
         /**
@@ -405,10 +1286,33 @@ private:
          */
         virtual SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const = 0;
 
+        /**
+         * Returns the piece of this sequence that contains [index].
+         */
+        virtual SuperString::Piece pieceAt(std::size_t index) const = 0;
+
+        /**
+         * Calls [callback] on each chunk of this sequence from [startIndex], inclusive,
+         * to [endIndex], exclusive, returns false if [callback] stopped the iteration.
+         */
+        virtual bool
+        forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                     std::size_t endIndex) const = 0;
+
         SuperString::Result<std::size_t, SuperString::Error> indexOf(SuperString other) const;
 
         SuperString::Result<std::size_t, SuperString::Error> lastIndexOf(SuperString other) const;
 
+        /**
+         * Returns the hash of the code units of this sequence, see `SuperString::Hash`.
+         */
+        std::uint64_t hash() const;
+
+        /**
+         * Returns true if the hash of this sequence is already computed.
+         */
+        bool isHashed() const;
+
         /**
          * Returns the substring of this sequence that extends
          * from [startIndex], inclusive, to [endIndex], exclusive.
@@ -446,7 +1350,9 @@ private:
         // TODO: comment
         virtual std::size_t keepingCost() const = 0;
 
-        // TODO: comment
+        /**
+         * Returns the memory needed to reconstruct the referencers of this sequence if it is deleted.
+         */
         std::size_t freeingCost() const;
 
         // TODO: comment
@@ -455,14 +1361,29 @@ private:
         // TODO: comment
         std::size_t refRelease() const;
 
+        /**
+         * Releases a reference to this sequence, and deletes it if it is no longer needed.
+         */
+        void release() const;
+
         // TODO: comment
         std::size_t refCount() const;
 
-        // TODO: comment
-        void addReferencer(SuperString::ReferenceStringSequence *sequence) const;
+        /**
+         * Links [referencer] to this sequence, its sequence must already refer to this one.
+         */
+        void addReferencer(SuperString::Referencer *referencer) const;
 
-        // TODO: comment
-        void removeReferencer(SuperString::ReferenceStringSequence *sequence) const;
+        /**
+         * Unlinks [referencer], previously linked by `addReferencer`, from this sequence.
+         */
+        void removeReferencer(SuperString::Referencer *referencer) const;
+
+        /**
+         * Links the referencers from [first] to [last], chained by `_next`, whose costs add up to [cost],
+         * same as `addReferencer` on each of them.
+         */
+        void addReferencers(SuperString::Referencer *first, SuperString::Referencer *last, std::size_t cost) const;
 
         // TODO: comment
         void reconstructReferencers();
@@ -472,14 +1393,36 @@ private:
 
         virtual bool isToBeDeleted() const = 0;
 
-    private:
-        bool _substringMatches(std::size_t startIndex, SuperString other) const;
+        /**
+         * Computes the hash of this sequence, from its chunks unless overridden.
+         */
+        virtual std::uint64_t computeHash() const;
+
+        /**
+         * Deletes this sequence if no string holds it and its referencers don't need it,
+         * or would rather reconstruct themselves, which is never the case when thread-safe.
+         */
+        void collect() const;
+
+        /**
+         * Marks this sequence as being deleted, using its reference count that has no use by then.
+         */
+        void markToBeDeleted() const;
+
+        /**
+         * Returns true if `markToBeDeleted` was called on this sequence.
+         */
+        bool isMarkedToBeDeleted() const;
 
+    private:
         friend class SuperString;
     };
 
     //*-- ReferenceStringSequence (abstract|internal)
     class ReferenceStringSequence: public StringSequence {
+    protected:
+        Summary _summary;
+
     public:
         //*- Destructor
 
@@ -491,12 +1434,22 @@ private:
 
         // inherited: bool isNotEmpty() const;
 
-        virtual std::size_t length() const = 0 /*override*/;
+        std::size_t length() const /*override*/;
+
+        std::size_t memoryLength() const /*override*/;
+
+        std::size_t depth() const /*override*/;
 
         //*- Methods
 
         virtual SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const = 0 /*override*/;
 
+        virtual SuperString::Piece pieceAt(std::size_t index) const = 0 /*override*/;
+
+        virtual bool
+        forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                     std::size_t endIndex) const = 0 /*override*/;
+
         virtual SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const = 0 /*override*/;
 
@@ -521,10 +1474,51 @@ private:
         // TODO: comment
         virtual void reconstruct(const StringSequence *sequence) const = 0;
 
+        /**
+         * Makes this sequence refer to [leaf], that holds the same text, instead of its children.
+         */
+        virtual void flatten(const StringSequence *leaf) const = 0;
+
+        /**
+         * Recomputes the summary of this sequence, and those of its referencers if it changed.
+         */
+        void refreshSummary() const;
+
     protected:
         virtual void doDelete() const = 0;
 
         virtual bool isToBeDeleted() const = 0;
+
+        /**
+         * Computes the summary of this sequence from its current content.
+         */
+        virtual SuperString::Summary summarize() const = 0;
+
+        /**
+         * Copies the text of [sequence] from [startIndex] to [endIndex] into a new leaf,
+         * keeping the encoding of its chunks when they all share one, UTF-8 otherwise.
+         */
+        static const SuperString::StringSequence *
+        compact(const StringSequence *sequence, std::size_t startIndex, std::size_t endIndex);
+
+        /**
+         * Returns an estimation of the memory used by `compact` with the same arguments.
+         */
+        static std::size_t compactionCost(const StringSequence *sequence, std::size_t startIndex, std::size_t endIndex);
+
+        /**
+         * Copies the text of [sequence] into a new leaf, see `SuperString::flatten`.
+         */
+        static const SuperString::StringSequence *materialize(const StringSequence *sequence, bool isUTF8);
+
+    private:
+        /**
+         * Same as `compact`, always transcoding to UTF-8.
+         */
+        static const SuperString::StringSequence *
+        compactUTF8(const StringSequence *sequence, std::size_t startIndex, std::size_t endIndex);
+
+        friend class SuperString;
     };
 
     //*-- ConstASCIISequence (internal)
@@ -537,14 +1531,19 @@ private:
         };
 
         const Byte *_bytes;
-        std::size_t _length;
-        Status _status;
+        Atomic<std::size_t> _length;
+        Atomic<Status> _status;
 
     public:
         //*- Constructors
 
         ConstASCIISequence(const Byte *bytes);
 
+        /**
+         * For [bytes] made of [memoryLength] bytes, without a terminator.
+         */
+        ConstASCIISequence(const Byte *bytes, std::size_t memoryLength);
+
         //*- Destructor
 
         ~ConstASCIISequence();
@@ -557,10 +1556,17 @@ private:
 
         std::size_t length() const /*override*/;
 
+        std::size_t memoryLength() const /*override*/;
+
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -600,6 +1606,11 @@ private:
 
         CopyASCIISequence(const SuperString::ConstASCIISequence *sequence);
 
+        /**
+         * Takes the ownership of [data], made of [length] bytes and a terminator.
+         */
+        CopyASCIISequence(SuperString::Byte *data, std::size_t length);
+
         //*- Destructor
 
         ~CopyASCIISequence();
@@ -612,10 +1623,17 @@ private:
 
         std::size_t length() const /*override*/;
 
+        std::size_t memoryLength() const /*override*/;
+
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -645,19 +1663,33 @@ private:
     private:
         enum class Status {
             LengthNotComputed,
+            MemoryLengthComputed,
             LengthComputed,
             ToBeDestructed
         };
 
         const Byte *_bytes;
-        std::size_t _length;
-        Status _status;
+        Atomic<std::size_t> _length;
+        Atomic<std::size_t> _memoryLength; // terminator included
+        Atomic<Status> _status;
+        bool _isValid; // well-formed, characters are decoded without checks
+        UTF8Index _index;
 
     public:
         //*- Constructors
 
         ConstUTF8Sequence(const Byte *chars);
 
+        /**
+         * For well-formed [chars], made of [length] code units in [memoryLength] bytes, terminator included.
+         */
+        ConstUTF8Sequence(const Byte *chars, std::size_t length, std::size_t memoryLength);
+
+        /**
+         * For [chars] made of [memoryLength] bytes, without a terminator, their length is computed when needed.
+         */
+        ConstUTF8Sequence(const Byte *chars, std::size_t memoryLength);
+
         //*- Destructor
 
         ~ConstUTF8Sequence();
@@ -670,10 +1702,17 @@ private:
 
         std::size_t length() const /*override*/;
 
+        std::size_t memoryLength() const /*override*/;
+
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -706,6 +1745,8 @@ private:
         Byte *_data;
         std::size_t _length;
         std::size_t _memoryLength;
+        bool _isValid; // well-formed, characters are decoded without checks
+        UTF8Index _index;
 
     public:
         //*- Constructors
@@ -714,6 +1755,12 @@ private:
 
         CopyUTF8Sequence(const SuperString::ConstUTF8Sequence *sequence);
 
+        /**
+         * Takes the ownership of [data], made of [length] code units in [memoryLength] bytes,
+         * terminator included, and known to be well-formed when [isValid].
+         */
+        CopyUTF8Sequence(SuperString::Byte *data, std::size_t length, std::size_t memoryLength, bool isValid);
+
         //*- Destructor
 
         ~CopyUTF8Sequence();
@@ -726,10 +1773,17 @@ private:
 
         std::size_t length() const /*override*/;
 
+        std::size_t memoryLength() const /*override*/;
+
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -754,27 +1808,46 @@ private:
         bool isToBeDeleted() const;
     };
 
-    //*-- ConstUTF16BESequence (internal)
-    class ConstUTF16BESequence: public StringSequence {
+    //*-- ConstUTF16Sequence<Codec> (internal)
+    /**
+     * UTF-16 text data held by the user, in the byte order of [Codec], `UTF16BE` or `UTF16LE`.
+     */
+    template<class Codec>
+    class ConstUTF16Sequence: public StringSequence {
     private:
         enum class Status {
             LengthNotComputed,
+            MemoryLengthComputed,
             LengthComputed,
             ToBeDestructed
         };
 
         const Byte *_bytes;
-        std::size_t _length;
-        Status _status;
+        Atomic<std::size_t> _length;
+        Atomic<std::size_t> _memoryLength; // terminator included
+        Atomic<Status> _status;
+
+        // the index of the first of the [length] code points of [bytes] which is not a white space
+        static std::size_t trimmedStart(const SuperString::Byte *bytes, std::size_t length);
+
+        // the index after the last of the [length] code points, in [memoryLength] bytes, of [bytes] which is not
+        // a white space, [startIndex] at least
+        static std::size_t trimmedEnd(const SuperString::Byte *bytes, std::size_t length, std::size_t memoryLength,
+                                      std::size_t startIndex);
 
     public:
         //*- Constructors
 
-        ConstUTF16BESequence(const SuperString::Byte *bytes);
+        ConstUTF16Sequence(const SuperString::Byte *bytes);
+
+        /**
+         * For [bytes] made of [memoryLength] bytes, without a terminator, their length is computed when needed.
+         */
+        ConstUTF16Sequence(const SuperString::Byte *bytes, std::size_t memoryLength);
 
         //*- Destructor
 
-        ~ConstUTF16BESequence();
+        ~ConstUTF16Sequence();
 
         //*- Getters
 
@@ -784,10 +1857,17 @@ private:
 
         std::size_t length() const /*override*/;
 
+        std::size_t memoryLength() const /*override*/;
+
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -806,7 +1886,7 @@ private:
 
         // inherited:SuperString:: std::size_t freeingCost() const;
 
-        friend class CopyUTF16BESequence;
+        friend class CopyUTF16Sequence<Codec>;
 
     protected:
         void doDelete() const;
@@ -814,8 +1894,16 @@ private:
         bool isToBeDeleted() const;
     };
 
-    //*-- CopyUTF16BESequence (internal)
-    class CopyUTF16BESequence: public StringSequence {
+    typedef ConstUTF16Sequence<UTF16BE> ConstUTF16BESequence;
+
+    typedef ConstUTF16Sequence<UTF16LE> ConstUTF16LESequence;
+
+    //*-- CopyUTF16Sequence<Codec> (internal)
+    /**
+     * UTF-16 text data copied into a buffer of its own, in the byte order of [Codec].
+     */
+    template<class Codec>
+    class CopyUTF16Sequence: public StringSequence {
     private:
         Byte *_data;
         std::size_t _length;
@@ -824,13 +1912,19 @@ private:
     public:
         //*- Constructors
 
-        CopyUTF16BESequence(const SuperString::Byte *bytes);
+        CopyUTF16Sequence(const SuperString::Byte *bytes);
+
+        CopyUTF16Sequence(const SuperString::ConstUTF16Sequence<Codec> *sequence);
 
-        CopyUTF16BESequence(const SuperString::ConstUTF16BESequence *sequence);
+        /**
+         * Takes the ownership of [data], made of [length] code units in [memoryLength] bytes,
+         * terminator included.
+         */
+        CopyUTF16Sequence(SuperString::Byte *data, std::size_t length, std::size_t memoryLength);
 
         //*- Destructor
 
-        ~CopyUTF16BESequence();
+        ~CopyUTF16Sequence();
 
         //*- Getters
 
@@ -840,9 +1934,16 @@ private:
 
         std::size_t length() const /*override*/;
 
+        std::size_t memoryLength() const /*override*/;
+
         //*- Methods
 
-        SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
+        SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
+
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
 
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
@@ -866,8 +1967,18 @@ private:
         void doDelete() const;
 
         bool isToBeDeleted() const;
+
+    private:
+        /**
+         * Returns the byte offset of the code unit at [index], at once when there is no surrogate pair.
+         */
+        std::size_t offset(std::size_t index) const;
     };
 
+    typedef CopyUTF16Sequence<UTF16BE> CopyUTF16BESequence;
+
+    typedef CopyUTF16Sequence<UTF16LE> CopyUTF16LESequence;
+
     //*-- ConstUTF32Sequence (internal)
     class ConstUTF32Sequence: public StringSequence {
     private:
@@ -878,14 +1989,19 @@ private:
         };
 
         const int *_bytes;
-        std::size_t _length;
-        Status _status;
+        Atomic<std::size_t> _length;
+        Atomic<Status> _status;
 
     public:
         //*- Constructors
 
         ConstUTF32Sequence(const SuperString::Byte *bytes);
 
+        /**
+         * For [bytes] made of [memoryLength] bytes, without a terminator.
+         */
+        ConstUTF32Sequence(const SuperString::Byte *bytes, std::size_t memoryLength);
+
         //*- Destructor
 
         ~ConstUTF32Sequence();
@@ -898,10 +2014,17 @@ private:
 
         std::size_t length() const /*override*/;
 
+        std::size_t memoryLength() const /*override*/;
+
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -941,6 +2064,11 @@ private:
 
         CopyUTF32Sequence(const SuperString::ConstUTF32Sequence *sequence);
 
+        /**
+         * Takes the ownership of [data], made of [length] code units and a terminator.
+         */
+        CopyUTF32Sequence(int *data, std::size_t length);
+
         //*- Destructor
 
         ~CopyUTF32Sequence();
@@ -953,10 +2081,17 @@ private:
 
         std::size_t length() const /*override*/;
 
+        std::size_t memoryLength() const /*override*/;
+
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -984,45 +2119,40 @@ private:
     //*-- SubstringSequence (internal)
     class SubstringSequence: public ReferenceStringSequence {
     private:
-        enum class Kind: char {
-            SUBSTRING,
-            RECONSTRUCTED
-        };
-        struct SubstringMetaInfo {
-            const StringSequence *_sequence;
-            std::size_t _startIndex;
-            std::size_t _endIndex;
-        };
-        struct ReconstructedMetaInfo {
-            int *_data;
-            std::size_t _length;
-        };
-
-        Kind _kind;
-        union {
-            struct SubstringMetaInfo _substring;
-            struct ReconstructedMetaInfo _reconstructed;
-        } _container;
+        const StringSequence *_sequence;
+        std::size_t _startIndex;
+        std::size_t _endIndex;
+        Referencer _referencer;
 
     public:
         //*- Constructors
 
         SubstringSequence(const StringSequence *sequence, std::size_t startIndex, std::size_t endIndex);
 
+        /**
+         * Same as above, with its referencer linked at the head of [referencers] and its cost added to [cost]
+         * instead, so that the list is linked to [sequence] at once by `addReferencers`.
+         */
+        SubstringSequence(const StringSequence *sequence, std::size_t startIndex, std::size_t endIndex,
+                          SuperString::Referencer *&referencers, std::size_t &cost);
+
         //*- Destructor
 
         ~SubstringSequence();
 
         //*- Getters
 
-        SuperString::SubstringSequence::Kind kind() const;
-
-        std::size_t length() const /*override*/;
+        // inherited: std::size_t length() const;
 
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -1045,49 +2175,25 @@ private:
 
         void reconstruct(const StringSequence *sequence) const /*override*/;
 
+        void flatten(const StringSequence *leaf) const /*override*/;
+
         friend class StringSequence;
 
     protected:
         void doDelete() const;
 
         bool isToBeDeleted() const;
+
+        SuperString::Summary summarize() const /*override*/;
     };
 
     //*-- ConcatenationSequence (internal)
     class ConcatenationSequence: public ReferenceStringSequence {
     private:
-        enum class Kind {
-            CONCATENATION,
-            LEFTRECONSTRUCTED,
-            RIGHTRECONSTRUCTED,
-            RECONSTRUCTED
-        };
-        struct ConcatenationMetaInfo {
-            const StringSequence *_left;
-            const StringSequence *_right;
-        };
-        struct LeftReconstructedMetaInfo {
-            const StringSequence *_right;
-            int *_leftData;
-            std::size_t _leftLength;
-        };
-        struct RightReconstructedMetaInfo {
-            const StringSequence *_left;
-            int *_rightData;
-            std::size_t _rightLength;
-        };
-        struct ReconstructedMetaInfo {
-            int *_data;
-            std::size_t _length;
-        };
-
-        Kind _kind;
-        union {
-            struct ConcatenationMetaInfo _concatenation;
-            struct LeftReconstructedMetaInfo _leftReconstructed;
-            struct RightReconstructedMetaInfo _rightReconstructed;
-            struct ReconstructedMetaInfo _reconstructed;
-        } _container;
+        const StringSequence *_left;
+        const StringSequence *_right;
+        Referencer _leftReferencer;
+        Referencer _rightReferencer;
 
     public:
         //*- Constructors
@@ -1100,14 +2206,19 @@ private:
 
         //*- Getters
 
-        SuperString::ConcatenationSequence::Kind kind() const;
+        // inherited: std::size_t length() const;
 
-        std::size_t length() const /*override*/;
+        bool isConcatenation() const /*override*/;
 
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -1130,34 +2241,41 @@ private:
 
         void reconstruct(const StringSequence *sequence) const /*override*/;
 
+        void flatten(const StringSequence *leaf) const /*override*/;
+
+        //*- Statics
+
+        /**
+         * Concatenates [left] and [right] into a new sequence, reusing the nodes of both sides, with
+         * the AVL join: of two balanced sides, where the depths of any two siblings differ by at most one,
+         * the result is balanced. A side that is not a concatenation is not descended into, and a side
+         * reconstructed into a leaf makes its parents shallower, both may leave siblings further apart.
+         */
+        static ConcatenationSequence *join(const StringSequence *left, const StringSequence *right);
+
     protected:
         void doDelete() const;
 
         bool isToBeDeleted() const;
+
+        SuperString::Summary summarize() const /*override*/;
+
+        std::uint64_t computeHash() const /*override*/;
+
+    private:
+        static SuperString::Pair<const StringSequence *, const StringSequence *>
+        joinRight(const ConcatenationSequence *left, const StringSequence *right);
+
+        static SuperString::Pair<const StringSequence *, const StringSequence *>
+        joinLeft(const StringSequence *left, const ConcatenationSequence *right);
     };
 
     //*-- MultipleSequence (internal)
     class MultipleSequence: public ReferenceStringSequence {
     private:
-        struct MultipleMetaInfo {
-            std::size_t _time;
-            const StringSequence *_sequence;
-        };
-        struct ReconstructedMetaInfo {
-            std::size_t _time;
-            int *_data;
-            std::size_t _dataLength;
-        };
-        enum class Kind {
-            MULTIPLE,
-            RECONSTRUCTED
-        };
-
-        Kind _kind;
-        union {
-            struct MultipleMetaInfo _multiple;
-            struct ReconstructedMetaInfo _reconstructed;
-        } _container;
+        std::size_t _time;
+        const StringSequence *_sequence;
+        Referencer _referencer;
 
     public:
         //*- Constructors
@@ -1170,14 +2288,17 @@ private:
 
         //*- Getters
 
-        SuperString::MultipleSequence::Kind kind() const;
-
-        std::size_t length() const /*override*/;
+        // inherited: std::size_t length() const;
 
         //*- Methods
 
         SuperString::Result<int, SuperString::Error> codeUnitAt(std::size_t index) const /*override*/;
 
+        SuperString::Piece pieceAt(std::size_t index) const /*override*/;
+
+        bool forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                          std::size_t endIndex) const /*override*/;
+
         SuperString::Result<SuperString, SuperString::Error>
         substring(std::size_t startIndex, std::size_t endIndex) const /*override*/;
 
@@ -1200,22 +2321,201 @@ private:
 
         void reconstruct(const StringSequence *sequence) const /*override*/;
 
+        void flatten(const StringSequence *leaf) const /*override*/;
+
     protected:
         void doDelete() const;
 
         bool isToBeDeleted() const;
+
+        SuperString::Summary summarize() const /*override*/;
+
+        std::uint64_t computeHash() const /*override*/;
+    };
+
+    //*-- MappedSequence<T> (internal)
+    /**
+     * A const leaf of type [T] over the text data of a mapped file, unmapped when the leaf is deleted.
+     */
+    template<class T>
+    class MappedSequence: public T {
+    private:
+        void *_address;
+        std::size_t _size; // of the whole mapping, zero pages after the file included
+
+    public:
+        //*- Constructors
+
+        /**
+         * For the [memoryLength] bytes of the file at [address], in a mapping of [size] bytes.
+         */
+        MappedSequence(void *address, std::size_t size, std::size_t memoryLength);
+
+        //*- Destructor
+
+        ~MappedSequence();
     };
 
     inline static bool isWhiteSpace(int codeUnit);
 
+    /**
+     * Validates [bytes] in the given [encoding], see `ASCII::validate`.
+     */
+    static SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+    validate(const SuperString::Byte *bytes, SuperString::Encoding encoding);
+
+    /**
+     * Compares the code units at [pointer], in the given [encoding] and before [end], to the ones
+     * of [chunk], and moves [pointer] past them.
+     */
+    static int compareChunk(const SuperString::Byte *&pointer, const SuperString::Byte *end,
+                            SuperString::Encoding encoding, const SuperString::Chunk &chunk);
+
+    //
+    /**
+     * The hash of a string is the polynomial of its code units, each one plus one, evaluated at `BASE`
+     * modulo the prime `MODULUS`, so that the hash of a concatenation comes from the hashes of its sides.
+     */
+    class Hash {
+    public:
+        static const std::uint64_t MODULUS = (((std::uint64_t) 1) << 61) - 1;
+        static const std::uint64_t BASE = 0x1f3d5b79a2c4e6fULL;
+
+        /**
+         * Returns [a] * [b] modulo `MODULUS`.
+         */
+        static std::uint64_t multiply(std::uint64_t a, std::uint64_t b);
+
+        /**
+         * Returns `BASE` to the power [exponent] modulo `MODULUS`.
+         */
+        static std::uint64_t power(std::size_t exponent);
+
+        /**
+         * Returns the hash of the concatenation of the strings of hash [left] and [right],
+         * the right one being [rightLength] long.
+         */
+        static std::uint64_t concatenate(std::uint64_t left, std::uint64_t right, std::size_t rightLength);
+
+        /**
+         * Returns the hash of the string of hash [hash] and of the given [length] repeated [times] times.
+         */
+        static std::uint64_t repeat(std::uint64_t hash, std::size_t length, std::size_t times);
+
+        /**
+         * Returns [hash] extended with the code units of [chunk].
+         */
+        static std::uint64_t update(std::uint64_t hash, const SuperString::Chunk &chunk);
+
+    private:
+        /**
+         * Returns [value] modulo `MODULUS`, for a [value] below 2^63.
+         */
+        static std::uint64_t reduce(std::uint64_t value);
+    };
+
+    //
+    /**
+     * Transcodes text data to UTF-8 into a fixed-size buffer, and writes it to a stream a buffer at a time,
+     * or to a file descriptor with `writev`, where large ASCII and UTF-8 chunks are written from where they are.
+     */
+    class Writer {
+    public:
+        static const std::size_t CAPACITY = 16 << 10;
+        static const std::size_t VECTORS = 256;
+        static const std::size_t GATHER_SIZE = 1 << 10; // smaller chunks are copied to the buffer
+
+    private:
+        struct State; // the buffer and the gathered vectors, defined along with the methods
+
+        std::ostream *_stream; // NULL when writing to the file descriptor
+        int _fd;
+        bool _isOk;
+        std::size_t _written;
+        State *_state;
+
+    public:
+        //*- Constructors
+
+        Writer(std::ostream &stream);
+
+        Writer(int fd);
+
+        Writer(const SuperString::Writer &other) = delete;
+
+        //*- Destructor
+
+        ~Writer();
+
+        //*- Getters
+
+        /**
+         * Returns false if writing to the file descriptor failed, `errno` telling why.
+         */
+        bool isOk() const;
+
+        /**
+         * Returns the number of bytes written to the file descriptor.
+         */
+        std::size_t written() const;
+
+        //*- Methods
+
+        /**
+         * Writes the text data of [chunk], returns false once writing failed.
+         */
+        bool write(const SuperString::Chunk &chunk);
+
+        /**
+         * Writes [memoryLength] bytes of ASCII or UTF-8 data as they are.
+         */
+        void writeBytes(const SuperString::Byte *bytes, std::size_t memoryLength);
+
+        /**
+         * Writes [memoryLength] bytes of UTF-16BE data, ending on a character boundary.
+         */
+        void writeUTF16BE(const SuperString::Byte *bytes, std::size_t memoryLength);
+
+        /**
+         * Writes [memoryLength] bytes of UTF-16LE data, ending on a character boundary.
+         */
+        void writeUTF16LE(const SuperString::Byte *bytes, std::size_t memoryLength);
+
+        /**
+         * Writes [memoryLength] bytes of UTF-32 data.
+         */
+        void writeUTF32(const SuperString::Byte *bytes, std::size_t memoryLength);
+
+        /**
+         * Writes out the buffered bytes, and the gathered vectors.
+         */
+        void flush();
+
+        //*- Operators
+
+        SuperString::Writer &operator=(const SuperString::Writer &other) = delete;
+
+    private:
+        /**
+         * Adds a vector of [memoryLength] bytes at [bytes], flushing when there is room for one more only,
+         * which `flush` keeps for the buffered bytes.
+         */
+        void gather(const SuperString::Byte *bytes, std::size_t memoryLength);
+    };
+
     //
     class ASCII {
     public:
         static std::size_t length(const SuperString::Byte *bytes);
 
-        static int codeUnitAt(const SuperString::Byte *bytes, std::size_t index);
+        /**
+         * Returns the length and the memory length, terminator included, of [bytes] if well-formed,
+         * otherwise the byte offset of the first ill-formed sequence.
+         */
+        static SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+        validate(const SuperString::Byte *bytes);
 
-        static void print(std::ostream &stream, const SuperString::Byte *bytes);
+        static int codeUnitAt(const SuperString::Byte *bytes, std::size_t index);
 
         static void print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
                           std::size_t endIndex);
@@ -1223,7 +2523,7 @@ private:
         static SuperString::Pair<std::size_t, std::size_t>
         trim(const SuperString::Byte *bytes, std::size_t length);
 
-        static std::size_t trimLeft(const SuperString::Byte *bytes);
+        static std::size_t trimLeft(const SuperString::Byte *bytes, std::size_t length);
 
         static std::size_t trimRight(const SuperString::Byte *bytes, std::size_t length);
     };
@@ -1232,41 +2532,75 @@ private:
     public:
         static std::size_t length(const SuperString::Byte *bytes);
 
+        /**
+         * Returns the length of the [memoryLength] bytes at [bytes].
+         */
+        static std::size_t length(const SuperString::Byte *bytes, std::size_t memoryLength);
+
         static SuperString::Pair<std::size_t, std::size_t>
         lengthAndMemoryLength(const SuperString::Byte *bytes);
 
-        static SuperString::Result<int, SuperString::Error>
-        codeUnitAt(const SuperString::Byte *bytes, std::size_t index);
+        /**
+         * Returns the length and the memory length, terminator included, of [bytes] if well-formed,
+         * otherwise the byte offset of the first ill-formed sequence.
+         */
+        static SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+        validate(const SuperString::Byte *bytes);
 
-        static void print(std::ostream &stream, const SuperString::Byte *bytes);
+        static std::size_t sequenceLength(SuperString::Byte leadByte);
 
-        static void print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
-                          std::size_t endIndex);
+        /**
+         * Returns the character at the start of well-formed [bytes].
+         */
+        static int decode(const SuperString::Byte *bytes);
 
-        static SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, SuperString::Error>
-        rangeIndexes(const SuperString::Byte *bytes, std::size_t startIndex, std::size_t endIndex);
+        /**
+         * Returns the character at the start of [bytes], which end at [end],
+         * or `SuperString::Error::InvalidByteSequence` when its sequence is ill-formed or truncated.
+         */
+        static SuperString::Result<int, SuperString::Error>
+        decode(const SuperString::Byte *bytes, const SuperString::Byte *end);
 
-        static SuperString::Pair<SuperString::Byte *, std::size_t> codeUnitToChar(int c);
+        /**
+         * Writes the UTF-8 encoding of [c] to [bytes], which has room for 4 bytes,
+         * and returns the number of bytes written.
+         */
+        static std::size_t encode(int c, SuperString::Byte *bytes);
 
         // TODO: add customized trims methods
     };
 
     class UTF16BE {
     public:
-        static std::size_t length(const SuperString::Byte *bytes);
+        static const SuperString::Encoding ENCODING = SuperString::Encoding::UTF16BE;
+        static const std::size_t HIGH = 0; // the offset of the high byte in a code unit
+
+        /**
+         * Returns the length of the [memoryLength] bytes at [bytes].
+         */
+        static std::size_t length(const SuperString::Byte *bytes, std::size_t memoryLength);
 
         static SuperString::Pair<std::size_t, std::size_t>
         lengthAndMemoryLength(const SuperString::Byte *bytes);
 
-        static SuperString::Result<int, SuperString::Error>
-        codeUnitAt(const SuperString::Byte *bytes, std::size_t index);
+        /**
+         * Returns the length and the memory length, terminator included, of [bytes] if well-formed,
+         * otherwise the byte offset of the first ill-formed sequence.
+         */
+        static SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+        validate(const SuperString::Byte *bytes);
+
+        static std::size_t offset(const SuperString::Byte *bytes, std::size_t index);
+
+        /**
+         * Returns the character at the start of [bytes], a surrogate pair being one.
+         */
+        static int decode(const SuperString::Byte *bytes);
 
         static void print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t length);
 
         static void print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
                           std::size_t endIndex);
-
-        // TODO: add customized trims methods
     };
 
     class UTF32 {
@@ -1276,9 +2610,14 @@ private:
         static SuperString::Pair<std::size_t, std::size_t>
         lengthAndMemoryLength(const SuperString::Byte *bytes);
 
-        static int codeUnitAt(const SuperString::Byte *bytes, std::size_t index);
+        /**
+         * Returns the length and the memory length, terminator included, of [bytes] if well-formed,
+         * otherwise the byte offset of the first ill-formed sequence.
+         */
+        static SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+        validate(const SuperString::Byte *bytes);
 
-        static void print(std::ostream &stream, const SuperString::Byte *bytes);
+        static int codeUnitAt(const SuperString::Byte *bytes, std::size_t index);
 
         static void print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
                           std::size_t endIndex);
@@ -1286,10 +2625,43 @@ private:
         static SuperString::Pair<std::size_t, std::size_t>
         trim(const SuperString::Byte *bytes, std::size_t length);
 
-        static std::size_t trimLeft(const SuperString::Byte *bytes);
+        static std::size_t trimLeft(const SuperString::Byte *bytes, std::size_t length);
 
         static std::size_t trimRight(const SuperString::Byte *bytes, std::size_t length);
     };
+
+    class UTF16LE {
+    public:
+        static const SuperString::Encoding ENCODING = SuperString::Encoding::UTF16LE;
+        static const std::size_t HIGH = 1; // the offset of the high byte in a code unit
+
+        /**
+         * Returns the length of the [memoryLength] bytes at [bytes].
+         */
+        static std::size_t length(const SuperString::Byte *bytes, std::size_t memoryLength);
+
+        static SuperString::Pair<std::size_t, std::size_t>
+        lengthAndMemoryLength(const SuperString::Byte *bytes);
+
+        /**
+         * Returns the length and the memory length, terminator included, of [bytes] if well-formed,
+         * otherwise the byte offset of the first ill-formed sequence.
+         */
+        static SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+        validate(const SuperString::Byte *bytes);
+
+        static std::size_t offset(const SuperString::Byte *bytes, std::size_t index);
+
+        /**
+         * Returns the character at the start of [bytes], a surrogate pair being one.
+         */
+        static int decode(const SuperString::Byte *bytes);
+
+        static void print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t length);
+
+        static void print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
+                          std::size_t endIndex);
+    };
 };
 
 // External Operators
@@ -1301,174 +2673,122 @@ std::ostream &operator<<(std::ostream &stream, const SuperString &string);
 //*-- SuperString::Result<T, E>
 template<class T, class E>
 SuperString::Result<T, E>::Result()
-        : _ok(NULL),
-          _err(NULL) {
+        : _state(State::Empty) {
     // nothing go here
 }
 
 template<class T, class E>
 SuperString::Result<T, E>::Result(T ok)
-        : _ok(NULL),
-          _err(NULL) {
-    this->_ok = new char[sizeof(T)];
-    new(this->_ok) T(ok);
+        : _state(State::Ok) {
+    new(this->_storage) T(std::move(ok));
 }
 
 template<class T, class E>
 SuperString::Result<T, E>::Result(E err)
-        : _ok(NULL),
-          _err(NULL) {
-    this->_err = new char[sizeof(E)];
-    new(this->_err) E(err);
+        : _state(State::Err) {
+    new(this->_storage) E(std::move(err));
 }
 
 template<class T, class E>
 SuperString::Result<T, E>::Result(const SuperString::Result<T, E> &other)
-        : _ok(NULL),
-          _err(NULL) /*copy*/ {
-    if(other._ok != NULL) {
-        this->_ok = new char[sizeof(T)];
-        new(this->_ok) T(*((T *) other._ok));
-    } else {
-        this->_err = new char[sizeof(E)];
-        new(this->_err) E(*((E *) other._err));
+        : _state(other._state) /*copy*/ {
+    if(other._state == State::Ok) {
+        new(this->_storage) T(*((const T *) other._storage));
+    } else if(other._state == State::Err) {
+        new(this->_storage) E(*((const E *) other._storage));
     }
 }
 
 template<class T, class E>
-SuperString::Result<T, E>::~Result() {
-    if(this->_ok != NULL) {
-        ((T *) (this->_ok))->~T();
-        delete this->_ok;
-        this->_ok = NULL;
-    }
-    if(this->_err != NULL) {
-        ((E *) (this->_err))->~E();
-        delete this->_err;
-        this->_err = NULL;
+SuperString::Result<T, E>::Result(SuperString::Result<T, E> &&other)
+        : _state(other._state) /*move*/ {
+    if(other._state == State::Ok) {
+        new(this->_storage) T(std::move(*((T *) other._storage)));
+    } else if(other._state == State::Err) {
+        new(this->_storage) E(std::move(*((E *) other._storage)));
     }
 }
 
+template<class T, class E>
+SuperString::Result<T, E>::~Result() {
+    this->clear();
+}
+
 template<class T, class E>
 E SuperString::Result<T, E>::err() const {
-    return *((E *) this->_err);
+    return *((const E *) this->_storage);
 }
 
 template<class T, class E>
 bool SuperString::Result<T, E>::isErr() const {
-    return this->_err != NULL;
+    return this->_state == State::Err;
 }
 
 template<class T, class E>
 bool SuperString::Result<T, E>::isOk() const {
-    return this->_ok != NULL;
+    return this->_state == State::Ok;
 }
 
 template<class T, class E>
-T SuperString::Result<T, E>::ok() const {
-    return *((T *) this->_ok);
+T SuperString::Result<T, E>::ok() const & {
+    return *((const T *) this->_storage);
+}
+
+template<class T, class E>
+T SuperString::Result<T, E>::ok() && {
+    return std::move(*((T *) this->_storage));
 }
 
 template<class T, class E>
 void SuperString::Result<T, E>::err(E err) {
-    this->~Result();
-    this->_err = new char[sizeof(E)];
-    new(this->_err) E(err);
+    this->clear();
+    new(this->_storage) E(std::move(err));
+    this->_state = State::Err;
 }
 
 template<class T, class E>
 void SuperString::Result<T, E>::ok(T ok) {
-    this->~Result();
-    this->_ok = new char[sizeof(T)];
-    new(this->_ok) T(ok);
+    this->clear();
+    new(this->_storage) T(std::move(ok));
+    this->_state = State::Ok;
 }
 
 template<class T, class E>
 SuperString::Result<T, E> &SuperString::Result<T, E>::operator=(const SuperString::Result<T, E> &other) {
     if(this != &other) {
         if(other.isOk()) {
-            this->ok(other.ok());
+            this->ok(*((const T *) other._storage));
+        } else if(other.isErr()) {
+            this->err(*((const E *) other._storage));
         } else {
-            this->err(other.err());
+            this->clear();
         }
     }
     return *this;
 }
 
-//*-- SuperString::SingleLinkedList<E> (internal)
-template<class E>
-SuperString::SingleLinkedList<E>::SingleLinkedList()
-        : _head(NULL),
-          _tail(NULL) {
-    // nothing go here
-}
-
-template<class E>
-SuperString::SingleLinkedList<E>::~SingleLinkedList() {
-    Node<E> *node = this->_head;
-    while(node != NULL) {
-        Node<E> *tmp = node;
-        node = node->_next;
-        delete tmp;
-    }
-    this->_head = NULL;
-    this->_tail = NULL;
-}
-
-template<class E>
-std::size_t SuperString::SingleLinkedList<E>::length() const {
-    std::size_t length = 0;
-    Node<E> *node = this->_head;
-    while(node != NULL) {
-        length++;
-        node = node->_next;
-    }
-    return length;
-}
-
-template<class E>
-void SuperString::SingleLinkedList<E>::push(E value) {
-    Node<E> *node = new Node<E>(value);
-    if(this->_tail == NULL) {
-        this->_head = node;
-        this->_tail = node;
-    } else {
-        this->_tail->_next = node;
-        this->_tail = node;
-    }
-}
-
-template<class E>
-void SuperString::SingleLinkedList<E>::remove(E value) {
-    Node<E> *prev = NULL;
-    Node<E> *node = this->_head;
-    while(node != NULL) {
-        if(node->_data == value) {
-            break;
-        }
-        prev = node;
-        node = node->_next;
-    }
-    if(node != NULL) {
-        if(prev == NULL) {
-            this->_head = node->_next;
+template<class T, class E>
+SuperString::Result<T, E> &SuperString::Result<T, E>::operator=(SuperString::Result<T, E> &&other) {
+    if(this != &other) {
+        if(other.isOk()) {
+            this->ok(std::move(*((T *) other._storage)));
+        } else if(other.isErr()) {
+            this->err(std::move(*((E *) other._storage)));
         } else {
-            prev->_next = node->_next;
+            this->clear();
         }
-        if(node->_next == NULL) {
-            this->_tail = prev;
-        }
-        delete node;
     }
+    return *this;
 }
 
-//*-- SuperString::SingleLinkedList<E>::Node<Ei> (internal)
-template<class E>
-template<class Ei>
-SuperString::SingleLinkedList<E>::Node<Ei>::Node(E data)
-        : _data(data),
-          _next(NULL) {
-    // nothing go here
+template<class T, class E>
+void SuperString::Result<T, E>::clear() {
+    if(this->_state == State::Ok) {
+        ((T *) this->_storage)->~T();
+    } else if(this->_state == State::Err) {
+        ((E *) this->_storage)->~E();
+    }
+    this->_state = State::Empty;
 }
 
 //*-- SuperString::Pair<T, U>
@@ -1515,5 +2835,14 @@ bool SuperString::isWhiteSpace(int codeUnit) {
     return (codeUnit == 0x85) || (codeUnit == 0xA0); // NEL, NBSP.
 }
 
+//*-- std::hash<SuperString>
+namespace std {
+    template<>
+    struct hash<SuperString> {
+        std::size_t operator()(const SuperString &string) const {
+            return string.hash();
+        }
+    };
+}
 
 #endif // BOUTGLAY_SUPERSTRING_HEADER
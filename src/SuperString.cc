@@ -3,12 +3,38 @@
 #include <SuperString.hh>
 // std
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <mutex>
 #include <stdexcept>
+#include <system_error>
+#include <thread>
+// posix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(SUPERSTRING_NO_SIMD)
+#define SUPERSTRING_SIMD
+#include <immintrin.h>
+#endif
 
 /*-- definitions --*/
 
+#ifdef SUPERSTRING_THREAD_SAFE
+// guards the links between sequences, their deletion and the building of indexes
+static std::recursive_mutex sequencesMutex;
+// guards the shared free lists of sequence nodes, and the list of their blocks
+static std::mutex nodePoolMutex;
+#endif
+
 //*-- SuperString
 SuperString::SuperString()
         : _sequence(NULL) {
@@ -17,7 +43,14 @@ SuperString::SuperString()
 
 SuperString::SuperString(const SuperString &other) /*copy*/ {
     this->_sequence = other._sequence;
-    this->_sequence->refAdd();
+    if(this->_sequence != NULL) {
+        this->_sequence->refAdd();
+    }
+}
+
+SuperString::SuperString(SuperString &&other) noexcept /*move*/
+        : _sequence(other._sequence) {
+    other._sequence = NULL;
 }
 
 SuperString::SuperString(SuperString::StringSequence *sequence)
@@ -26,8 +59,8 @@ SuperString::SuperString(SuperString::StringSequence *sequence)
 }
 
 SuperString::~SuperString() {
-    if(this->_sequence != NULL && this->_sequence->refRelease() == 0 && this->freeingCost() < this->keepingCost()) {
-        this->_sequence->doDelete();
+    if(this->_sequence != NULL) {
+        this->_sequence->release();
     }
 }
 
@@ -46,30 +79,49 @@ std::size_t SuperString::length() const {
     return 0;
 }
 
+std::size_t SuperString::depth() const {
+    if(this->_sequence != NULL) {
+        return this->_sequence->depth();
+    }
+    return 0;
+}
+
 int SuperString::compareTo(const SuperString &other) const {
+    if(this->_sequence == other._sequence) {
+        return 0; // the same sequence, or both empty
+    }
     std::size_t thisLength = this->length();
     std::size_t otherLength = other.length();
     std::size_t len = (thisLength < otherLength) ? thisLength : otherLength;
-    for(int i = 0; i < len; i++) {
-        int thisCodeUnit = this->codeUnitAt(i).ok();
-        int otherCodeUnit = other.codeUnitAt(i).ok();
-        if(thisCodeUnit < otherCodeUnit) {
-            return -1;
-        }
-        if(thisCodeUnit > otherCodeUnit) {
-            return 1;
-        }
+    // the chunks of this string, each one against the chunks of the same range of [other]
+    int result = 0;
+    std::size_t index = 0;
+    this->forEachChunk([&](const Chunk &chunk) -> bool {
+        const Byte *pointer = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+        other.forEachChunk([&](const Chunk &otherChunk) -> bool {
+            result = SuperString::compareChunk(pointer, end, chunk.encoding(), otherChunk);
+            return result == 0;
+        }, index, index + chunk.length());
+        index += chunk.length();
+        return result == 0;
+    }, 0, len);
+    if(result != 0) {
+        return result;
     }
     if(thisLength < otherLength) return -1;
     if(thisLength > otherLength) return 1;
     return 0;
 }
 
-SuperString::Result<std::size_t, SuperString::Error> SuperString::indexOf(SuperString other) const {
-    if(this->_sequence != NULL) {
+SuperString::Result<std::size_t, SuperString::Error> SuperString::indexOf(SuperString other,
+                                                                          std::size_t threads) const {
+    if(this->_sequence == NULL) {
+        return Result<std::size_t, Error>(Error::NotFound);
+    }
+    if(threads == 1 || other.length() == 0) {
         return this->_sequence->indexOf(other);
     }
-    return Result<std::size_t, Error>(Error::NotFound);
+    return this->findFirst(Finder(other), threads);
 }
 
 SuperString::Result<std::size_t, SuperString::Error> SuperString::lastIndexOf(SuperString other) const {
@@ -79,6 +131,141 @@ SuperString::Result<std::size_t, SuperString::Error> SuperString::lastIndexOf(Su
     return Result<std::size_t, Error>(Error::NotFound);
 }
 
+bool SuperString::forEachMatch(const SuperString::PatternSet &patterns,
+                               const SuperString::MatchCallback &callback) const {
+    return patterns.match(*this, callback);
+}
+
+std::size_t SuperString::hash() const {
+    if(this->_sequence != NULL) {
+        return (std::size_t) this->_sequence->hash();
+    }
+    return 0;
+}
+
+bool SuperString::forEachPiece(const SuperString &delimiter, const SuperString::RangeCallback &callback,
+                               std::size_t threads) const {
+    std::size_t length = this->length(), delimiterLength = delimiter.length();
+    std::size_t startIndex = 0;
+    bool isDone = true;
+    if(delimiterLength == 1) {
+        isDone = this->forEachBreak(delimiter.codeUnitAt(0).ok(), -1, [&](std::size_t index, bool) -> bool {
+            bool isContinued = callback(startIndex, index);
+            startIndex = index + 1;
+            return isContinued;
+        }, threads);
+    } else if(delimiterLength > 1) {
+        Finder finder(delimiter);
+        isDone = this->forEachOccurrence(finder, [&](std::size_t index) -> bool {
+            bool isContinued = callback(startIndex, index);
+            startIndex = index + delimiterLength;
+            return isContinued;
+        }, threads);
+    }
+    if(!isDone) {
+        return false;
+    }
+    return callback(startIndex, length);
+}
+
+bool SuperString::forEachLine(const SuperString::RangeCallback &callback, std::size_t threads) const {
+    std::size_t startIndex = 0;
+    bool isDone = this->forEachBreak('\n', '\r', [&](std::size_t index, bool isAfterReturn) -> bool {
+        bool isContinued = callback(startIndex, isAfterReturn ? index - 1 : index);
+        startIndex = index + 1;
+        return isContinued;
+    }, threads);
+    if(!isDone) {
+        return false;
+    }
+    std::size_t length = this->length();
+    if(startIndex < length) {
+        return callback(startIndex, length);
+    }
+    return true;
+}
+
+std::size_t SuperString::count(const SuperString &other, std::size_t threads) const {
+    if(other.length() == 0) {
+        return 0;
+    }
+    if(other.length() == 1) {
+        return this->countBreaks(other.codeUnitAt(0).ok(), threads);
+    }
+    std::size_t count = 0;
+    this->forEachOccurrence(Finder(other), [&](std::size_t) -> bool {
+        count++;
+        return true;
+    }, threads);
+    return count;
+}
+
+bool SuperString::split(const SuperString &delimiter, const SuperString::StringCallback &callback,
+                        std::size_t threads) const {
+    return this->forEachPiece(delimiter, [&](std::size_t startIndex, std::size_t endIndex) -> bool {
+        return callback(this->piece(startIndex, endIndex));
+    }, threads);
+}
+
+std::size_t SuperString::split(const SuperString &delimiter, std::vector<SuperString> &pieces, bool isBatched,
+                               std::size_t threads) const {
+    std::size_t count = 0;
+    if(threads != 1 && delimiter.length() == 1) {
+        count = this->splitBreaks(delimiter.codeUnitAt(0).ok(), -1, false, pieces, threads);
+        if(count != (std::size_t) -1) {
+            return count;
+        }
+        count = 0;
+    }
+    if(isBatched) {
+        this->forEachPiece(delimiter, [&](std::size_t, std::size_t) -> bool {
+            count++;
+            return true;
+        }, threads);
+        pieces.reserve(pieces.size() + count);
+        NodePool::reserve(sizeof(SubstringSequence), count);
+        count = 0;
+    }
+    this->forEachPiece(delimiter, [&](std::size_t startIndex, std::size_t endIndex) -> bool {
+        pieces.push_back(this->piece(startIndex, endIndex));
+        count++;
+        return true;
+    }, threads);
+    return count;
+}
+
+bool SuperString::splitLines(const SuperString::StringCallback &callback, std::size_t threads) const {
+    return this->forEachLine([&](std::size_t startIndex, std::size_t endIndex) -> bool {
+        return callback(this->piece(startIndex, endIndex));
+    }, threads);
+}
+
+std::size_t SuperString::splitLines(std::vector<SuperString> &lines, bool isBatched, std::size_t threads) const {
+    std::size_t count = 0;
+    if(threads != 1) {
+        count = this->splitBreaks('\n', '\r', true, lines, threads);
+        if(count != (std::size_t) -1) {
+            return count;
+        }
+        count = 0;
+    }
+    if(isBatched) {
+        this->forEachLine([&](std::size_t, std::size_t) -> bool {
+            count++;
+            return true;
+        }, threads);
+        lines.reserve(lines.size() + count);
+        NodePool::reserve(sizeof(SubstringSequence), count);
+        count = 0;
+    }
+    this->forEachLine([&](std::size_t startIndex, std::size_t endIndex) -> bool {
+        lines.push_back(this->piece(startIndex, endIndex));
+        count++;
+        return true;
+    }, threads);
+    return count;
+}
+
 SuperString::Result<int, SuperString::Error> SuperString::codeUnitAt(std::size_t index) const {
     if(this->_sequence != NULL) {
         return this->_sequence->codeUnitAt(index);
@@ -86,11 +273,41 @@ SuperString::Result<int, SuperString::Error> SuperString::codeUnitAt(std::size_t
     return Result<int, SuperString::Error>(Error::Unexpected);
 }
 
+SuperString::Cursor SuperString::begin() const {
+    return Cursor(this->_sequence, 0);
+}
+
+SuperString::Cursor SuperString::end() const {
+    return Cursor(this->_sequence, this->length());
+}
+
+bool SuperString::forEachChunk(const SuperString::ChunkCallback &callback) const {
+    if(this->_sequence != NULL) {
+        return this->_sequence->forEachChunk(callback, 0, this->_sequence->length());
+    }
+    return true;
+}
+
+bool SuperString::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                               std::size_t endIndex) const {
+    std::size_t length = this->length();
+    if(length < startIndex || length < endIndex || endIndex < startIndex) {
+        return false;
+    }
+    if(this->_sequence != NULL) {
+        return this->_sequence->forEachChunk(callback, startIndex, endIndex);
+    }
+    return true;
+}
+
 SuperString::Result<SuperString, SuperString::Error>
 SuperString::substring(std::size_t startIndex, std::size_t endIndex) const {
     if(this->_sequence != NULL) {
         return this->_sequence->substring(startIndex, endIndex);
     }
+    if(startIndex == 0 && endIndex == 0) {
+        return Result<SuperString, Error>(*this);
+    }
     return Result<SuperString, Error>(Error::RangeError);
 }
 
@@ -111,17 +328,40 @@ SuperString SuperString::substr(std::size_t pos) const {
 }
 
 bool SuperString::print(std::ostream &stream) const {
-    if(this->_sequence != NULL) {
-        return this->_sequence->print(stream);
-    }
-    return true;
+    Writer writer(stream);
+    bool isOk = this->forEachChunk([&writer](const Chunk &chunk) -> bool {
+        return writer.write(chunk);
+    });
+    writer.flush();
+    return isOk;
 }
 
 bool SuperString::print(std::ostream &stream, std::size_t startIndex, std::size_t endIndex) const {
-    if(this->_sequence != NULL) {
-        return this->_sequence->print(stream, startIndex, endIndex);
+    Writer writer(stream);
+    bool isOk = this->forEachChunk([&writer](const Chunk &chunk) -> bool {
+        return writer.write(chunk);
+    }, startIndex, endIndex);
+    writer.flush();
+    return isOk;
+}
+
+SuperString::Result<std::size_t, SuperString::Error> SuperString::writeTo(int fd) const {
+    Writer writer(fd);
+    this->forEachChunk([&writer](const Chunk &chunk) -> bool {
+        return writer.write(chunk);
+    });
+    writer.flush();
+    if(!writer.isOk()) {
+        return Result<std::size_t, Error>(Error::IOError);
     }
-    return true;
+    return Result<std::size_t, Error>(writer.written());
+}
+
+SuperString::Result<std::size_t, SuperString::Error> SuperString::writeTo(std::FILE *file) const {
+    if(std::fflush(file) != 0) {
+        return Result<std::size_t, Error>(Error::IOError);
+    }
+    return this->writeTo(fileno(file));
 }
 
 SuperString SuperString::trim() const {
@@ -145,6 +385,32 @@ SuperString SuperString::trimRight() const {
     return *this;
 }
 
+SuperString SuperString::flatten(bool isUTF8) const {
+    if(this->_sequence == NULL) {
+        return *this;
+    }
+    if(this->_sequence->depth() == 0) {
+        // already a leaf, only transcoded to UTF-8 when asked
+        bool isInUTF8 = true;
+        this->_sequence->forEachChunk([&](const Chunk &chunk) -> bool {
+            isInUTF8 = chunk.encoding() == Encoding::ASCII || chunk.encoding() == Encoding::UTF8;
+            return false;
+        }, 0, this->length());
+        if(!isUTF8 || isInUTF8) {
+            return *this;
+        }
+    }
+    const StringSequence *leaf = ReferenceStringSequence::materialize(this->_sequence, isUTF8);
+    SuperString string((StringSequence *) leaf);
+#ifndef SUPERSTRING_THREAD_SAFE
+    // sequences may be read by other threads, so they are only changed when not thread-safe
+    if(this->_sequence->depth() > 0) {
+        ((const ReferenceStringSequence *) this->_sequence)->flatten(leaf);
+    }
+#endif
+    return string;
+}
+
 // TODO: delete this two methods
 std::size_t SuperString::freeingCost() const {
     return this->_sequence->freeingCost();
@@ -155,27 +421,60 @@ std::size_t SuperString::keepingCost() const {
 }
 
 SuperString SuperString::operator+(const SuperString &other) const {
-    ConcatenationSequence *sequence = new ConcatenationSequence(this->_sequence, other._sequence);
-    return SuperString(sequence);
+    if(other._sequence == NULL) {
+        return *this;
+    }
+    if(this->_sequence == NULL) {
+        return other;
+    }
+    return SuperString(ConcatenationSequence::join(this->_sequence, other._sequence));
 }
 
 SuperString SuperString::operator*(std::size_t times) const {
+    if(this->_sequence == NULL) {
+        return *this;
+    }
     MultipleSequence *sequence = new MultipleSequence(this->_sequence, times);
     return SuperString(sequence);
 }
 
 SuperString &SuperString::operator=(const SuperString &other) {
     if(this != &other) {
-        if(this->_sequence->refRelease() == 0) {
-            this->_sequence->doDelete();
+        if(other._sequence != NULL) {
+            other._sequence->refAdd();
+        }
+        if(this->_sequence != NULL) {
+            this->_sequence->release();
         }
         this->_sequence = other._sequence;
-        this->_sequence->refAdd();
+    }
+    return *this;
+}
+
+SuperString &SuperString::operator=(SuperString &&other) noexcept {
+    if(this != &other) {
+        const StringSequence *sequence = this->_sequence;
+        this->_sequence = other._sequence;
+        other._sequence = NULL;
+        if(sequence != NULL) {
+            sequence->release();
+        }
     }
     return *this;
 }
 
 bool SuperString::operator==(const SuperString &other) const {
+    std::size_t length = this->length();
+    if(length != other.length()) {
+        return false;
+    }
+    if(length == 0) {
+        return true; // both empty, one of them may have no sequence
+    }
+    if(this->_sequence->isHashed() && other._sequence->isHashed() &&
+       this->_sequence->hash() != other._sequence->hash()) {
+        return false; // only with hashes already computed, computing them costs more than comparing
+    }
     return this->compareTo(other) == 0;
 }
 
@@ -194,6 +493,9 @@ SuperString SuperString::Const(const char *chars, SuperString::Encoding encoding
         case Encoding::UTF32:
             sequence = new SuperString::ConstUTF32Sequence((Byte *) chars);
             break;
+        case Encoding::UTF16LE:
+            sequence = new SuperString::ConstUTF16LESequence((Byte *) chars);
+            break;
     }
     return SuperString(sequence);
 }
@@ -221,6 +523,9 @@ SuperString SuperString::Copy(const char *chars, Encoding encoding) {
         case Encoding::UTF32:
             sequence = new SuperString::CopyUTF32Sequence((Byte *) chars);
             break;
+        case Encoding::UTF16LE:
+            sequence = new SuperString::CopyUTF16LESequence((Byte *) chars);
+            break;
     }
     return SuperString(sequence);
 }
@@ -233,224 +538,2420 @@ SuperString SuperString::Copy(const SuperString::Byte *bytes, Encoding encoding)
     return SuperString::Copy((const char *) bytes, encoding);
 }
 
-//*-- SuperString::StringSequence (abstract|internal)
-SuperString::StringSequence::StringSequence()
-        : _refCount(0) {
-    // nothing go here
-}
-
-SuperString::StringSequence::~StringSequence() {
-    // nothing go here
-}
-
-bool SuperString::StringSequence::isEmpty() const {
-    return this->length() == 0;
+SuperString SuperString::Const(const char *chars, std::size_t memoryLength, SuperString::Encoding encoding) {
+    StringSequence *sequence = NULL;
+    switch(encoding) {
+        case Encoding::ASCII:
+            sequence = new SuperString::ConstASCIISequence((Byte *) chars, memoryLength);
+            break;
+        case Encoding::UTF8:
+            sequence = new SuperString::ConstUTF8Sequence((Byte *) chars, memoryLength);
+            break;
+        case Encoding::UTF16BE:
+            sequence = new SuperString::ConstUTF16BESequence((Byte *) chars, memoryLength - memoryLength % 2);
+            break;
+        case Encoding::UTF32:
+            sequence = new SuperString::ConstUTF32Sequence((Byte *) chars, memoryLength);
+            break;
+        case Encoding::UTF16LE:
+            sequence = new SuperString::ConstUTF16LESequence((Byte *) chars, memoryLength - memoryLength % 2);
+            break;
+    }
+    return SuperString(sequence);
 }
 
-bool SuperString::StringSequence::isNotEmpty() const {
-    return this->length() > 0;
+SuperString
+SuperString::Const(const SuperString::Byte *bytes, std::size_t memoryLength, SuperString::Encoding encoding) {
+    return SuperString::Const((const char *) bytes, memoryLength, encoding);
 }
 
-SuperString::Result<std::size_t, SuperString::Error> SuperString::StringSequence::indexOf(SuperString other) const {
-    for(std::size_t i = 0, length = this->length(); i < (length - other.length()); i++) {
-        if(this->_substringMatches(i, other)) {
-            return Result<std::size_t, Error>(i);
+// the copy gets a terminator, as the text data of the other constructors of the same leaves
+SuperString SuperString::Copy(const char *chars, std::size_t memoryLength, SuperString::Encoding encoding) {
+    StringSequence *sequence = NULL;
+    switch(encoding) {
+        case Encoding::ASCII: {
+            Byte *data = new Byte[memoryLength + 1];
+            std::memcpy(data, chars, memoryLength);
+            data[memoryLength] = 0x00;
+            sequence = new SuperString::CopyASCIISequence(data, memoryLength);
+            break;
         }
-    }
-    return Result<std::size_t, Error>(Error::NotFound);
-}
-
-SuperString::Result<std::size_t, SuperString::Error> SuperString::StringSequence::lastIndexOf(SuperString other) const {
-    for(std::size_t i = this->length() - other.length(); i > 0; i--) {
-        if(this->_substringMatches(i - 1, other)) {
-            return Result<std::size_t, Error>(i - 1);
+        case Encoding::UTF8: {
+            Byte *data = new Byte[memoryLength + 1];
+            std::memcpy(data, chars, memoryLength);
+            data[memoryLength] = 0x00;
+            sequence = new SuperString::CopyUTF8Sequence(data, SuperString::UTF8::length(data, memoryLength),
+                                                         memoryLength + 1, false);
+            break;
+        }
+        case Encoding::UTF16BE: {
+            memoryLength -= memoryLength % 2;
+            Byte *data = new Byte[memoryLength + 2];
+            std::memcpy(data, chars, memoryLength);
+            data[memoryLength] = 0x00;
+            data[memoryLength + 1] = 0x00;
+            sequence = new SuperString::CopyUTF16BESequence(data, SuperString::UTF16BE::length(data, memoryLength),
+                                                            memoryLength + 2);
+            break;
+        }
+        case Encoding::UTF32: {
+            std::size_t length = memoryLength / sizeof(int);
+            int *data = new int[length + 1];
+            std::memcpy(data, chars, length * sizeof(int));
+            data[length] = 0;
+            sequence = new SuperString::CopyUTF32Sequence(data, length);
+            break;
+        }
+        case Encoding::UTF16LE: {
+            memoryLength -= memoryLength % 2;
+            Byte *data = new Byte[memoryLength + 2];
+            std::memcpy(data, chars, memoryLength);
+            data[memoryLength] = 0x00;
+            data[memoryLength + 1] = 0x00;
+            sequence = new SuperString::CopyUTF16LESequence(data, SuperString::UTF16LE::length(data, memoryLength),
+                                                            memoryLength + 2);
+            break;
         }
     }
-    return Result<std::size_t, Error>(Error::NotFound);
+    return SuperString(sequence);
 }
 
-void SuperString::StringSequence::refAdd() const {
-    StringSequence *self = (StringSequence *) (unsigned long) this;
-    self->_refCount++;
+SuperString
+SuperString::Copy(const SuperString::Byte *bytes, std::size_t memoryLength, SuperString::Encoding encoding) {
+    return SuperString::Copy((const char *) bytes, memoryLength, encoding);
 }
 
-std::size_t SuperString::StringSequence::refRelease() const {
-    StringSequence *self = (StringSequence *) (unsigned long) this;
-    if(self->_refCount == 0) {
-        return 0;
+// sets [encoding] to the byte order told by the byte order mark of [bytes], U+FEFF in the byte order of the
+// data, and returns its memory length, 0 without one
+static std::size_t sniffUTF16(const SuperString::Byte *bytes, std::size_t memoryLength,
+                              SuperString::Encoding &encoding) {
+    if(memoryLength >= 2 && bytes[0] == 0xfe && bytes[1] == 0xff) {
+        encoding = SuperString::Encoding::UTF16BE;
+        return 2;
+    } else if(memoryLength >= 2 && bytes[0] == 0xff && bytes[1] == 0xfe) {
+        encoding = SuperString::Encoding::UTF16LE;
+        return 2;
     }
-    return --self->_refCount;
-}
-
-std::size_t SuperString::StringSequence::refCount() const {
-    return this->_refCount;
+    return 0;
 }
 
-void SuperString::StringSequence::addReferencer(SuperString::ReferenceStringSequence *sequence) const {
-    StringSequence *self = (StringSequence *) (unsigned long) this;
-    self->_referencers.push(sequence);
+SuperString SuperString::ConstUTF16(const char *chars, std::size_t memoryLength, SuperString::Encoding encoding) {
+    return SuperString::ConstUTF16((const Byte *) chars, memoryLength, encoding);
 }
 
-void SuperString::StringSequence::removeReferencer(SuperString::ReferenceStringSequence *sequence) const {
-    StringSequence *self = (StringSequence *) (unsigned long) this;
-    self->_referencers.remove(sequence);
+SuperString
+SuperString::ConstUTF16(const SuperString::Byte *bytes, std::size_t memoryLength, SuperString::Encoding encoding) {
+    std::size_t markLength = sniffUTF16(bytes, memoryLength, encoding);
+    return SuperString::Const(bytes + markLength, memoryLength - markLength, encoding);
 }
 
-std::size_t SuperString::StringSequence::freeingCost() const {
-    std::size_t cost = 0;
-    SingleLinkedList<ReferenceStringSequence *>::Node<ReferenceStringSequence *> *node = this->_referencers._head;
-    while(node != NULL) {
-        cost += node->_data->reconstructionCost(this);
-        node = node->_next;
-    }
-    return cost;
+SuperString SuperString::CopyUTF16(const char *chars, std::size_t memoryLength, SuperString::Encoding encoding) {
+    return SuperString::CopyUTF16((const Byte *) chars, memoryLength, encoding);
 }
 
-void SuperString::StringSequence::reconstructReferencers() {
-    SingleLinkedList<ReferenceStringSequence *>::Node<ReferenceStringSequence *> *node = this->_referencers._head;
-    while(node != NULL) {
-        node->_data->reconstruct(this);
-        node = node->_next;
-    }
+SuperString
+SuperString::CopyUTF16(const SuperString::Byte *bytes, std::size_t memoryLength, SuperString::Encoding encoding) {
+    std::size_t markLength = sniffUTF16(bytes, memoryLength, encoding);
+    return SuperString::Copy(bytes + markLength, memoryLength - markLength, encoding);
 }
 
-bool SuperString::StringSequence::_substringMatches(std::size_t startIndex,
-                                                                 SuperString other) const {
-    if(other.isEmpty()) {
-        return true;
-    }
-    std::size_t length = other.length();
-    if(startIndex + length > this->length()) {
-        return false;
-    }
-    for(int i = 0; i < length; i++) {
-        if(this->codeUnitAt(i + startIndex).ok() != other.codeUnitAt(i).ok()) {
-            return false;
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::ConstValidated(const char *chars, SuperString::Encoding encoding, std::size_t *invalidOffset) {
+    Result<Pair<std::size_t, std::size_t>, std::size_t> lengths = SuperString::validate((Byte *) chars, encoding);
+    if(lengths.isErr()) {
+        if(invalidOffset != NULL) {
+            *invalidOffset = lengths.err();
         }
+        return Result<SuperString, Error>(Error::InvalidByteSequence);
     }
-    return true;
+    if(encoding == Encoding::UTF8) {
+        // the lengths are known already, and characters can be decoded without checks
+        Pair<std::size_t, std::size_t> lengthAndMemoryLength = lengths.ok();
+        return Result<SuperString, Error>(SuperString(new SuperString::ConstUTF8Sequence(
+                (Byte *) chars, lengthAndMemoryLength.first(), lengthAndMemoryLength.second())));
+    }
+    return Result<SuperString, Error>(SuperString::Const(chars, encoding));
 }
 
-//*-- SuperString::ReferenceStringSequence (abstract|internal)
-SuperString::ReferenceStringSequence::~ReferenceStringSequence() {
-    // nothing go here
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::ConstValidated(const int *chars, SuperString::Encoding encoding, std::size_t *invalidOffset) {
+    return SuperString::ConstValidated((const char *) chars, encoding, invalidOffset);
 }
 
-//*-- SuperString::ConstASCIISequence (internal)
-SuperString::ConstASCIISequence::ConstASCIISequence(const Byte *bytes)
-        : _bytes(bytes),
-          _status(SuperString::ConstASCIISequence::Status::LengthNotComputed) {
-    // nothing go here
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::ConstValidated(const SuperString::Byte *bytes, SuperString::Encoding encoding,
+                            std::size_t *invalidOffset) {
+    return SuperString::ConstValidated((const char *) bytes, encoding, invalidOffset);
 }
 
-SuperString::ConstASCIISequence::~ConstASCIISequence() {
-    this->reconstructReferencers();
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::CopyValidated(const char *chars, SuperString::Encoding encoding, std::size_t *invalidOffset) {
+    Result<Pair<std::size_t, std::size_t>, std::size_t> lengths = SuperString::validate((Byte *) chars, encoding);
+    if(lengths.isErr()) {
+        if(invalidOffset != NULL) {
+            *invalidOffset = lengths.err();
+        }
+        return Result<SuperString, Error>(Error::InvalidByteSequence);
+    }
+    if(encoding == Encoding::UTF8) {
+        Pair<std::size_t, std::size_t> lengthAndMemoryLength = lengths.ok();
+        Byte *data = new Byte[lengthAndMemoryLength.second()];
+        std::memcpy(data, chars, lengthAndMemoryLength.second());
+        return Result<SuperString, Error>(SuperString(new SuperString::CopyUTF8Sequence(
+                data, lengthAndMemoryLength.first(), lengthAndMemoryLength.second(), true)));
+    }
+    return Result<SuperString, Error>(SuperString::Copy(chars, encoding));
 }
 
-std::size_t SuperString::ConstASCIISequence::length() const /*override*/ {
-    if(this->_status == Status::LengthNotComputed) {
-        ConstASCIISequence *self = ((ConstASCIISequence *) ((std::size_t) this)); // to keep this method `const`
-        self->_status = Status::LengthComputed;
-        self->_length = SuperString::ASCII::length(this->_bytes);
-    }
-    return this->_length;
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::CopyValidated(const int *chars, SuperString::Encoding encoding, std::size_t *invalidOffset) {
+    return SuperString::CopyValidated((const char *) chars, encoding, invalidOffset);
 }
 
-SuperString::Result<int, SuperString::Error>
-SuperString::ConstASCIISequence::codeUnitAt(std::size_t index) const {
-    if(index < this->length()) {
-        return Result<int, SuperString::Error>(SuperString::ASCII::codeUnitAt(this->_bytes, index));
-    }
-    return Result<int, SuperString::Error>(Error::RangeError);
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::CopyValidated(const SuperString::Byte *bytes, SuperString::Encoding encoding,
+                           std::size_t *invalidOffset) {
+    return SuperString::CopyValidated((const char *) bytes, encoding, invalidOffset);
 }
 
 SuperString::Result<SuperString, SuperString::Error>
-SuperString::ConstASCIISequence::substring(std::size_t startIndex,
-                                           std::size_t endIndex) const {
-    // TODO: General code, specify + repeated * times
-    if(this->length() < startIndex || this->length() < endIndex) {
-        return Result<SuperString, Error>(Error::RangeError);
+SuperString::Map(const char *path, SuperString::Encoding encoding, SuperString::Access access) {
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0) {
+        return Result<SuperString, Error>(Error::IOError);
+    }
+    struct stat status;
+    void *address = MAP_FAILED;
+    std::size_t size = 0;
+    if(::fstat(fd, &status) == 0) {
+        // the file is mapped over anonymous zero pages, so that an empty file is mapped too, and the text
+        // data is followed by a terminator as the one of the other leaves
+        std::size_t pageSize = (std::size_t) ::sysconf(_SC_PAGESIZE);
+        size = ((std::size_t) status.st_size / pageSize + 1) * pageSize;
+        address = ::mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(address != MAP_FAILED && status.st_size != 0 &&
+           ::mmap(address, (std::size_t) status.st_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            int error = errno;
+            ::munmap(address, size);
+            errno = error;
+            address = MAP_FAILED;
+        }
+    }
+    int error = errno;
+    ::close(fd);
+    if(address == MAP_FAILED) {
+        errno = error;
+        return Result<SuperString, Error>(Error::IOError);
+    }
+    if(access != Access::Normal) {
+        ::madvise(address, size, (access == Access::Sequential) ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+    std::size_t memoryLength = (std::size_t) status.st_size;
+    if(encoding == Encoding::UTF16BE || encoding == Encoding::UTF16LE) {
+        memoryLength -= memoryLength % 2;
+    }
+    StringSequence *sequence = NULL;
+    switch(encoding) {
+        case Encoding::ASCII:
+            sequence = new SuperString::MappedSequence<ConstASCIISequence>(address, size, memoryLength);
+            break;
+        case Encoding::UTF8:
+            sequence = new SuperString::MappedSequence<ConstUTF8Sequence>(address, size, memoryLength);
+            break;
+        case Encoding::UTF16BE:
+            sequence = new SuperString::MappedSequence<ConstUTF16BESequence>(address, size, memoryLength);
+            break;
+        case Encoding::UTF32:
+            sequence = new SuperString::MappedSequence<ConstUTF32Sequence>(address, size, memoryLength);
+            break;
+        case Encoding::UTF16LE:
+            sequence = new SuperString::MappedSequence<ConstUTF16LESequence>(address, size, memoryLength);
+            break;
     }
-    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
     return Result<SuperString, Error>(SuperString(sequence));
 }
 
-bool SuperString::ConstASCIISequence::print(std::ostream &stream) const {
-    SuperString::ASCII::print(stream, this->_bytes);
-    return true;
+void SuperString::setAllocator(void *(*allocate)(std::size_t size), void (*deallocate)(void *pointer)) {
+    NodePool::_allocate = allocate;
+    NodePool::_deallocate = deallocate;
 }
 
-bool SuperString::ConstASCIISequence::print(std::ostream &stream, std::size_t startIndex,
-                                                         std::size_t endIndex) const {
-    if(this->length() < startIndex || this->length() < endIndex) {
-        return false;
-    }
-    SuperString::ASCII::print(stream, this->_bytes, startIndex, endIndex);
-    return true;
+std::size_t SuperString::liveNodes() {
+    return NodePool::_liveNodes;
 }
 
-SuperString SuperString::ConstASCIISequence::trim() const {
-    Pair<std::size_t, std::size_t> indexes = SuperString::ASCII::trim(this->_bytes, this->_length);
-    return this->substring(indexes.first(), indexes.second()).ok();
+std::size_t SuperString::peakNodes() {
+    return NodePool::_peakNodes;
 }
 
-SuperString SuperString::ConstASCIISequence::trimLeft() const {
-    return this->substring(SuperString::ASCII::trimLeft(this->_bytes), this->length()).ok();
+std::size_t SuperString::trimNodes() {
+    return NodePool::trim();
 }
 
-SuperString SuperString::ConstASCIISequence::trimRight() const {
+//*-- SuperString::Cursor
+SuperString::Cursor::Cursor()
+        : _root(NULL),
+          _length(0),
+          _index(0),
+          _frames(NULL),
+          _depth(0),
+          _capacity(0),
+          _bytes(NULL),
+          _encoding(Encoding::UTF32),
+          _data(NULL),
+          _end(NULL),
+          _chunkStartIndex(0),
+          _chunkEndIndex(0) {
+    // nothing go here
+}
+
+SuperString::Cursor::Cursor(const SuperString::StringSequence *root, std::size_t index)
+        : _root(root),
+          _length(0),
+          _index(index),
+          _frames(NULL),
+          _depth(0),
+          _capacity(0),
+          _bytes(NULL),
+          _encoding(Encoding::UTF32),
+          _data(NULL),
+          _end(NULL),
+          _chunkStartIndex(index),
+          _chunkEndIndex(index) {
+    if(this->_root != NULL) {
+        this->_root->refAdd();
+        this->_length = this->_root->length();
+    }
+    // the path is only built when the cursor is on a code unit, so that `end()` stays cheap
+    if(this->_index < this->_length) {
+        this->seek(this->_index);
+    }
+}
+
+SuperString::Cursor::Cursor(const SuperString::Cursor &other) /*copy*/
+        : _root(NULL),
+          _length(0),
+          _index(0),
+          _frames(NULL),
+          _depth(0),
+          _capacity(0),
+          _bytes(NULL),
+          _encoding(Encoding::UTF32),
+          _data(NULL),
+          _end(NULL),
+          _chunkStartIndex(0),
+          _chunkEndIndex(0) {
+    *this = other;
+}
+
+SuperString::Cursor::~Cursor() {
+    while(this->_depth > 0) {
+        this->pop();
+    }
+    delete[] this->_frames;
+    if(this->_root != NULL) {
+        this->_root->release();
+    }
+}
+
+std::size_t SuperString::Cursor::index() const {
+    return this->_index;
+}
+
+int SuperString::Cursor::operator*() const {
+    switch(this->_encoding) {
+        case Encoding::ASCII:
+            return *this->_bytes;
+        case Encoding::UTF8:
+            if(this->_end != NULL) {
+                // the text data may be malformed, or cut in the middle of its last character
+                Result<int, Error> result = SuperString::UTF8::decode(this->_bytes, this->_end);
+                return result.isOk() ? result.ok() : (int) result.err();
+            }
+            return SuperString::UTF8::decode(this->_bytes);
+        case Encoding::UTF16BE:
+            return SuperString::UTF16BE::decode(this->_bytes);
+        case Encoding::UTF16LE:
+            return SuperString::UTF16LE::decode(this->_bytes);
+        case Encoding::UTF32:
+            return SuperString::UTF32::codeUnitAt(this->_bytes, 0);
+    }
+    return 0;
+}
+
+SuperString::Cursor &SuperString::Cursor::operator++() {
+    if(this->_index >= this->_length) {
+        return *this;
+    }
+    this->_index++;
+    if(this->_index < this->_chunkEndIndex) {
+        switch(this->_encoding) {
+            case Encoding::ASCII:
+                this->_bytes += 1;
+                break;
+            case Encoding::UTF8: {
+                // a byte that cannot start a character is a character of its own, as in `UTF8Index`
+                std::size_t sequenceLength = SuperString::UTF8::sequenceLength(*this->_bytes);
+                this->_bytes += (sequenceLength == 0) ? 1 : sequenceLength;
+                break;
+            }
+            case Encoding::UTF16BE:
+                this->_bytes += ((*this->_bytes & 0xfc) == 0xd8) ? 4 : 2;
+                break;
+            case Encoding::UTF16LE:
+                this->_bytes += ((*(this->_bytes + 1) & 0xfc) == 0xd8) ? 4 : 2;
+                break;
+            case Encoding::UTF32:
+                this->_bytes += sizeof(int);
+                break;
+        }
+    } else if(this->_index < this->_length) {
+        this->seek(this->_index);
+    } else {
+        this->_bytes = NULL;
+        this->_chunkStartIndex = this->_length;
+        this->_chunkEndIndex = this->_length;
+    }
+    return *this;
+}
+
+SuperString::Cursor SuperString::Cursor::operator++(int) {
+    Cursor cursor(*this);
+    ++(*this);
+    return cursor;
+}
+
+SuperString::Cursor &SuperString::Cursor::operator--() {
+    if(this->_index == 0) {
+        return *this;
+    }
+    this->_index--;
+    if(this->_chunkStartIndex <= this->_index && this->_index < this->_chunkEndIndex) {
+        switch(this->_encoding) {
+            case Encoding::ASCII:
+                this->_bytes -= 1;
+                break;
+            case Encoding::UTF8:
+                if(this->_end == NULL) {
+                    do {
+                        this->_bytes--;
+                    } while((*this->_bytes & 0xc0) == 0x80);
+                } else if(!this->stepBack()) {
+                    this->seek(this->_index);
+                }
+                break;
+            case Encoding::UTF16BE:
+                this->_bytes -= 2;
+                if((*this->_bytes & 0xfc) == 0xdc) {
+                    this->_bytes -= 2;
+                }
+                break;
+            case Encoding::UTF16LE:
+                this->_bytes -= 2;
+                if((*(this->_bytes + 1) & 0xfc) == 0xdc) {
+                    this->_bytes -= 2;
+                }
+                break;
+            case Encoding::UTF32:
+                this->_bytes -= sizeof(int);
+                break;
+        }
+    } else {
+        this->seek(this->_index);
+    }
+    return *this;
+}
+
+SuperString::Cursor SuperString::Cursor::operator--(int) {
+    Cursor cursor(*this);
+    --(*this);
+    return cursor;
+}
+
+bool SuperString::Cursor::operator==(const SuperString::Cursor &other) const {
+    return this->_root == other._root && this->_index == other._index;
+}
+
+bool SuperString::Cursor::operator!=(const SuperString::Cursor &other) const {
+    return !(*this == other);
+}
+
+SuperString::Cursor &SuperString::Cursor::operator=(const SuperString::Cursor &other) {
+    if(this != &other) {
+        if(other._root != NULL) {
+            other._root->refAdd();
+        }
+        while(this->_depth > 0) {
+            this->pop();
+        }
+        if(this->_root != NULL) {
+            this->_root->release();
+        }
+        this->_root = other._root;
+        this->_length = other._length;
+        this->_index = other._index;
+        for(std::size_t i = 0; i < other._depth; i++) {
+            const Frame &frame = other._frames[i];
+            this->push(frame._sequence, frame._offset, frame._startIndex, frame._endIndex);
+        }
+        this->_bytes = other._bytes;
+        this->_encoding = other._encoding;
+        this->_data = other._data;
+        this->_end = other._end;
+        this->_chunkStartIndex = other._chunkStartIndex;
+        this->_chunkEndIndex = other._chunkEndIndex;
+    }
+    return *this;
+}
+
+bool SuperString::Cursor::stepBack() {
+    // the last byte that is not a continuation, at most 3 of them back, is the previous character when its
+    // sequence ends where the current one starts, and no lead byte before it has a sequence reaching over it
+    const Byte *bytes = this->_bytes - 1;
+    while(bytes > this->_data && this->_bytes - bytes < 4 && (*bytes & 0xc0) == 0x80) {
+        bytes--;
+    }
+    std::size_t sequenceLength = SuperString::UTF8::sequenceLength(*bytes);
+    if(bytes + ((sequenceLength == 0) ? 1 : sequenceLength) != this->_bytes) {
+        return false;
+    }
+    for(std::size_t k = 1; k <= 3 && k <= (std::size_t) (bytes - this->_data); k++) {
+        if(SuperString::UTF8::sequenceLength(*(bytes - k)) > k) {
+            return false;
+        }
+    }
+    this->_bytes = bytes;
+    return true;
+}
+
+void SuperString::Cursor::seek(std::size_t index) {
+    // climb up to the first sequence that contains [index], then go down to its text data
+    while(this->_depth > 0 && (index < this->_frames[this->_depth - 1]._startIndex ||
+                               this->_frames[this->_depth - 1]._endIndex <= index)) {
+        this->pop();
+    }
+    if(this->_depth == 0) {
+        this->push(this->_root, 0, 0, this->_length);
+    }
+    while(true) {
+        Frame frame = this->_frames[this->_depth - 1];
+        Piece piece = frame._sequence->pieceAt(index - frame._offset);
+        std::size_t startIndex = std::max(frame._startIndex, frame._offset + piece._startIndex);
+        std::size_t endIndex = std::min(frame._endIndex, frame._offset + piece._endIndex);
+        if(piece._sequence == NULL) {
+            this->_bytes = piece._bytes;
+            this->_encoding = piece._encoding;
+            this->_data = piece._data;
+            this->_end = piece._end;
+            this->_chunkStartIndex = startIndex;
+            this->_chunkEndIndex = endIndex;
+            return;
+        }
+        this->push(piece._sequence, frame._offset + piece._startIndex - piece._shift, startIndex, endIndex);
+    }
+}
+
+void SuperString::Cursor::push(const SuperString::StringSequence *sequence, std::size_t offset,
+                               std::size_t startIndex, std::size_t endIndex) {
+    if(this->_depth == this->_capacity) {
+        // the depth of the root is enough for the whole path, unless it is shallower than the copied cursor's
+        std::size_t capacity = std::max(this->_capacity * 2, this->_root->depth() + 1);
+        Frame *frames = new Frame[capacity];
+        std::copy_n(this->_frames, this->_depth, frames);
+        delete[] this->_frames;
+        this->_frames = frames;
+        this->_capacity = capacity;
+    }
+    // sequences on the path are retained, so that none of them gets reconstructed under the cursor
+    sequence->refAdd();
+    Frame &frame = this->_frames[this->_depth++];
+    frame._sequence = sequence;
+    frame._offset = offset;
+    frame._startIndex = startIndex;
+    frame._endIndex = endIndex;
+}
+
+void SuperString::Cursor::pop() {
+    this->_frames[--this->_depth]._sequence->release();
+}
+
+//*-- SuperString::Chunk
+SuperString::Chunk::Chunk(const SuperString::Byte *bytes, std::size_t memoryLength, SuperString::Encoding encoding,
+                          std::size_t length)
+        : _bytes(bytes),
+          _memoryLength(memoryLength),
+          _encoding(encoding),
+          _length(length) {
+    // nothing go here
+}
+
+const SuperString::Byte *SuperString::Chunk::bytes() const {
+    return this->_bytes;
+}
+
+std::size_t SuperString::Chunk::memoryLength() const {
+    return this->_memoryLength;
+}
+
+SuperString::Encoding SuperString::Chunk::encoding() const {
+    return this->_encoding;
+}
+
+std::size_t SuperString::Chunk::length() const {
+    return this->_length;
+}
+
+//*-- SuperString::PatternSet
+SuperString::PatternSet::PatternSet(const SuperString *patterns, std::size_t count)
+        : _count(count) {
+    this->_lengths = new std::size_t[count + 1];
+    this->_nextPatterns = new std::size_t[count + 1];
+    // the code units of all the patterns, one after the other
+    std::size_t *starts = new std::size_t[count + 1];
+    std::size_t total = 0, longest = 0;
+    for(std::size_t i = 0; i < count; i++) {
+        starts[i] = total;
+        this->_lengths[i] = patterns[i].length();
+        this->_nextPatterns[i] = count;
+        total += this->_lengths[i];
+        longest = std::max(longest, this->_lengths[i]);
+    }
+    starts[count] = total;
+    int *codeUnits = new int[total + 1]();
+    for(std::size_t i = 0; i < count; i++) {
+        std::size_t j = starts[i];
+        patterns[i].forEachChunk([&](const Chunk &chunk) -> bool {
+            const Byte *pointer = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+            while(pointer < end && j < starts[i + 1]) {
+                codeUnits[j++] = SuperString::Finder::decode(pointer, end, chunk.encoding());
+            }
+            return true;
+        });
+    }
+    // the trie is first built in depth-first order, walking the patterns in lexicographic order
+    std::size_t *order = new std::size_t[count + 1];
+    for(std::size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order, order + count, [&](std::size_t a, std::size_t b) -> bool {
+        return std::lexicographical_compare(codeUnits + starts[a], codeUnits + starts[a + 1],
+                                            codeUnits + starts[b], codeUnits + starts[b + 1]);
+    });
+    std::size_t *parents = new std::size_t[total + 1];
+    int *units = new int[total + 1];
+    std::size_t *ends = new std::size_t[total + 1]; // the first pattern ending at each state
+    std::size_t *path = new std::size_t[longest + 1];
+    std::size_t stateCount = 1, previous = count;
+    path[0] = 0;
+    ends[0] = count;
+    for(std::size_t k = 0; k < count; k++) {
+        std::size_t pattern = order[k], length = this->_lengths[pattern];
+        if(length == 0) {
+            continue;
+        }
+        std::size_t shared = 0; // the states of the common prefix with the previous pattern already exist
+        if(previous != count) {
+            while(shared < length && shared < this->_lengths[previous] &&
+                  codeUnits[starts[pattern] + shared] == codeUnits[starts[previous] + shared]) {
+                shared++;
+            }
+        }
+        for(std::size_t depth = shared; depth < length; depth++) {
+            parents[stateCount] = path[depth];
+            units[stateCount] = codeUnits[starts[pattern] + depth];
+            ends[stateCount] = count;
+            path[depth + 1] = stateCount++;
+        }
+        if(ends[path[length]] == count) {
+            ends[path[length]] = pattern;
+        } else {
+            this->_nextPatterns[previous] = pattern; // equal patterns are next to each other
+        }
+        previous = pattern;
+    }
+    // the children of each state, in the order of their code units
+    std::size_t *childStarts = new std::size_t[stateCount + 1]();
+    std::size_t *children = new std::size_t[stateCount];
+    for(std::size_t s = 1; s < stateCount; s++) {
+        childStarts[parents[s] + 1]++;
+    }
+    for(std::size_t s = 0; s < stateCount; s++) {
+        childStarts[s + 1] += childStarts[s];
+    }
+    std::size_t *filled = new std::size_t[stateCount];
+    std::copy_n(childStarts, stateCount, filled);
+    for(std::size_t s = 1; s < stateCount; s++) {
+        children[filled[parents[s]]++] = s;
+    }
+    // then renumbered in breadth-first order, the children of a state get consecutive numbers,
+    // so that the edge `e` leads to the state `e + 1`
+    this->_stateCount = stateCount;
+    this->_edgeStarts = new unsigned int[stateCount + 1];
+    this->_edgeCodeUnits = new int[stateCount];
+    this->_fails = new unsigned int[stateCount];
+    this->_patterns = new std::size_t[stateCount];
+    this->_outputs = new unsigned int[stateCount];
+    unsigned int *newParents = new unsigned int[stateCount];
+    std::size_t *queue = filled; // no longer used, the old number of each new state
+    std::size_t next = 1;
+    queue[0] = 0;
+    for(std::size_t s = 0; s < stateCount; s++) {
+        std::size_t old = queue[s];
+        this->_edgeStarts[s] = (unsigned int) (next - 1);
+        this->_patterns[s] = ends[old];
+        for(std::size_t c = childStarts[old]; c < childStarts[old + 1]; c++) {
+            this->_edgeCodeUnits[next - 1] = units[children[c]];
+            newParents[next] = (unsigned int) s;
+            queue[next++] = children[c];
+        }
+    }
+    this->_edgeStarts[stateCount] = (unsigned int) (stateCount - 1);
+    for(int c = 0; c < 128; c++) {
+        this->_rootTargets[c] = 0;
+    }
+    for(unsigned int e = this->_edgeStarts[0]; e < this->_edgeStarts[1]; e++) {
+        if(0 <= this->_edgeCodeUnits[e] && this->_edgeCodeUnits[e] < 128) {
+            this->_rootTargets[this->_edgeCodeUnits[e]] = e + 1;
+        }
+    }
+    // the fails, a state is always after its fail in breadth-first order
+    this->_fails[0] = 0;
+    this->_outputs[0] = 0;
+    for(std::size_t s = 1; s < stateCount; s++) {
+        unsigned int fail = 0;
+        if(newParents[s] != 0) {
+            int codeUnit = this->_edgeCodeUnits[s - 1];
+            fail = this->advance(this->_fails[newParents[s]], codeUnit);
+        }
+        this->_fails[s] = fail;
+        this->_outputs[s] = (this->_patterns[s] != count) ? (unsigned int) s : this->_outputs[fail];
+    }
+    // the table of the ASCII transitions, the row of a state starts as the one of its fail, its entries
+    // are the offsets of the rows of the targets, and its last entry is the offset of the row of its output
+    std::fill_n(this->_asciiClasses, 128, 0);
+    this->_classCount = 1;
+    for(std::size_t e = 0; e + 1 < stateCount; e++) {
+        int codeUnit = this->_edgeCodeUnits[e];
+        if(0 <= codeUnit && codeUnit < 128 && this->_asciiClasses[codeUnit] == 0) {
+            this->_asciiClasses[codeUnit] = (Byte) this->_classCount++;
+        }
+    }
+    std::size_t width = this->_classCount + 1;
+    this->_asciiTargets = NULL;
+    if(stateCount * width <= ASCII_TARGETS_LIMIT) {
+        this->_asciiTargets = new unsigned int[stateCount * width]();
+        for(int c = 0; c < 128; c++) {
+            this->_asciiTargets[this->_asciiClasses[c]] = this->_rootTargets[c] * (unsigned int) width;
+        }
+        for(std::size_t s = 1; s < stateCount; s++) {
+            unsigned int *row = this->_asciiTargets + s * width;
+            std::copy_n(this->_asciiTargets + this->_fails[s] * width, width - 1, row);
+            for(unsigned int e = this->_edgeStarts[s]; e < this->_edgeStarts[s + 1]; e++) {
+                int codeUnit = this->_edgeCodeUnits[e];
+                if(0 <= codeUnit && codeUnit < 128) {
+                    row[this->_asciiClasses[codeUnit]] = (e + 1) * (unsigned int) width;
+                }
+            }
+            row[width - 1] = this->_outputs[s] * (unsigned int) width;
+        }
+    }
+    delete[] starts;
+    delete[] codeUnits;
+    delete[] order;
+    delete[] parents;
+    delete[] units;
+    delete[] ends;
+    delete[] path;
+    delete[] childStarts;
+    delete[] children;
+    delete[] filled;
+    delete[] newParents;
+}
+
+SuperString::PatternSet::~PatternSet() {
+    delete[] this->_lengths;
+    delete[] this->_nextPatterns;
+    delete[] this->_edgeStarts;
+    delete[] this->_edgeCodeUnits;
+    delete[] this->_fails;
+    delete[] this->_patterns;
+    delete[] this->_outputs;
+    delete[] this->_asciiTargets;
+}
+
+std::size_t SuperString::PatternSet::count() const {
+    return this->_count;
+}
+
+unsigned int SuperString::PatternSet::target(unsigned int state, int codeUnit) const {
+    if(state == 0 && 0 <= codeUnit && codeUnit < 128) {
+        return this->_rootTargets[codeUnit];
+    }
+    const int *first = this->_edgeCodeUnits + this->_edgeStarts[state];
+    const int *last = this->_edgeCodeUnits + this->_edgeStarts[state + 1];
+    if(last - first <= 8) {
+        // most states have a few edges
+        for(const int *edge = first; edge < last; edge++) {
+            if(*edge == codeUnit) {
+                return (unsigned int) (edge - this->_edgeCodeUnits) + 1;
+            }
+        }
+        return 0;
+    }
+    const int *edge = std::lower_bound(first, last, codeUnit);
+    return (edge < last && *edge == codeUnit) ? (unsigned int) (edge - this->_edgeCodeUnits) + 1 : 0;
+}
+
+unsigned int SuperString::PatternSet::advance(unsigned int state, int codeUnit) const {
+    while(true) {
+        unsigned int target = this->target(state, codeUnit);
+        if(target != 0 || state == 0) {
+            return target;
+        }
+        state = this->_fails[state];
+    }
+}
+
+bool SuperString::PatternSet::match(const SuperString &string, const SuperString::MatchCallback &callback) const {
+    if(this->_stateCount == 1) {
+        return true; // no pattern can match
+    }
+    const unsigned int *asciiTargets = this->_asciiTargets;
+    const Byte *asciiClasses = this->_asciiClasses;
+    unsigned int width = (asciiTargets != NULL) ? (unsigned int) this->_classCount + 1 : 1;
+    unsigned int state = 0; // with the table of the ASCII transitions, the offset of the row of the state
+    std::size_t index = 0; // past the last character read
+    return string.forEachChunk([&](const Chunk &chunk) -> bool {
+        const Byte *pointer = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+        Encoding encoding = chunk.encoding();
+        bool isByteEncoded = (encoding == Encoding::ASCII || encoding == Encoding::UTF8) && asciiTargets != NULL;
+        // copied while in the chunk, so that they stay in registers
+        unsigned int current = state;
+        std::size_t position = index;
+        while(pointer < end) {
+            if(isByteEncoded && *pointer < 0x80) {
+                if(current == 0) {
+                    // most of the text leaves the root where it is
+                    const Byte *first = pointer;
+                    while(pointer < end && *pointer < 0x80 && asciiTargets[asciiClasses[*pointer]] == 0) {
+                        pointer++;
+                    }
+                    position += pointer - first;
+                    if(pointer == end || *pointer >= 0x80) {
+                        continue;
+                    }
+                }
+                current = asciiTargets[current + asciiClasses[*pointer]];
+                pointer++;
+            } else {
+                int codeUnit = SuperString::Finder::decode(pointer, end, encoding);
+                if(asciiTargets != NULL && 0 <= codeUnit && codeUnit < 128) {
+                    current = asciiTargets[current + asciiClasses[codeUnit]];
+                } else {
+                    current = this->advance(current / width, codeUnit) * width;
+                }
+            }
+            position++;
+            unsigned int output = (asciiTargets != NULL) ? asciiTargets[current + width - 1]
+                                                         : this->_outputs[current];
+            if(output != 0) {
+                // the patterns ending here, from the longest
+                for(output /= width; output != 0; output = this->_outputs[this->_fails[output]]) {
+                    for(std::size_t pattern = this->_patterns[output]; pattern != this->_count;
+                        pattern = this->_nextPatterns[pattern]) {
+                        if(!callback(pattern, position - this->_lengths[pattern])) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        state = current;
+        index = position;
+        return true;
+    });
+}
+
+//*-- SuperString::Piece (internal)
+SuperString::Piece::Piece(const SuperString::StringSequence *sequence, std::size_t startIndex, std::size_t endIndex,
+                          std::size_t shift)
+        : _sequence(sequence),
+          _startIndex(startIndex),
+          _endIndex(endIndex),
+          _shift(shift),
+          _bytes(NULL),
+          _encoding(Encoding::UTF32),
+          _data(NULL),
+          _end(NULL) {
+    // nothing go here
+}
+
+SuperString::Piece::Piece(const SuperString::Byte *bytes, SuperString::Encoding encoding, std::size_t startIndex,
+                          std::size_t endIndex, const SuperString::Byte *data, const SuperString::Byte *end)
+        : _sequence(NULL),
+          _startIndex(startIndex),
+          _endIndex(endIndex),
+          _shift(0),
+          _bytes(bytes),
+          _encoding(encoding),
+          _data(data),
+          _end(end) {
+    // nothing go here
+}
+
+//*-- SuperString::Referencer (internal)
+SuperString::Referencer::Referencer()
+        : _sequence(NULL),
+          _cost(0),
+          _previous(NULL),
+          _next(NULL) {
+    // nothing go here
+}
+
+//*-- SuperString::NodePool (internal)
+void *(*SuperString::NodePool::_allocate)(std::size_t size) = std::malloc;
+
+void (*SuperString::NodePool::_deallocate)(void *pointer) = std::free;
+
+SuperString::NodePool::FreeNode *SuperString::NodePool::_shared[SuperString::NodePool::CLASSES] = {};
+
+SuperString::NodePool::Block *SuperString::NodePool::_blocks = NULL;
+
+SuperString::Atomic<std::size_t> SuperString::NodePool::_liveNodes(0);
+
+SuperString::Atomic<std::size_t> SuperString::NodePool::_peakNodes(0);
+
+SuperString::NodePool::Cache::Cache() {
+    std::fill_n(this->_lists, CLASSES, (FreeNode *) NULL);
+    std::fill_n(this->_counts, CLASSES, (std::size_t) 0);
+}
+
+SuperString::NodePool::Cache::~Cache() {
+    for(std::size_t i = 0; i < CLASSES; i++) {
+        NodePool::flush(*this, i, 0);
+    }
+}
+
+void *SuperString::NodePool::allocate(std::size_t size) {
+    std::size_t sizeClass = (size - 1) / GRANULARITY;
+    if(sizeClass >= CLASSES) {
+        void *pointer = NodePool::_allocate(size);
+        if(pointer == NULL) {
+            throw std::bad_alloc();
+        }
+        NodePool::count(true);
+        return pointer;
+    }
+    Cache &cache = NodePool::cache();
+    FreeNode *node = cache._lists[sizeClass];
+    if(node == NULL) {
+        node = NodePool::refill(sizeClass, &cache._counts[sizeClass]);
+    }
+    cache._lists[sizeClass] = node->_next;
+    cache._counts[sizeClass]--;
+    NodePool::count(true);
+    return node;
+}
+
+void SuperString::NodePool::deallocate(void *pointer, std::size_t size) {
+    NodePool::count(false);
+    std::size_t sizeClass = (size - 1) / GRANULARITY;
+    if(sizeClass >= CLASSES) {
+        NodePool::_deallocate(pointer);
+        return;
+    }
+    Cache &cache = NodePool::cache();
+    FreeNode *node = (FreeNode *) pointer;
+    node->_next = cache._lists[sizeClass];
+    cache._lists[sizeClass] = node;
+    // a thread that only frees what others allocate would otherwise keep all of it
+    if(++cache._counts[sizeClass] > CACHE_LIMIT) {
+        NodePool::flush(cache, sizeClass, CACHE_LIMIT / 2);
+    }
+}
+
+void SuperString::NodePool::reserve(std::size_t size, std::size_t count) {
+    std::size_t sizeClass = (size - 1) / GRANULARITY;
+    if(sizeClass >= CLASSES) {
+        return;
+    }
+    Cache &cache = NodePool::cache();
+    if(count <= cache._counts[sizeClass]) { // the free ones first
+        return;
+    }
+    count -= cache._counts[sizeClass];
+    std::size_t nodeSize = (sizeClass + 1) * GRANULARITY;
+    Byte *block = NodePool::allocateBlock(nodeSize, count);
+    FreeNode *list = cache._lists[sizeClass];
+    for(std::size_t i = count; i > 0; i--) { // taken in address order
+        FreeNode *node = (FreeNode *) (block + (i - 1) * nodeSize);
+        node->_next = list;
+        list = node;
+    }
+    cache._lists[sizeClass] = list;
+    cache._counts[sizeClass] += count;
+}
+
+void SuperString::NodePool::allocateMany(std::size_t size, std::size_t count, void **nodes) {
+    std::size_t sizeClass = (size - 1) / GRANULARITY;
+    if(sizeClass >= CLASSES) {
+        for(std::size_t i = 0; i < count; i++) {
+            nodes[i] = NodePool::allocate(size);
+        }
+        return;
+    }
+    // the free nodes first, then the missing ones at once
+    Cache &cache = NodePool::cache();
+    FreeNode *list = cache._lists[sizeClass];
+    std::size_t i = 0;
+    for(; i < count && list != NULL; i++) {
+        nodes[i] = list;
+        list = list->_next;
+    }
+    std::size_t taken = i;
+    if(i < count) {
+        std::size_t nodeSize = (sizeClass + 1) * GRANULARITY;
+        Byte *block = NodePool::allocateBlock(nodeSize, count - i); // the free nodes are still in the list
+        for(Byte *node = block; i < count; i++, node += nodeSize) {
+            nodes[i] = node;
+        }
+    }
+    cache._lists[sizeClass] = list;
+    cache._counts[sizeClass] -= taken;
+    NodePool::count(true, count);
+}
+
+std::size_t SuperString::NodePool::trim() {
+    Cache &cache = NodePool::cache();
+    for(std::size_t i = 0; i < CLASSES; i++) {
+        NodePool::flush(cache, i, 0);
+    }
+#ifdef SUPERSTRING_THREAD_SAFE
+    std::lock_guard<std::mutex> guard(nodePoolMutex);
+#endif
+    std::size_t count = 0;
+    for(Block *block = NodePool::_blocks; block != NULL; block = block->_next) {
+        count++;
+    }
+    if(count == 0) {
+        return 0;
+    }
+    // the blocks by address, each free node counted in the last one that starts before it
+    Block **blocks = new Block *[count];
+    count = 0;
+    for(Block *block = NodePool::_blocks; block != NULL; block = block->_next) {
+        block->_free = 0;
+        blocks[count++] = block;
+    }
+    std::sort(blocks, blocks + count);
+    for(std::size_t i = 0; i < CLASSES; i++) {
+        for(FreeNode *node = NodePool::_shared[i]; node != NULL; node = node->_next) {
+            (*(std::upper_bound(blocks, blocks + count, (Block *) node) - 1))->_free++;
+        }
+    }
+    for(std::size_t i = 0; i < CLASSES; i++) {
+        FreeNode **link = &NodePool::_shared[i];
+        while(*link != NULL) {
+            Block *block = *(std::upper_bound(blocks, blocks + count, (Block *) *link) - 1);
+            if(block->_free == block->_count) {
+                *link = (*link)->_next;
+            } else {
+                link = &(*link)->_next;
+            }
+        }
+    }
+    delete[] blocks;
+    std::size_t size = 0;
+    for(Block **link = &NodePool::_blocks; *link != NULL;) {
+        Block *block = *link;
+        if(block->_free == block->_count) {
+            *link = block->_next;
+            size += HEADER_SIZE + block->_count * block->_nodeSize;
+            NodePool::_deallocate(block);
+        } else {
+            link = &block->_next;
+        }
+    }
+    return size;
+}
+
+SuperString::NodePool::Cache &SuperString::NodePool::cache() {
+#ifdef SUPERSTRING_THREAD_SAFE
+    static thread_local Cache cache;
+#else
+    static Cache cache;
+#endif
+    return cache;
+}
+
+SuperString::NodePool::FreeNode *SuperString::NodePool::refill(std::size_t sizeClass, std::size_t *count) {
+    {
+#ifdef SUPERSTRING_THREAD_SAFE
+        std::lock_guard<std::mutex> guard(nodePoolMutex);
+#endif
+        FreeNode *list = NodePool::_shared[sizeClass];
+        if(list != NULL) { // up to half the limit, so that the next frees do not flush them back
+            FreeNode *last = list;
+            for(*count = 1; *count < CACHE_LIMIT / 2 && last->_next != NULL; (*count)++) {
+                last = last->_next;
+            }
+            NodePool::_shared[sizeClass] = last->_next;
+            last->_next = NULL;
+            return list;
+        }
+    }
+    std::size_t nodeSize = (sizeClass + 1) * GRANULARITY;
+    *count = (SLAB_SIZE - HEADER_SIZE) / nodeSize;
+    Byte *slab = NodePool::allocateBlock(nodeSize, *count);
+    FreeNode *list = NULL;
+    for(std::size_t i = *count; i > 0; i--) { // linked in address order
+        FreeNode *node = (FreeNode *) (slab + (i - 1) * nodeSize);
+        node->_next = list;
+        list = node;
+    }
+    return list;
+}
+
+SuperString::Byte *SuperString::NodePool::allocateBlock(std::size_t nodeSize, std::size_t count) {
+    Block *block = (Block *) NodePool::_allocate(HEADER_SIZE + count * nodeSize);
+    if(block == NULL) {
+        throw std::bad_alloc();
+    }
+    block->_nodeSize = nodeSize;
+    block->_count = count;
+    block->_free = 0;
+#ifdef SUPERSTRING_THREAD_SAFE
+    std::lock_guard<std::mutex> guard(nodePoolMutex);
+#endif
+    block->_next = NodePool::_blocks;
+    NodePool::_blocks = block;
+    return (Byte *) block + HEADER_SIZE;
+}
+
+void SuperString::NodePool::flush(SuperString::NodePool::Cache &cache, std::size_t sizeClass, std::size_t kept) {
+    if(cache._counts[sizeClass] <= kept) {
+        return;
+    }
+    FreeNode **link = &cache._lists[sizeClass];
+    for(std::size_t i = 0; i < kept; i++) {
+        link = &(*link)->_next;
+    }
+    FreeNode *list = *link;
+    FreeNode *last = list;
+    while(last->_next != NULL) {
+        last = last->_next;
+    }
+    *link = NULL;
+    cache._counts[sizeClass] = kept;
+#ifdef SUPERSTRING_THREAD_SAFE
+    std::lock_guard<std::mutex> guard(nodePoolMutex);
+#endif
+    last->_next = NodePool::_shared[sizeClass];
+    NodePool::_shared[sizeClass] = list;
+}
+
+void SuperString::NodePool::count(bool isAllocation, std::size_t nodes) {
+#ifdef SUPERSTRING_THREAD_SAFE
+    if(!isAllocation) {
+        NodePool::_liveNodes.fetch_sub(nodes, std::memory_order_relaxed);
+        return;
+    }
+    std::size_t live = NodePool::_liveNodes.fetch_add(nodes, std::memory_order_relaxed) + nodes;
+    std::size_t peak = NodePool::_peakNodes.load(std::memory_order_relaxed);
+    while(peak < live && !NodePool::_peakNodes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        // `peak` was reloaded
+    }
+#else
+    if(!isAllocation) {
+        NodePool::_liveNodes -= nodes;
+        return;
+    }
+    NodePool::_liveNodes += nodes;
+    if(NodePool::_peakNodes < NodePool::_liveNodes) {
+        NodePool::_peakNodes = NodePool::_liveNodes;
+    }
+#endif
+}
+
+//*-- SuperString::StringSequence (abstract|internal)
+SuperString::StringSequence::StringSequence()
+        : _refCount(0),
+          _referencers(NULL),
+          _freeingCost(0),
+          _hash(0) {
+    // nothing go here
+}
+
+SuperString::StringSequence::~StringSequence() {
+    // nothing go here
+}
+
+void *SuperString::StringSequence::operator new(std::size_t size) {
+    return NodePool::allocate(size);
+}
+
+void SuperString::StringSequence::operator delete(void *pointer, std::size_t size) {
+    NodePool::deallocate(pointer, size);
+}
+
+bool SuperString::StringSequence::isEmpty() const {
+    return this->length() == 0;
+}
+
+bool SuperString::StringSequence::isNotEmpty() const {
+    return this->length() > 0;
+}
+
+std::size_t SuperString::StringSequence::depth() const {
+    return 0;
+}
+
+bool SuperString::StringSequence::isConcatenation() const {
+    return false;
+}
+
+std::uint64_t SuperString::StringSequence::hash() const {
+    StringSequence *self = ((StringSequence *) ((std::size_t) this)); // to keep this method `const`
+    std::uint64_t hash = self->_hash;
+    if(hash == 0) {
+        hash = this->computeHash() + 1;
+        self->_hash = hash;
+    }
+    return hash - 1;
+}
+
+bool SuperString::StringSequence::isHashed() const {
+    return this->_hash != 0;
+}
+
+std::uint64_t SuperString::StringSequence::computeHash() const {
+    std::uint64_t hash = 0;
+    this->forEachChunk([&](const Chunk &chunk) -> bool {
+        hash = SuperString::Hash::update(hash, chunk);
+        return true;
+    }, 0, this->length());
+    return hash;
+}
+
+SuperString::Result<std::size_t, SuperString::Error> SuperString::StringSequence::indexOf(SuperString other) const {
+    Finder finder(other);
+    return finder.find(this, 0, this->length(), false);
+}
+
+SuperString::Result<std::size_t, SuperString::Error> SuperString::StringSequence::lastIndexOf(SuperString other) const {
+    Finder finder(other);
+    std::size_t length = this->length();
+    if(length < finder.length()) {
+        return Result<std::size_t, Error>(Error::NotFound);
+    }
+    // windows of starting positions, growing from the end, so that the search stops near the last occurrence
+    std::size_t endIndex = length - finder.length() + 1; // past the last starting position
+    std::size_t window = 1 << 16;
+    while(true) {
+        std::size_t startIndex = (endIndex < window) ? 0 : endIndex - window;
+        Result<std::size_t, Error> result = finder.find(this, startIndex, endIndex - 1 + finder.length(), true);
+        if(result.isOk() || startIndex == 0) {
+            return result;
+        }
+        endIndex = startIndex;
+        window *= 2;
+    }
+}
+
+void SuperString::StringSequence::refAdd() const {
+    StringSequence *self = (StringSequence *) (unsigned long) this;
+    self->_refCount++;
+}
+
+std::size_t SuperString::StringSequence::refRelease() const {
+    StringSequence *self = (StringSequence *) (unsigned long) this;
+    if(self->_refCount == 0) {
+        return 0;
+    }
+    return --self->_refCount;
+}
+
+std::size_t SuperString::StringSequence::refCount() const {
+    return this->_refCount;
+}
+
+void SuperString::StringSequence::release() const {
+#ifdef SUPERSTRING_THREAD_SAFE
+    // only the last reference is released under the lock, so that the sequence can't be deleted twice
+    StringSequence *self = (StringSequence *) (unsigned long) this;
+    std::size_t count = self->_refCount;
+    while(count > 1) {
+        if(self->_refCount.compare_exchange_weak(count, count - 1)) {
+            return;
+        }
+    }
+    std::lock_guard<std::recursive_mutex> guard(sequencesMutex);
+#endif
+    if(this->refRelease() == 0) {
+        this->collect();
+    }
+}
+
+void SuperString::StringSequence::collect() const {
+#ifdef SUPERSTRING_THREAD_SAFE
+    std::lock_guard<std::recursive_mutex> guard(sequencesMutex);
+    // referencers may be read by other threads, so they are never reconstructed
+    bool isCollectable = this->freeingCost() == 0;
+#else
+    bool isCollectable = this->freeingCost() < this->keepingCost();
+#endif
+    if(this->refCount() == 0 && isCollectable) {
+        this->doDelete();
+    }
+}
+
+void SuperString::StringSequence::markToBeDeleted() const {
+    StringSequence *self = (StringSequence *) (unsigned long) this;
+    self->_refCount = (std::size_t) -1; // nothing holds a sequence that is being deleted
+}
+
+bool SuperString::StringSequence::isMarkedToBeDeleted() const {
+    return this->_refCount == (std::size_t) -1;
+}
+
+void SuperString::StringSequence::addReferencer(SuperString::Referencer *referencer) const {
+#ifdef SUPERSTRING_THREAD_SAFE
+    std::lock_guard<std::recursive_mutex> guard(sequencesMutex);
+#endif
+    StringSequence *self = (StringSequence *) (unsigned long) this;
+    referencer->_cost = referencer->_sequence->reconstructionCost(this);
+    referencer->_previous = NULL;
+    referencer->_next = self->_referencers;
+    if(self->_referencers != NULL) {
+        self->_referencers->_previous = referencer;
+    }
+    self->_referencers = referencer;
+    self->_freeingCost += referencer->_cost;
+}
+
+void SuperString::StringSequence::removeReferencer(SuperString::Referencer *referencer) const {
+#ifdef SUPERSTRING_THREAD_SAFE
+    std::lock_guard<std::recursive_mutex> guard(sequencesMutex);
+#endif
+    StringSequence *self = (StringSequence *) (unsigned long) this;
+    if(referencer->_previous == NULL) {
+        self->_referencers = referencer->_next;
+    } else {
+        referencer->_previous->_next = referencer->_next;
+    }
+    if(referencer->_next != NULL) {
+        referencer->_next->_previous = referencer->_previous;
+    }
+    referencer->_previous = NULL;
+    referencer->_next = NULL;
+    self->_freeingCost -= referencer->_cost;
+}
+
+void SuperString::StringSequence::addReferencers(SuperString::Referencer *first, SuperString::Referencer *last,
+                                                 std::size_t cost) const {
+    if(first == NULL) {
+        return;
+    }
+#ifdef SUPERSTRING_THREAD_SAFE
+    std::lock_guard<std::recursive_mutex> guard(sequencesMutex);
+#endif
+    StringSequence *self = (StringSequence *) (unsigned long) this;
+    first->_previous = NULL;
+    last->_next = self->_referencers;
+    if(self->_referencers != NULL) {
+        self->_referencers->_previous = last;
+    }
+    self->_referencers = first;
+    self->_freeingCost += cost;
+}
+
+std::size_t SuperString::StringSequence::freeingCost() const {
+    return this->_freeingCost;
+}
+
+void SuperString::StringSequence::reconstructReferencers() {
+    // reconstructing a referencer removes its link from the list
+    while(this->_referencers != NULL) {
+        this->_referencers->_sequence->reconstruct(this);
+    }
+}
+
+
+//*-- SuperString::ReferenceStringSequence (abstract|internal)
+SuperString::ReferenceStringSequence::~ReferenceStringSequence() {
+    // nothing go here
+}
+
+std::size_t SuperString::ReferenceStringSequence::length() const {
+    return this->_summary._length;
+}
+
+std::size_t SuperString::ReferenceStringSequence::memoryLength() const {
+    return this->_summary._memoryLength;
+}
+
+std::size_t SuperString::ReferenceStringSequence::depth() const {
+    return this->_summary._depth;
+}
+
+void SuperString::ReferenceStringSequence::refreshSummary() const {
+    ReferenceStringSequence *self = ((ReferenceStringSequence *) ((std::size_t) this)); // to keep this method `const`
+    Summary summary = self->summarize();
+    if(summary._memoryLength != self->_summary._memoryLength || summary._depth != self->_summary._depth) {
+        self->_summary = summary;
+        for(Referencer *referencer = self->_referencers; referencer != NULL; referencer = referencer->_next) {
+            // reconstruction costs depend on the memory length
+            self->_freeingCost -= referencer->_cost;
+            referencer->_cost = referencer->_sequence->reconstructionCost(self);
+            self->_freeingCost += referencer->_cost;
+            referencer->_sequence->refreshSummary();
+        }
+    }
+}
+
+const SuperString::StringSequence *
+SuperString::ReferenceStringSequence::compact(const StringSequence *sequence, std::size_t startIndex,
+                                              std::size_t endIndex) {
+    std::size_t length = endIndex - startIndex;
+    std::size_t memoryLength = 0;
+    bool isASCII = true, isUTF8 = true, isUTF16BE = true, isUTF32 = true, isUTF16LE = true;
+    sequence->forEachChunk([&](const Chunk &chunk) -> bool {
+        memoryLength += chunk.memoryLength();
+        isASCII &= chunk.encoding() == Encoding::ASCII;
+        isUTF8 &= chunk.encoding() == Encoding::ASCII || chunk.encoding() == Encoding::UTF8;
+        isUTF16BE &= chunk.encoding() == Encoding::UTF16BE;
+        isUTF32 &= chunk.encoding() == Encoding::UTF32;
+        isUTF16LE &= chunk.encoding() == Encoding::UTF16LE;
+        return true;
+    }, startIndex, endIndex);
+    if(isASCII || isUTF8 || isUTF16BE || isUTF32 || isUTF16LE) {
+        // a single encoding, chunks are copied as they are
+        std::size_t terminatorLength = (isUTF16BE || isUTF16LE) ? 2 : (isUTF32 ? sizeof(int) : 1);
+        Byte *data = isUTF32 ? (Byte *) new int[length + 1] : new Byte[memoryLength + terminatorLength];
+        std::size_t offset = 0;
+        sequence->forEachChunk([&](const Chunk &chunk) -> bool {
+            std::memcpy(data + offset, chunk.bytes(), chunk.memoryLength());
+            offset += chunk.memoryLength();
+            return true;
+        }, startIndex, endIndex);
+        std::memset(data + offset, 0, terminatorLength);
+        if(isASCII) {
+            return new CopyASCIISequence(data, length);
+        } else if(isUTF8) {
+            return new CopyUTF8Sequence(data, length, memoryLength + terminatorLength, false);
+        } else if(isUTF16BE) {
+            return new CopyUTF16BESequence(data, length, memoryLength + terminatorLength);
+        } else if(isUTF16LE) {
+            return new CopyUTF16LESequence(data, length, memoryLength + terminatorLength);
+        }
+        return new CopyUTF32Sequence((int *) data, length);
+    }
+    return ReferenceStringSequence::compactUTF8(sequence, startIndex, endIndex);
+}
+
+const SuperString::StringSequence *
+SuperString::ReferenceStringSequence::compactUTF8(const StringSequence *sequence, std::size_t startIndex,
+                                                  std::size_t endIndex) {
+    // everything is transcoded to UTF-8, [data] is NULL while counting
+    std::size_t length = endIndex - startIndex;
+    Byte *data = NULL;
+    std::size_t offset = 0;
+    ChunkCallback transcode = [&](const Chunk &chunk) -> bool {
+        Byte buffer[4];
+        if(chunk.encoding() == Encoding::ASCII || chunk.encoding() == Encoding::UTF8) {
+            if(data != NULL) {
+                std::memcpy(data + offset, chunk.bytes(), chunk.memoryLength());
+            }
+            offset += chunk.memoryLength();
+        } else if(chunk.encoding() == Encoding::UTF16BE || chunk.encoding() == Encoding::UTF16LE) {
+            const Byte *pointer = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+            while(pointer < end) {
+                int codeUnit = (chunk.encoding() == Encoding::UTF16BE) ? SuperString::UTF16BE::decode(pointer)
+                                                                       : SuperString::UTF16LE::decode(pointer);
+                pointer += (codeUnit >= 0x10000) ? 4 : 2;
+                offset += SuperString::UTF8::encode(codeUnit, data != NULL ? data + offset : buffer);
+            }
+        } else {
+            const int *codeUnits = (const int *) chunk.bytes();
+            for(std::size_t i = 0; i < chunk.length(); i++) {
+                offset += SuperString::UTF8::encode(codeUnits[i], data != NULL ? data + offset : buffer);
+            }
+        }
+        return true;
+    };
+    sequence->forEachChunk(transcode, startIndex, endIndex);
+    data = new Byte[offset + 1];
+    offset = 0;
+    sequence->forEachChunk(transcode, startIndex, endIndex);
+    data[offset] = 0x00;
+    return new CopyUTF8Sequence(data, length, offset + 1, false);
+}
+
+const SuperString::StringSequence *
+SuperString::ReferenceStringSequence::materialize(const StringSequence *sequence, bool isUTF8) {
+    std::size_t length = sequence->length();
+    // bytes taken by each code unit in the narrowest encoding: 1 for ASCII, 2 for UTF-16BE without
+    // surrogate pairs, and 4 for UTF-32, needed by supplementary characters and unpaired surrogates
+    std::size_t size = 1;
+    sequence->forEachChunk([&](const Chunk &chunk) -> bool {
+        if(chunk.encoding() == Encoding::ASCII ||
+           (chunk.encoding() == Encoding::UTF8 && chunk.memoryLength() == chunk.length())) {
+            return true;
+        }
+        const Byte *pointer = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+        while(pointer < end && size < sizeof(int)) {
+            int codeUnit = SuperString::Finder::decode(pointer, end, chunk.encoding());
+            if(codeUnit < 0 || 0xffff < codeUnit || (codeUnit & 0xf800) == 0xd800) {
+                size = sizeof(int);
+            } else if(0x7f < codeUnit) {
+                size = 2;
+            }
+        }
+        return size < sizeof(int);
+    }, 0, length);
+    if(isUTF8 && size > 1) {
+        return ReferenceStringSequence::compactUTF8(sequence, 0, length);
+    }
+    Encoding encoding = (size == 1) ? Encoding::ASCII : (size == 2) ? Encoding::UTF16BE : Encoding::UTF32;
+    // the terminator takes the place of one more code unit, UTF-32 data is allocated as `int`s to be aligned
+    Byte *data = (size == sizeof(int)) ? (Byte *) new int[length + 1] : new Byte[(length + 1) * size];
+    std::size_t offset = 0;
+    sequence->forEachChunk([&](const Chunk &chunk) -> bool {
+        // ASCII is kept in UTF-8 chunks only if the whole text is ASCII
+        if(chunk.encoding() == encoding || (size == 1 && chunk.encoding() == Encoding::UTF8)) {
+            std::memcpy(data + offset, chunk.bytes(), chunk.memoryLength());
+            offset += chunk.memoryLength();
+            return true;
+        }
+        const Byte *pointer = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+        while(pointer < end) {
+            int codeUnit = SuperString::Finder::decode(pointer, end, chunk.encoding());
+            if(size == 1) {
+                data[offset] = (Byte) codeUnit;
+            } else if(size == 2) {
+                data[offset] = (Byte) (codeUnit >> 8);
+                data[offset + 1] = (Byte) codeUnit;
+            } else {
+                ((int *) data)[offset / sizeof(int)] = codeUnit;
+            }
+            offset += size;
+        }
+        return true;
+    }, 0, length);
+    std::memset(data + offset, 0, size);
+    if(encoding == Encoding::ASCII) {
+        return new CopyASCIISequence(data, length);
+    } else if(encoding == Encoding::UTF16BE) {
+        return new CopyUTF16BESequence(data, length, offset + 2);
+    }
+    return new CopyUTF32Sequence((int *) data, length);
+}
+
+std::size_t SuperString::ReferenceStringSequence::compactionCost(const StringSequence *sequence, std::size_t startIndex,
+                                                                 std::size_t endIndex) {
+    std::size_t sequenceLength = sequence->length();
+    if(sequenceLength == 0) {
+        return sizeof(CopyUTF8Sequence);
+    }
+    // the memory of the range, supposing it is spread evenly over the sequence
+    return sizeof(CopyUTF8Sequence) +
+           ((endIndex - startIndex) * sequence->memoryLength() + sequenceLength - 1) / sequenceLength + 1;
+}
+
+//*-- SuperString::ConstASCIISequence (internal)
+SuperString::ConstASCIISequence::ConstASCIISequence(const Byte *bytes)
+        : _bytes(bytes),
+          _status(SuperString::ConstASCIISequence::Status::LengthNotComputed) {
+    // nothing go here
+}
+
+SuperString::ConstASCIISequence::ConstASCIISequence(const Byte *bytes, std::size_t memoryLength)
+        : _bytes(bytes),
+          _length(memoryLength),
+          _status(SuperString::ConstASCIISequence::Status::LengthComputed) {
+    // nothing go here
+}
+
+SuperString::ConstASCIISequence::~ConstASCIISequence() {
+    this->reconstructReferencers();
+}
+
+std::size_t SuperString::ConstASCIISequence::length() const /*override*/ {
+    if(this->_status == Status::LengthNotComputed) {
+        ConstASCIISequence *self = ((ConstASCIISequence *) ((std::size_t) this)); // to keep this method `const`
+        self->_length = SuperString::ASCII::length(this->_bytes);
+        self->_status = Status::LengthComputed; // once the length is set, it may be read from then on
+    }
+    return this->_length;
+}
+
+std::size_t SuperString::ConstASCIISequence::memoryLength() const {
+    return this->length();
+}
+
+SuperString::Result<int, SuperString::Error>
+SuperString::ConstASCIISequence::codeUnitAt(std::size_t index) const {
+    if(index < this->length()) {
+        return Result<int, SuperString::Error>(SuperString::ASCII::codeUnitAt(this->_bytes, index));
+    }
+    return Result<int, SuperString::Error>(Error::RangeError);
+}
+
+SuperString::Piece SuperString::ConstASCIISequence::pieceAt(std::size_t index) const {
+    return Piece(this->_bytes + index, Encoding::ASCII, 0, this->length());
+}
+
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::ConstASCIISequence::substring(std::size_t startIndex,
+                                           std::size_t endIndex) const {
+    // TODO: General code, specify + repeated * times
+    if(this->length() < startIndex || this->length() < endIndex) {
+        return Result<SuperString, Error>(Error::RangeError);
+    }
+    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
+    return Result<SuperString, Error>(SuperString(sequence));
+}
+
+bool SuperString::ConstASCIISequence::print(std::ostream &stream) const {
+    SuperString::ASCII::print(stream, this->_bytes, 0, this->length());
+    return true;
+}
+
+bool SuperString::ConstASCIISequence::print(std::ostream &stream, std::size_t startIndex,
+                                                         std::size_t endIndex) const {
+    if(this->length() < startIndex || this->length() < endIndex) {
+        return false;
+    }
+    SuperString::ASCII::print(stream, this->_bytes, startIndex, endIndex);
+    return true;
+}
+
+bool SuperString::ConstASCIISequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                   std::size_t endIndex) const {
+    if(startIndex < endIndex) {
+        return callback(Chunk(this->_bytes + startIndex, endIndex - startIndex, Encoding::ASCII, endIndex - startIndex));
+    }
+    return true;
+}
+
+SuperString SuperString::ConstASCIISequence::trim() const {
+    Pair<std::size_t, std::size_t> indexes = SuperString::ASCII::trim(this->_bytes, this->length());
+    return this->substring(indexes.first(), indexes.second()).ok();
+}
+
+SuperString SuperString::ConstASCIISequence::trimLeft() const {
+    return this->substring(SuperString::ASCII::trimLeft(this->_bytes, this->length()), this->length()).ok();
+}
+
+SuperString SuperString::ConstASCIISequence::trimRight() const {
     return this->substring(0, SuperString::ASCII::trimRight(this->_bytes, this->length())).ok();
 }
 
-std::size_t SuperString::ConstASCIISequence::keepingCost() const {
-    return sizeof(ConstASCIISequence);
+std::size_t SuperString::ConstASCIISequence::keepingCost() const {
+    return sizeof(ConstASCIISequence);
+}
+
+void SuperString::ConstASCIISequence::doDelete() const {
+    ConstASCIISequence *self = ((ConstASCIISequence *) (std::size_t) this);
+    if(!self->isToBeDeleted()) {
+        self->_status = Status::ToBeDestructed; // Just a trick, we don't want any more variable
+        delete self;
+    }
+}
+
+bool SuperString::ConstASCIISequence::isToBeDeleted() const {
+    return this->_status == Status::ToBeDestructed;
+}
+
+//*-- SuperString::CopyASCIISequence (internal)
+SuperString::CopyASCIISequence::CopyASCIISequence(const SuperString::Byte *bytes) {
+    this->_length = SuperString::ASCII::length(bytes);
+    this->_data = new Byte[this->_length + 1];
+    std::copy_n(bytes, this->_length + 1, this->_data);
+}
+
+SuperString::CopyASCIISequence::CopyASCIISequence(const SuperString::ConstASCIISequence *sequence) {
+    this->_length = sequence->length();
+    this->_data = new Byte[this->_length + 1];
+    std::copy_n(sequence->_bytes, this->_length, this->_data);
+    this->_data[this->_length] = 0x00;
+}
+
+SuperString::CopyASCIISequence::CopyASCIISequence(SuperString::Byte *data, std::size_t length)
+        : _data(data),
+          _length(length) {
+    // nothing go here
+}
+
+SuperString::CopyASCIISequence::~CopyASCIISequence() {
+    this->reconstructReferencers();
+    delete[] this->_data;
+}
+
+std::size_t SuperString::CopyASCIISequence::length() const {
+    return this->_length;
+}
+
+std::size_t SuperString::CopyASCIISequence::memoryLength() const {
+    return this->_length;
+}
+
+SuperString::Result<int, SuperString::Error> SuperString::CopyASCIISequence::codeUnitAt(
+        std::size_t index) const {
+    if(index < this->length()) {
+        return Result<int, SuperString::Error>(SuperString::ASCII::codeUnitAt(this->_data, index));
+    }
+    return Result<int, SuperString::Error>(Error::RangeError);
+}
+
+SuperString::Piece SuperString::CopyASCIISequence::pieceAt(std::size_t index) const {
+    return Piece(this->_data + index, Encoding::ASCII, 0, this->_length);
+}
+
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::CopyASCIISequence::substring(std::size_t startIndex,
+                                          std::size_t endIndex) const {
+    // TODO: General code, specify + repeated * times
+    if(this->length() < startIndex || this->length() < endIndex) {
+        return Result<SuperString, Error>(Error::RangeError);
+    }
+    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
+    return Result<SuperString, Error>(SuperString(sequence));
+}
+
+bool SuperString::CopyASCIISequence::print(std::ostream &stream) const {
+    SuperString::ASCII::print(stream, this->_data, 0, this->_length);
+    return true;
+}
+
+bool SuperString::CopyASCIISequence::print(std::ostream &stream, std::size_t startIndex,
+                                                        std::size_t endIndex) const {
+    if(this->length() < startIndex || this->length() < endIndex) {
+        return false;
+    }
+    SuperString::ASCII::print(stream, this->_data, startIndex, endIndex);
+    return true;
+}
+
+bool SuperString::CopyASCIISequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                  std::size_t endIndex) const {
+    if(startIndex < endIndex) {
+        return callback(Chunk(this->_data + startIndex, endIndex - startIndex, Encoding::ASCII, endIndex - startIndex));
+    }
+    return true;
+}
+
+SuperString SuperString::CopyASCIISequence::trim() const {
+    Pair<std::size_t, std::size_t> indexes = SuperString::ASCII::trim(this->_data, this->_length);
+    return this->substring(indexes.first(), indexes.second()).ok();
+}
+
+SuperString SuperString::CopyASCIISequence::trimLeft() const {
+    return this->substring(SuperString::ASCII::trimLeft(this->_data, this->_length), this->length()).ok();
+}
+
+SuperString SuperString::CopyASCIISequence::trimRight() const {
+    return this->substring(0, SuperString::ASCII::trimRight(this->_data, this->length())).ok();
+}
+
+std::size_t SuperString::CopyASCIISequence::keepingCost() const {
+    std::size_t cost = sizeof(CopyASCIISequence);
+    if(this->_data != NULL) {
+        cost += this->length() + 1;
+    }
+    return cost;
+}
+
+void SuperString::CopyASCIISequence::doDelete() const {
+    CopyASCIISequence *self = ((CopyASCIISequence *) (std::size_t) this);
+    if(!self->isToBeDeleted()) {
+        self->markToBeDeleted();
+        delete self;
+    }
+}
+
+bool SuperString::CopyASCIISequence::isToBeDeleted() const {
+    return this->isMarkedToBeDeleted();
+}
+
+//*-- SuperString::ConstUTF8Sequence (internal)
+SuperString::ConstUTF8Sequence::ConstUTF8Sequence(const Byte *bytes)
+        : _bytes(bytes),
+          _status(SuperString::ConstUTF8Sequence::Status::LengthNotComputed),
+          _isValid(false) {
+    // nothing go here
+}
+
+SuperString::ConstUTF8Sequence::ConstUTF8Sequence(const Byte *bytes, std::size_t length, std::size_t memoryLength)
+        : _bytes(bytes),
+          _length(length),
+          _memoryLength(memoryLength),
+          _status(SuperString::ConstUTF8Sequence::Status::LengthComputed),
+          _isValid(true) {
+    // nothing go here
+}
+
+SuperString::ConstUTF8Sequence::ConstUTF8Sequence(const Byte *bytes, std::size_t memoryLength)
+        : _bytes(bytes),
+          _memoryLength(memoryLength + 1),
+          _status(SuperString::ConstUTF8Sequence::Status::MemoryLengthComputed),
+          _isValid(false) {
+    // nothing go here
+}
+
+SuperString::ConstUTF8Sequence::~ConstUTF8Sequence() {
+    this->reconstructReferencers();
+}
+
+std::size_t SuperString::ConstUTF8Sequence::length() const /*override*/ {
+    Status status = this->_status;
+    if(status == Status::LengthNotComputed) {
+        ConstUTF8Sequence *self = ((ConstUTF8Sequence *) ((std::size_t) this)); // to keep this method `const`
+        Pair<std::size_t, std::size_t> lengthAndMemoryLength = SuperString::UTF8::lengthAndMemoryLength(this->_bytes);
+        self->_length = lengthAndMemoryLength.first();
+        self->_memoryLength = lengthAndMemoryLength.second();
+        self->_status = Status::LengthComputed; // once the lengths are set, they may be read from then on
+    } else if(status == Status::MemoryLengthComputed) {
+        ConstUTF8Sequence *self = ((ConstUTF8Sequence *) ((std::size_t) this));
+        self->_length = SuperString::UTF8::length(this->_bytes, this->_memoryLength - 1);
+        self->_status = Status::LengthComputed;
+    }
+    return this->_length;
+}
+
+std::size_t SuperString::ConstUTF8Sequence::memoryLength() const {
+    if(this->_status == Status::LengthNotComputed) {
+        this->length();
+    }
+    return (this->_memoryLength > 0) ? this->_memoryLength - 1 : 0; // without the terminator
+}
+
+SuperString::Result<int, SuperString::Error> SuperString::ConstUTF8Sequence::codeUnitAt(std::size_t index) const {
+    std::size_t length = this->length();
+    if(index < length) {
+        const Byte *bytes = this->_bytes + this->_index.offset(this->_bytes, length, index);
+        if(this->_isValid) {
+            return Result<int, SuperString::Error>(SuperString::UTF8::decode(bytes));
+        }
+        return SuperString::UTF8::decode(bytes, this->_bytes + this->memoryLength());
+    }
+    return Result<int, SuperString::Error>(Error::RangeError);
+}
+
+SuperString::Piece SuperString::ConstUTF8Sequence::pieceAt(std::size_t index) const {
+    std::size_t length = this->length();
+    const Byte *bytes = this->_bytes + this->_index.offset(this->_bytes, length, index);
+    if(this->_isValid) {
+        return Piece(bytes, Encoding::UTF8, 0, length);
+    }
+    return Piece(bytes, Encoding::UTF8, 0, length, this->_bytes, this->_bytes + this->memoryLength());
+}
+
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::ConstUTF8Sequence::substring(std::size_t startIndex,
+                                          std::size_t endIndex) const {
+    // TODO: General code, specify + repeated * times
+    std::size_t length = this->length();
+    if(length < startIndex || length < endIndex) {
+        return Result<SuperString, Error>(Error::RangeError);
+    }
+    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
+    return Result<SuperString, Error>(SuperString(sequence));
+}
+
+bool SuperString::ConstUTF8Sequence::print(std::ostream &stream) const {
+    stream.write((const char *) this->_bytes, this->memoryLength());
+    return true;
+}
+
+bool SuperString::ConstUTF8Sequence::print(std::ostream &stream, std::size_t startIndex,
+                                                        std::size_t endIndex) const {
+    std::size_t length = this->length();
+    if(length < startIndex || length < endIndex) {
+        return false;
+    }
+    if(startIndex < endIndex) {
+        std::size_t startOffset = this->_index.offset(this->_bytes, length, startIndex);
+        std::size_t endOffset = this->_index.offset(this->_bytes, length, endIndex);
+        stream.write((const char *) (this->_bytes + startOffset), endOffset - startOffset);
+    }
+    return true;
+}
+
+bool SuperString::ConstUTF8Sequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                  std::size_t endIndex) const {
+    if(startIndex < endIndex) {
+        std::size_t length = this->length();
+        // the bounds of the whole leaf are known without building the index
+        std::size_t startOffset = (startIndex == 0) ? 0 : this->_index.offset(this->_bytes, length, startIndex);
+        std::size_t endOffset = (endIndex == length) ? this->memoryLength()
+                                                     : this->_index.offset(this->_bytes, length, endIndex);
+        return callback(Chunk(this->_bytes + startOffset, endOffset - startOffset, Encoding::UTF8,
+                              endIndex - startIndex));
+    }
+    return true;
+}
+
+SuperString SuperString::ConstUTF8Sequence::trim() const {
+    // TODO: General code, specify
+    std::size_t startIndex = 0;
+    std::size_t endIndex = this->length();
+    Result<int, Error> result = this->codeUnitAt(startIndex);
+    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+        result = this->codeUnitAt(++startIndex);
+    }
+    result = this->codeUnitAt(endIndex - 1);
+    while(endIndex > startIndex && result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+        result = this->codeUnitAt(--endIndex - 1);
+    }
+    return this->substring(startIndex, endIndex).ok();
+}
+
+SuperString SuperString::ConstUTF8Sequence::trimLeft() const {
+    // TODO: General code, specify
+    std::size_t startIndex = 0;
+    Result<int, Error> result = this->codeUnitAt(startIndex);
+    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+        result = this->codeUnitAt(++startIndex);
+    }
+    return this->substring(startIndex, this->length()).ok();
+}
+
+SuperString SuperString::ConstUTF8Sequence::trimRight() const {
+    // TODO: General code, specify
+    std::size_t endIndex = this->length();
+    Result<int, Error> result = this->codeUnitAt(endIndex - 1);
+    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+        result = this->codeUnitAt(--endIndex - 1);
+    }
+    return this->substring(0, endIndex).ok();
+}
+
+std::size_t SuperString::ConstUTF8Sequence::keepingCost() const {
+    return sizeof(ConstUTF8Sequence) + this->_index.memoryLength(this->_length);
+}
+
+void SuperString::ConstUTF8Sequence::doDelete() const {
+    ConstUTF8Sequence *self = ((ConstUTF8Sequence *) (std::size_t) this);
+    if(!self->isToBeDeleted()) {
+        self->_status = Status::ToBeDestructed; // Just a trick, we don't want any more variable
+        delete self;
+    }
+}
+
+bool SuperString::ConstUTF8Sequence::isToBeDeleted() const {
+    return this->_status == Status::ToBeDestructed;
+}
+
+//*-- SuperString::CopyUTF8Sequence (internal)
+SuperString::CopyUTF8Sequence::CopyUTF8Sequence(const SuperString::Byte *bytes)
+        : _isValid(false) {
+    Pair<std::size_t, std::size_t> lengthAndMemoryLength = SuperString::UTF8::lengthAndMemoryLength(bytes);
+    this->_length = lengthAndMemoryLength.first();
+    this->_memoryLength = lengthAndMemoryLength.second();
+    this->_data = new Byte[this->_memoryLength];
+    std::copy_n(bytes, this->_memoryLength, this->_data);
+}
+
+SuperString::CopyUTF8Sequence::CopyUTF8Sequence(const SuperString::ConstUTF8Sequence *sequence)
+        : _isValid(sequence->_isValid) {
+    this->_length = sequence->length();
+    this->_memoryLength = sequence->memoryLength() + 1;
+    this->_data = new Byte[this->_memoryLength];
+    std::copy_n(sequence->_bytes, this->_memoryLength - 1, this->_data);
+    this->_data[this->_memoryLength - 1] = 0x00;
+}
+
+SuperString::CopyUTF8Sequence::CopyUTF8Sequence(SuperString::Byte *data, std::size_t length,
+                                                 std::size_t memoryLength, bool isValid)
+        : _data(data),
+          _length(length),
+          _memoryLength(memoryLength),
+          _isValid(isValid) {
+    // nothing go here
+}
+
+SuperString::CopyUTF8Sequence::~CopyUTF8Sequence() {
+    this->reconstructReferencers();
+    delete[] this->_data;
+}
+
+std::size_t SuperString::CopyUTF8Sequence::length() const {
+    return this->_length;
+}
+
+std::size_t SuperString::CopyUTF8Sequence::memoryLength() const {
+    return (this->_memoryLength > 0) ? this->_memoryLength - 1 : 0; // without the terminator
+}
+
+SuperString::Result<int, SuperString::Error> SuperString::CopyUTF8Sequence::codeUnitAt(std::size_t index) const {
+    if(index < this->length()) {
+        const Byte *bytes = this->_data + this->_index.offset(this->_data, this->_length, index);
+        if(this->_isValid) {
+            return Result<int, SuperString::Error>(SuperString::UTF8::decode(bytes));
+        }
+        return SuperString::UTF8::decode(bytes, this->_data + this->memoryLength());
+    }
+    return Result<int, SuperString::Error>(Error::RangeError);
+}
+
+SuperString::Piece SuperString::CopyUTF8Sequence::pieceAt(std::size_t index) const {
+    const Byte *bytes = this->_data + this->_index.offset(this->_data, this->_length, index);
+    if(this->_isValid) {
+        return Piece(bytes, Encoding::UTF8, 0, this->_length);
+    }
+    return Piece(bytes, Encoding::UTF8, 0, this->_length, this->_data, this->_data + this->memoryLength());
+}
+
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::CopyUTF8Sequence::substring(std::size_t startIndex, std::size_t endIndex) const {
+    // TODO: General code, specify + repeated * times
+    if(this->length() < startIndex || this->length() < endIndex) {
+        return Result<SuperString, Error>(Error::RangeError);
+    }
+    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
+    return Result<SuperString, Error>(SuperString(sequence));
+}
+
+bool SuperString::CopyUTF8Sequence::print(std::ostream &stream) const {
+    stream.write((const char *) this->_data, this->memoryLength());
+    return true;
+}
+
+bool SuperString::CopyUTF8Sequence::print(std::ostream &stream, std::size_t startIndex,
+                                                       std::size_t endIndex) const {
+    std::size_t length = this->length();
+    if(length < startIndex || length < endIndex) {
+        return false;
+    }
+    if(startIndex < endIndex) {
+        std::size_t startOffset = this->_index.offset(this->_data, length, startIndex);
+        std::size_t endOffset = this->_index.offset(this->_data, length, endIndex);
+        stream.write((const char *) (this->_data + startOffset), endOffset - startOffset);
+    }
+    return true;
+}
+
+bool SuperString::CopyUTF8Sequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                 std::size_t endIndex) const {
+    if(startIndex < endIndex) {
+        // the bounds of the whole leaf are known without building the index
+        std::size_t startOffset = (startIndex == 0) ? 0 : this->_index.offset(this->_data, this->_length, startIndex);
+        std::size_t endOffset = (endIndex == this->_length) ? this->memoryLength()
+                                                            : this->_index.offset(this->_data, this->_length, endIndex);
+        return callback(Chunk(this->_data + startOffset, endOffset - startOffset, Encoding::UTF8,
+                              endIndex - startIndex));
+    }
+    return true;
+}
+
+SuperString SuperString::CopyUTF8Sequence::trim() const {
+    // TODO: General code, specify
+    std::size_t startIndex = 0;
+    std::size_t endIndex = this->length();
+    Result<int, Error> result = this->codeUnitAt(startIndex);
+    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+        result = this->codeUnitAt(++startIndex);
+    }
+    result = this->codeUnitAt(endIndex - 1);
+    while(endIndex > startIndex && result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+        result = this->codeUnitAt(--endIndex - 1);
+    }
+    return this->substring(startIndex, endIndex).ok();
+}
+
+SuperString SuperString::CopyUTF8Sequence::trimLeft() const {
+    // TODO: General code, specify
+    std::size_t startIndex = 0;
+    Result<int, Error> result = this->codeUnitAt(startIndex);
+    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+        result = this->codeUnitAt(++startIndex);
+    }
+    return this->substring(startIndex, this->length()).ok();
+}
+
+SuperString SuperString::CopyUTF8Sequence::trimRight() const {
+    // TODO: General code, specify
+    std::size_t endIndex = this->length();
+    Result<int, Error> result = this->codeUnitAt(endIndex - 1);
+    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+        result = this->codeUnitAt(--endIndex - 1);
+    }
+    return this->substring(0, endIndex).ok();
+}
+
+std::size_t SuperString::CopyUTF8Sequence::keepingCost() const {
+    std::size_t cost = sizeof(CopyUTF8Sequence) + this->_memoryLength + this->_index.memoryLength(this->_length);
+    return cost;
+}
+
+void SuperString::CopyUTF8Sequence::doDelete() const {
+    CopyUTF8Sequence *self = ((CopyUTF8Sequence *) (std::size_t) this);
+    if(!self->isToBeDeleted()) {
+        self->markToBeDeleted();
+        delete self;
+    }
 }
 
-void SuperString::ConstASCIISequence::doDelete() const {
-    ConstASCIISequence *self = ((ConstASCIISequence *) (std::size_t) this);
+bool SuperString::CopyUTF8Sequence::isToBeDeleted() const {
+    return this->isMarkedToBeDeleted();
+}
+
+//*-- SuperString::ConstUTF16Sequence<Codec> (internal)
+template<class Codec>
+SuperString::ConstUTF16Sequence<Codec>::ConstUTF16Sequence(const SuperString::Byte *bytes)
+        : _bytes(bytes),
+          _status(Status::LengthNotComputed) {
+    // nothing go here
+}
+
+template<class Codec>
+SuperString::ConstUTF16Sequence<Codec>::ConstUTF16Sequence(const SuperString::Byte *bytes, std::size_t memoryLength)
+        : _bytes(bytes),
+          _memoryLength(memoryLength + 2),
+          _status(Status::MemoryLengthComputed) {
+    // nothing go here
+}
+
+template<class Codec>
+SuperString::ConstUTF16Sequence<Codec>::~ConstUTF16Sequence() {
+    this->reconstructReferencers();
+}
+
+template<class Codec>
+std::size_t SuperString::ConstUTF16Sequence<Codec>::length() const /*override*/ {
+    Status status = this->_status;
+    if(status == Status::LengthNotComputed) {
+        ConstUTF16Sequence *self = ((ConstUTF16Sequence *) ((std::size_t) this)); // to keep this method `const`
+        Pair<std::size_t, std::size_t> lengthAndMemoryLength = Codec::lengthAndMemoryLength(this->_bytes);
+        self->_length = lengthAndMemoryLength.first();
+        self->_memoryLength = lengthAndMemoryLength.second();
+        self->_status = Status::LengthComputed; // once the lengths are set, they may be read from then on
+    } else if(status == Status::MemoryLengthComputed) {
+        ConstUTF16Sequence *self = ((ConstUTF16Sequence *) ((std::size_t) this));
+        self->_length = Codec::length(this->_bytes, this->_memoryLength - 2);
+        self->_status = Status::LengthComputed;
+    }
+    return this->_length;
+}
+
+template<class Codec>
+std::size_t SuperString::ConstUTF16Sequence<Codec>::memoryLength() const {
+    if(this->_status == Status::LengthNotComputed) {
+        this->length();
+    }
+    return (this->_memoryLength > 1) ? this->_memoryLength - 2 : 0; // without the terminator
+}
+
+template<class Codec>
+SuperString::Result<int, SuperString::Error> SuperString::ConstUTF16Sequence<Codec>::codeUnitAt(
+        std::size_t index) const {
+    if(index < this->length()) {
+        const Byte *bytes = this->_bytes + Codec::offset(this->_bytes, index);
+        return Result<int, SuperString::Error>(Codec::decode(bytes));
+    }
+    return Result<int, SuperString::Error>(Error::RangeError);
+}
+
+template<class Codec>
+SuperString::Piece SuperString::ConstUTF16Sequence<Codec>::pieceAt(std::size_t index) const {
+    return Piece(this->_bytes + Codec::offset(this->_bytes, index), Codec::ENCODING, 0,
+                 this->length());
+}
+
+template<class Codec>
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::ConstUTF16Sequence<Codec>::substring(std::size_t startIndex, std::size_t endIndex) const {
+    if(this->length() < startIndex || this->length() < endIndex) {
+        return Result<SuperString, Error>(Error::RangeError);
+    }
+    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
+    return Result<SuperString, Error>(SuperString(sequence));
+}
+
+template<class Codec>
+bool SuperString::ConstUTF16Sequence<Codec>::print(std::ostream &stream) const {
+    Codec::print(stream, this->_bytes, this->length());
+    return true;
+}
+
+template<class Codec>
+bool SuperString::ConstUTF16Sequence<Codec>::print(std::ostream &stream, std::size_t startIndex,
+                                                   std::size_t endIndex) const {
+    std::size_t length = this->length();
+    if(length < startIndex || length < endIndex) {
+        return false;
+    }
+    Codec::print(stream, this->_bytes, startIndex, endIndex);
+    return true;
+}
+
+template<class Codec>
+bool SuperString::ConstUTF16Sequence<Codec>::forEachChunk(const SuperString::ChunkCallback &callback,
+                                                          std::size_t startIndex, std::size_t endIndex) const {
+    if(startIndex < endIndex) {
+        std::size_t startOffset = Codec::offset(this->_bytes, startIndex);
+        std::size_t memoryLength = Codec::offset(this->_bytes + startOffset, endIndex - startIndex);
+        return callback(Chunk(this->_bytes + startOffset, memoryLength, Codec::ENCODING, endIndex - startIndex));
+    }
+    return true;
+}
+
+template<class Codec>
+SuperString SuperString::ConstUTF16Sequence<Codec>::trim() const {
+    std::size_t startIndex = trimmedStart(this->_bytes, this->length());
+    std::size_t endIndex = trimmedEnd(this->_bytes, this->length(), this->memoryLength(), startIndex);
+    return this->substring(startIndex, endIndex).ok();
+}
+
+template<class Codec>
+SuperString SuperString::ConstUTF16Sequence<Codec>::trimLeft() const {
+    return this->substring(trimmedStart(this->_bytes, this->length()), this->length()).ok();
+}
+
+template<class Codec>
+SuperString SuperString::ConstUTF16Sequence<Codec>::trimRight() const {
+    return this->substring(0, trimmedEnd(this->_bytes, this->length(), this->memoryLength(), 0)).ok();
+}
+
+template<class Codec>
+std::size_t SuperString::ConstUTF16Sequence<Codec>::keepingCost() const {
+    return sizeof(ConstUTF16Sequence);
+}
+
+template<class Codec>
+void SuperString::ConstUTF16Sequence<Codec>::doDelete() const {
+    ConstUTF16Sequence *self = ((ConstUTF16Sequence *) (std::size_t) this);
     if(!self->isToBeDeleted()) {
         self->_status = Status::ToBeDestructed; // Just a trick, we don't want any more variable
         delete self;
     }
 }
 
-bool SuperString::ConstASCIISequence::isToBeDeleted() const {
+template<class Codec>
+bool SuperString::ConstUTF16Sequence<Codec>::isToBeDeleted() const {
     return this->_status == Status::ToBeDestructed;
 }
 
-//*-- SuperString::CopyASCIISequence (internal)
-SuperString::CopyASCIISequence::CopyASCIISequence(const SuperString::Byte *bytes) {
-    this->_length = SuperString::ASCII::length(bytes);
-    this->_data = new Byte[this->_length + 1];
-    std::copy_n(bytes, this->_length + 1, this->_data);
+template<class Codec>
+std::size_t SuperString::ConstUTF16Sequence<Codec>::trimmedStart(const SuperString::Byte *bytes,
+                                                                 std::size_t length) {
+    std::size_t startIndex = 0;
+    // white spaces are all in the BMP, so each one leading the text is a single code unit
+    while(startIndex < length && SuperString::isWhiteSpace((bytes[startIndex * 2 + Codec::HIGH] << 8) |
+                                                           bytes[startIndex * 2 + 1 - Codec::HIGH])) {
+        startIndex++;
+    }
+    return startIndex;
 }
 
-SuperString::CopyASCIISequence::CopyASCIISequence(const SuperString::ConstASCIISequence *sequence) {
+template<class Codec>
+std::size_t SuperString::ConstUTF16Sequence<Codec>::trimmedEnd(const SuperString::Byte *bytes, std::size_t length,
+                                                               std::size_t memoryLength, std::size_t startIndex) {
+    std::size_t endIndex = length;
+    std::size_t offset = memoryLength;
+    // a trailing lone high surrogate, left out of [length], is no white space and stops it
+    while(endIndex > startIndex && SuperString::isWhiteSpace((bytes[offset - 2 + Codec::HIGH] << 8) |
+                                                             bytes[offset - 1 - Codec::HIGH])) {
+        endIndex--;
+        offset -= 2;
+    }
+    return endIndex;
+}
+
+//*-- SuperString::CopyUTF16Sequence<Codec> (internal)
+template<class Codec>
+SuperString::CopyUTF16Sequence<Codec>::CopyUTF16Sequence(const SuperString::Byte *bytes) {
+    Pair<std::size_t, std::size_t> lengthAndMemoryLength = Codec::lengthAndMemoryLength(bytes);
+    this->_length = lengthAndMemoryLength.first();
+    this->_memoryLength = lengthAndMemoryLength.second();
+    this->_data = new Byte[this->_memoryLength];
+    std::copy_n(bytes, this->_memoryLength, this->_data);
+}
+
+template<class Codec>
+SuperString::CopyUTF16Sequence<Codec>::CopyUTF16Sequence(const SuperString::ConstUTF16Sequence<Codec> *sequence) {
     this->_length = sequence->length();
-    this->_data = new Byte[this->_length + 1];
-    std::copy_n(sequence->_bytes, this->_length + 1, this->_data);
+    this->_memoryLength = sequence->memoryLength() + 2;
+    this->_data = new Byte[this->_memoryLength];
+    std::copy_n(sequence->_bytes, this->_memoryLength - 2, this->_data);
+    this->_data[this->_memoryLength - 2] = 0x00;
+    this->_data[this->_memoryLength - 1] = 0x00;
 }
 
-SuperString::CopyASCIISequence::~CopyASCIISequence() {
+template<class Codec>
+SuperString::CopyUTF16Sequence<Codec>::CopyUTF16Sequence(SuperString::Byte *data, std::size_t length,
+                                                        std::size_t memoryLength)
+        : _data(data),
+          _length(length),
+          _memoryLength(memoryLength) {
+    // nothing go here
+}
+
+template<class Codec>
+SuperString::CopyUTF16Sequence<Codec>::~CopyUTF16Sequence() {
     this->reconstructReferencers();
-    delete this->_data;
+    delete[] this->_data;
 }
 
-std::size_t SuperString::CopyASCIISequence::length() const {
+template<class Codec>
+std::size_t SuperString::CopyUTF16Sequence<Codec>::length() const {
     return this->_length;
 }
 
-SuperString::Result<int, SuperString::Error> SuperString::CopyASCIISequence::codeUnitAt(
-        std::size_t index) const {
+template<class Codec>
+std::size_t SuperString::CopyUTF16Sequence<Codec>::memoryLength() const {
+    return (this->_memoryLength > 1) ? this->_memoryLength - 2 : 0; // without the terminator
+}
+
+template<class Codec>
+SuperString::Result<int, SuperString::Error>
+SuperString::CopyUTF16Sequence<Codec>::codeUnitAt(std::size_t index) const {
     if(index < this->length()) {
-        return Result<int, SuperString::Error>(SuperString::ASCII::codeUnitAt(this->_data, index));
+        const Byte *bytes = this->_data + this->offset(index);
+        return Result<int, SuperString::Error>(Codec::decode(bytes));
     }
     return Result<int, SuperString::Error>(Error::RangeError);
 }
 
+template<class Codec>
+SuperString::Piece SuperString::CopyUTF16Sequence<Codec>::pieceAt(std::size_t index) const {
+    return Piece(this->_data + this->offset(index), Codec::ENCODING, 0,
+                 this->_length);
+}
+
+template<class Codec>
 SuperString::Result<SuperString, SuperString::Error>
-SuperString::CopyASCIISequence::substring(std::size_t startIndex,
-                                          std::size_t endIndex) const {
+SuperString::CopyUTF16Sequence<Codec>::substring(std::size_t startIndex, std::size_t endIndex) const {
+    if(this->length() < startIndex || this->length() < endIndex) {
+        return Result<SuperString, Error>(Error::RangeError);
+    }
+    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
+    return Result<SuperString, Error>(SuperString(sequence));
+}
+
+template<class Codec>
+bool SuperString::CopyUTF16Sequence<Codec>::print(std::ostream &stream) const {
+    Codec::print(stream, this->_data, this->length());
+    return true;
+}
+
+template<class Codec>
+bool SuperString::CopyUTF16Sequence<Codec>::print(std::ostream &stream, std::size_t startIndex,
+                                                  std::size_t endIndex) const {
+    std::size_t length = this->length();
+    if(length < startIndex || length < endIndex) {
+        return false;
+    }
+    Codec::print(stream, this->_data, startIndex, endIndex);
+    return true;
+}
+
+template<class Codec>
+bool SuperString::CopyUTF16Sequence<Codec>::forEachChunk(const SuperString::ChunkCallback &callback,
+                                                         std::size_t startIndex, std::size_t endIndex) const {
+    if(startIndex < endIndex) {
+        std::size_t startOffset = this->offset(startIndex);
+        std::size_t memoryLength = this->offset(endIndex) - startOffset;
+        return callback(Chunk(this->_data + startOffset, memoryLength, Codec::ENCODING, endIndex - startIndex));
+    }
+    return true;
+}
+
+template<class Codec>
+SuperString SuperString::CopyUTF16Sequence<Codec>::trim() const {
+    std::size_t startIndex = ConstUTF16Sequence<Codec>::trimmedStart(this->_data, this->length());
+    std::size_t endIndex = ConstUTF16Sequence<Codec>::trimmedEnd(this->_data, this->length(), this->memoryLength(),
+                                                                 startIndex);
+    return this->substring(startIndex, endIndex).ok();
+}
+
+template<class Codec>
+SuperString SuperString::CopyUTF16Sequence<Codec>::trimLeft() const {
+    std::size_t startIndex = ConstUTF16Sequence<Codec>::trimmedStart(this->_data, this->length());
+    return this->substring(startIndex, this->length()).ok();
+}
+
+template<class Codec>
+SuperString SuperString::CopyUTF16Sequence<Codec>::trimRight() const {
+    std::size_t endIndex = ConstUTF16Sequence<Codec>::trimmedEnd(this->_data, this->length(), this->memoryLength(), 0);
+    return this->substring(0, endIndex).ok();
+}
+
+template<class Codec>
+std::size_t SuperString::CopyUTF16Sequence<Codec>::keepingCost() const {
+    std::size_t cost = sizeof(CopyUTF16Sequence) + this->_memoryLength;
+    return cost;
+}
+
+template<class Codec>
+void SuperString::CopyUTF16Sequence<Codec>::doDelete() const {
+    CopyUTF16Sequence *self = ((CopyUTF16Sequence *) (std::size_t) this);
+    if(!self->isToBeDeleted()) {
+        self->markToBeDeleted();
+        delete self;
+    }
+}
+
+template<class Codec>
+bool SuperString::CopyUTF16Sequence<Codec>::isToBeDeleted() const {
+    return this->isMarkedToBeDeleted();
+}
+
+template<class Codec>
+std::size_t SuperString::CopyUTF16Sequence<Codec>::offset(std::size_t index) const {
+    if(this->_memoryLength == this->_length * 2 + 2) {
+        return index * 2;
+    }
+    return Codec::offset(this->_data, index);
+}
+
+//*-- SuperString::ConstUTF32Sequence (internal)
+SuperString::ConstUTF32Sequence::ConstUTF32Sequence(const SuperString::Byte *bytes)
+        : _bytes(((const int *) bytes)),
+          _status(SuperString::ConstUTF32Sequence::Status::LengthNotComputed) {
+    // nothing go here
+}
+
+SuperString::ConstUTF32Sequence::ConstUTF32Sequence(const SuperString::Byte *bytes, std::size_t memoryLength)
+        : _bytes(((const int *) bytes)),
+          _length(memoryLength / sizeof(int)),
+          _status(SuperString::ConstUTF32Sequence::Status::LengthComputed) {
+    // nothing go here
+}
+
+SuperString::ConstUTF32Sequence::~ConstUTF32Sequence() {
+    this->reconstructReferencers();
+}
+
+std::size_t SuperString::ConstUTF32Sequence::length() const /*override*/ {
+    if(this->_status == Status::LengthNotComputed) {
+        ConstUTF32Sequence *self = ((ConstUTF32Sequence *) ((std::size_t) this)); // to keep this method `const`
+        self->_length = SuperString::UTF32::length(((const Byte *) this->_bytes));
+        self->_status = Status::LengthComputed; // once the length is set, it may be read from then on
+    }
+    return this->_length;
+}
+
+std::size_t SuperString::ConstUTF32Sequence::memoryLength() const {
+    return this->length() * sizeof(int);
+}
+
+SuperString::Result<int, SuperString::Error>
+SuperString::ConstUTF32Sequence::codeUnitAt(std::size_t index) const {
+    if(index < this->length()) {
+        return Result<int, SuperString::Error>(SuperString::UTF32::codeUnitAt(((const Byte *) this->_bytes), index));
+    }
+    return Result<int, SuperString::Error>(Error::RangeError);
+}
+
+SuperString::Piece SuperString::ConstUTF32Sequence::pieceAt(std::size_t index) const {
+    return Piece((const Byte *) (this->_bytes + index), Encoding::UTF32, 0, this->length());
+}
+
+SuperString::Result<SuperString, SuperString::Error>
+SuperString::ConstUTF32Sequence::substring(std::size_t startIndex,
+                                           std::size_t endIndex) const {
     // TODO: General code, specify + repeated * times
     if(this->length() < startIndex || this->length() < endIndex) {
         return Result<SuperString, Error>(Error::RangeError);
@@ -459,214 +2960,257 @@ SuperString::CopyASCIISequence::substring(std::size_t startIndex,
     return Result<SuperString, Error>(SuperString(sequence));
 }
 
-bool SuperString::CopyASCIISequence::print(std::ostream &stream) const {
-    SuperString::ASCII::print(stream, this->_data);
+bool SuperString::ConstUTF32Sequence::print(std::ostream &stream) const {
+    SuperString::UTF32::print(stream, ((const Byte *) this->_bytes), 0, this->length());
     return true;
 }
 
-bool SuperString::CopyASCIISequence::print(std::ostream &stream, std::size_t startIndex,
-                                                        std::size_t endIndex) const {
+bool SuperString::ConstUTF32Sequence::print(std::ostream &stream, std::size_t startIndex,
+                                                         std::size_t endIndex) const {
     if(this->length() < startIndex || this->length() < endIndex) {
         return false;
     }
-    SuperString::ASCII::print(stream, this->_data, startIndex, endIndex);
+    SuperString::UTF32::print(stream, ((Byte *) this->_bytes), startIndex, endIndex);
     return true;
 }
 
-SuperString SuperString::CopyASCIISequence::trim() const {
-    Pair<std::size_t, std::size_t> indexes = SuperString::ASCII::trim(this->_data, this->_length);
+bool SuperString::ConstUTF32Sequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                   std::size_t endIndex) const {
+    if(startIndex < endIndex) {
+        return callback(Chunk((const Byte *) (this->_bytes + startIndex), (endIndex - startIndex) * sizeof(int),
+                              Encoding::UTF32, endIndex - startIndex));
+    }
+    return true;
+}
+
+SuperString SuperString::ConstUTF32Sequence::trim() const {
+    Pair<std::size_t, std::size_t> indexes = SuperString::UTF32::trim(((Byte *) this->_bytes), this->length());
     return this->substring(indexes.first(), indexes.second()).ok();
 }
 
-SuperString SuperString::CopyASCIISequence::trimLeft() const {
-    return this->substring(SuperString::ASCII::trimLeft(this->_data), this->length()).ok();
+SuperString SuperString::ConstUTF32Sequence::trimLeft() const {
+    return this->substring(SuperString::UTF32::trimLeft(((Byte *) this->_bytes), this->length()),
+                           this->length()).ok();
 }
 
-SuperString SuperString::CopyASCIISequence::trimRight() const {
-    return this->substring(0, SuperString::ASCII::trimRight(this->_data, this->length())).ok();
+SuperString SuperString::ConstUTF32Sequence::trimRight() const {
+    return this->substring(0, SuperString::UTF32::trimRight(((Byte *) this->_bytes), this->length())).ok();
 }
 
-std::size_t SuperString::CopyASCIISequence::keepingCost() const {
-    std::size_t cost = sizeof(CopyASCIISequence);
-    if(this->_data != NULL) {
-        cost += this->length() + 1;
-    }
-    return cost;
+std::size_t SuperString::ConstUTF32Sequence::keepingCost() const {
+    return sizeof(ConstUTF32Sequence);
 }
 
-void SuperString::CopyASCIISequence::doDelete() const {
-    CopyASCIISequence *self = ((CopyASCIISequence *) (std::size_t) this);
+void SuperString::ConstUTF32Sequence::doDelete() const {
+    ConstUTF32Sequence *self = ((ConstUTF32Sequence *) (std::size_t) this);
     if(!self->isToBeDeleted()) {
-        self->_length = 0; // Just a trick, we don't want any more variable
+        self->_status = Status::ToBeDestructed; // Just a trick, we don't want any more variable
         delete self;
     }
 }
 
-bool SuperString::CopyASCIISequence::isToBeDeleted() const {
-    return this->_length == 0;
+bool SuperString::ConstUTF32Sequence::isToBeDeleted() const {
+    return this->_status == Status::ToBeDestructed;
 }
 
-//*-- SuperString::ConstUTF8Sequence (internal)
-SuperString::ConstUTF8Sequence::ConstUTF8Sequence(const Byte *bytes)
-        : _bytes(bytes),
-          _status(SuperString::ConstUTF8Sequence::Status::LengthNotComputed) {
+//*-- SuperString::CopyUTF32Sequence (internal)
+SuperString::CopyUTF32Sequence::CopyUTF32Sequence(const SuperString::Byte *bytes) {
+    this->_length = SuperString::UTF32::length(bytes);
+    this->_data = new int[this->_length + 1];
+    std::copy_n((const int *) bytes, this->_length + 1, this->_data);
+}
+
+SuperString::CopyUTF32Sequence::CopyUTF32Sequence(const SuperString::ConstUTF32Sequence *sequence) {
+    this->_length = sequence->length();
+    this->_data = new int[this->_length + 1];
+    std::copy_n(sequence->_bytes, this->_length, this->_data);
+    this->_data[this->_length] = 0;
+}
+
+SuperString::CopyUTF32Sequence::CopyUTF32Sequence(int *data, std::size_t length)
+        : _data(data),
+          _length(length) {
     // nothing go here
 }
 
-SuperString::ConstUTF8Sequence::~ConstUTF8Sequence() {
+SuperString::CopyUTF32Sequence::~CopyUTF32Sequence() {
     this->reconstructReferencers();
+    delete[] this->_data;
 }
 
-std::size_t SuperString::ConstUTF8Sequence::length() const /*override*/ {
-    if(this->_status == Status::LengthNotComputed) {
-        ConstUTF8Sequence *self = ((ConstUTF8Sequence *) ((std::size_t) this)); // to keep this method `const`
-        self->_status = Status::LengthComputed;
-        self->_length = SuperString::UTF8::length(this->_bytes);
+std::size_t SuperString::CopyUTF32Sequence::length() const {
+    return this->_length;
+}
+
+std::size_t SuperString::CopyUTF32Sequence::memoryLength() const {
+    return this->_length * sizeof(int);
+}
+
+SuperString::Result<int, SuperString::Error> SuperString::CopyUTF32Sequence::codeUnitAt(
+        std::size_t index) const {
+    if(index < this->length()) {
+        return Result<int, SuperString::Error>(SuperString::UTF32::codeUnitAt(((const Byte *) this->_data), index));
     }
-    return this->_length;
+    return Result<int, SuperString::Error>(Error::RangeError);
 }
 
-SuperString::Result<int, SuperString::Error> SuperString::ConstUTF8Sequence::codeUnitAt(std::size_t index) const {
-    return SuperString::UTF8::codeUnitAt(this->_bytes, index);
+SuperString::Piece SuperString::CopyUTF32Sequence::pieceAt(std::size_t index) const {
+    return Piece((const Byte *) (this->_data + index), Encoding::UTF32, 0, this->_length);
 }
 
 SuperString::Result<SuperString, SuperString::Error>
-SuperString::ConstUTF8Sequence::substring(std::size_t startIndex,
+SuperString::CopyUTF32Sequence::substring(std::size_t startIndex,
                                           std::size_t endIndex) const {
     // TODO: General code, specify + repeated * times
-    std::size_t length = this->length();
-    if(length < startIndex || length < endIndex) {
+    if(this->length() < startIndex || this->length() < endIndex) {
         return Result<SuperString, Error>(Error::RangeError);
     }
     SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
     return Result<SuperString, Error>(SuperString(sequence));
 }
 
-bool SuperString::ConstUTF8Sequence::print(std::ostream &stream) const {
-    SuperString::UTF8::print(stream, this->_bytes);
+bool SuperString::CopyUTF32Sequence::print(std::ostream &stream) const {
+    SuperString::UTF32::print(stream, ((const Byte *) this->_data), 0, this->_length);
     return true;
 }
 
-bool SuperString::ConstUTF8Sequence::print(std::ostream &stream, std::size_t startIndex,
+bool SuperString::CopyUTF32Sequence::print(std::ostream &stream, std::size_t startIndex,
                                                         std::size_t endIndex) const {
-    std::size_t length = this->length();
-    if(length < startIndex || length < endIndex) {
+    if(this->length() < startIndex || this->length() < endIndex) {
         return false;
     }
-    SuperString::UTF8::print(stream, this->_bytes, startIndex, endIndex);
+    SuperString::UTF32::print(stream, ((const Byte *) this->_data), startIndex, endIndex);
     return true;
 }
 
-SuperString SuperString::ConstUTF8Sequence::trim() const {
-    // TODO: General code, specify
-    std::size_t startIndex = 0;
-    std::size_t endIndex = this->length();
-    Result<int, Error> result = this->codeUnitAt(startIndex);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(++startIndex);
+bool SuperString::CopyUTF32Sequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                  std::size_t endIndex) const {
+    if(startIndex < endIndex) {
+        return callback(Chunk((const Byte *) (this->_data + startIndex), (endIndex - startIndex) * sizeof(int),
+                              Encoding::UTF32, endIndex - startIndex));
     }
-    result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(--endIndex - 1);
-    }
-    return this->substring(startIndex, endIndex).ok();
+    return true;
 }
 
-SuperString SuperString::ConstUTF8Sequence::trimLeft() const {
-    // TODO: General code, specify
-    std::size_t startIndex = 0;
-    Result<int, Error> result = this->codeUnitAt(startIndex);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(++startIndex);
-    }
-    return this->substring(startIndex, this->length()).ok();
+SuperString SuperString::CopyUTF32Sequence::trim() const {
+    Pair<std::size_t, std::size_t> indexes = SuperString::UTF32::trim(((const Byte *) this->_data), this->_length);
+    return this->substring(indexes.first(), indexes.second()).ok();
 }
 
-SuperString SuperString::ConstUTF8Sequence::trimRight() const {
-    // TODO: General code, specify
-    std::size_t endIndex = this->length();
-    Result<int, Error> result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(--endIndex - 1);
-    }
-    return this->substring(0, endIndex).ok();
+SuperString SuperString::CopyUTF32Sequence::trimLeft() const {
+    return this->substring(SuperString::UTF32::trimLeft(((const Byte *) this->_data), this->_length),
+                           this->length()).ok();
 }
 
-std::size_t SuperString::ConstUTF8Sequence::keepingCost() const {
-    return sizeof(ConstUTF8Sequence);
+SuperString SuperString::CopyUTF32Sequence::trimRight() const {
+    return this->substring(0, SuperString::UTF32::trimRight(((const Byte *) this->_data), this->length())).ok();
 }
 
-void SuperString::ConstUTF8Sequence::doDelete() const {
-    ConstUTF8Sequence *self = ((ConstUTF8Sequence *) (std::size_t) this);
+std::size_t SuperString::CopyUTF32Sequence::keepingCost() const {
+    std::size_t cost = sizeof(CopyASCIISequence);
+    if(this->_data != NULL) {
+        cost += this->length() + 1;
+    }
+    return cost;
+}
+
+void SuperString::CopyUTF32Sequence::doDelete() const {
+    CopyUTF32Sequence *self = ((CopyUTF32Sequence *) (std::size_t) this);
     if(!self->isToBeDeleted()) {
-        self->_status = Status::ToBeDestructed; // Just a trick, we don't want any more variable
+        self->markToBeDeleted();
         delete self;
     }
 }
 
-bool SuperString::ConstUTF8Sequence::isToBeDeleted() const {
-    return this->_status == Status::ToBeDestructed;
+bool SuperString::CopyUTF32Sequence::isToBeDeleted() const {
+    return this->isMarkedToBeDeleted();
 }
 
-//*-- SuperString::CopyUTF8Sequence (internal)
-SuperString::CopyUTF8Sequence::CopyUTF8Sequence(const SuperString::Byte *bytes) {
-    Pair<std::size_t, std::size_t> lengthAndMemoryLength = SuperString::UTF8::lengthAndMemoryLength(bytes);
-    this->_length = lengthAndMemoryLength.first();
-    this->_memoryLength = lengthAndMemoryLength.second();
-    this->_data = new Byte[this->_memoryLength];
-    std::copy_n(bytes, this->_memoryLength, this->_data);
+//*-- SuperString::SubstringSequence (internal)
+SuperString::SubstringSequence::SubstringSequence(const StringSequence *sequence, std::size_t startIndex,
+                                                  std::size_t endIndex) {
+    this->_sequence = sequence;
+    this->_startIndex = startIndex;
+    this->_endIndex = endIndex;
+    this->_referencer._sequence = this;
+    this->_sequence->addReferencer(&this->_referencer);
+    this->_summary = this->summarize();
 }
 
-SuperString::CopyUTF8Sequence::CopyUTF8Sequence(const SuperString::ConstUTF8Sequence *sequence) {
-    Pair<std::size_t, std::size_t> lengthAndMemoryLength = SuperString::UTF8::lengthAndMemoryLength(sequence->_bytes);
-    this->_length = lengthAndMemoryLength.first();
-    this->_memoryLength = lengthAndMemoryLength.second();
-    this->_data = new Byte[this->_memoryLength];
-    std::copy_n(sequence->_bytes, this->_memoryLength, this->_data);
+SuperString::SubstringSequence::SubstringSequence(const StringSequence *sequence, std::size_t startIndex,
+                                                  std::size_t endIndex, Referencer *&referencers, std::size_t &cost) {
+    this->_sequence = sequence;
+    this->_startIndex = startIndex;
+    this->_endIndex = endIndex;
+    this->_referencer._sequence = this;
+    this->_referencer._cost = this->reconstructionCost(sequence);
+    this->_referencer._next = referencers;
+    if(referencers != NULL) {
+        referencers->_previous = &this->_referencer;
+    }
+    referencers = &this->_referencer;
+    cost += this->_referencer._cost;
+    this->_summary = this->summarize();
 }
 
-SuperString::CopyUTF8Sequence::~CopyUTF8Sequence() {
+SuperString::SubstringSequence::~SubstringSequence() {
     this->reconstructReferencers();
-    delete this->_data;
+    this->_sequence->removeReferencer(&this->_referencer);
+    this->_sequence->collect();
 }
 
-std::size_t SuperString::CopyUTF8Sequence::length() const {
-    return this->_length;
+SuperString::Summary SuperString::SubstringSequence::summarize() const {
+    Summary summary;
+    summary._length = this->_endIndex - this->_startIndex;
+    summary._memoryLength = this->_sequence->memoryLength();
+    summary._depth = this->_sequence->depth() + 1;
+    return summary;
 }
 
-SuperString::Result<int, SuperString::Error> SuperString::CopyUTF8Sequence::codeUnitAt(std::size_t index) const {
+SuperString::Result<int, SuperString::Error> SuperString::SubstringSequence::codeUnitAt(
+        std::size_t index) const {
     if(index < this->length()) {
-        return Result<int, Error>(SuperString::UTF8::codeUnitAt(this->_data, index));
+        return this->_sequence->codeUnitAt(this->_startIndex + index);
     }
     return Result<int, SuperString::Error>(Error::RangeError);
 }
 
+SuperString::Piece SuperString::SubstringSequence::pieceAt(std::size_t) const {
+    return Piece(this->_sequence, 0, this->length(), this->_startIndex);
+}
+
 SuperString::Result<SuperString, SuperString::Error>
-SuperString::CopyUTF8Sequence::substring(std::size_t startIndex, std::size_t endIndex) const {
-    // TODO: General code, specify + repeated * times
-    if(this->length() < startIndex || this->length() < endIndex) {
+SuperString::SubstringSequence::substring(std::size_t startIndex, std::size_t endIndex) const {
+    std::size_t length = this->length();
+    if(length < startIndex || length < endIndex) {
         return Result<SuperString, Error>(Error::RangeError);
     }
-    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
-    return Result<SuperString, Error>(SuperString(sequence));
+    return Result<SuperString, Error>(
+            SuperString(new SubstringSequence(this->_sequence,
+                                              this->_startIndex + startIndex,
+                                              this->_startIndex + endIndex)));
 }
 
-bool SuperString::CopyUTF8Sequence::print(std::ostream &stream) const {
-    SuperString::UTF8::print(stream, this->_data);
-    return true;
+bool SuperString::SubstringSequence::print(std::ostream &stream) const {
+    return this->_sequence->print(stream, this->_startIndex,
+                                                        this->_endIndex);
 }
 
-bool SuperString::CopyUTF8Sequence::print(std::ostream &stream, std::size_t startIndex,
-                                                       std::size_t endIndex) const {
-    std::size_t length = this->length();
-    if(length < startIndex || length < endIndex) {
-        return false;
-    }
-    SuperString::UTF8::print(stream, this->_data, startIndex, endIndex);
-    return true;
+bool SuperString::SubstringSequence::print(std::ostream &stream, std::size_t startIndex,
+                                                        std::size_t endIndex) const {
+    return this->_sequence->print(stream,
+                                                        this->_startIndex + startIndex,
+                                                        this->_startIndex + endIndex);
 }
 
-SuperString SuperString::CopyUTF8Sequence::trim() const {
+bool SuperString::SubstringSequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                  std::size_t endIndex) const {
+    return this->_sequence->forEachChunk(callback,
+                                                               this->_startIndex + startIndex,
+                                                               this->_startIndex + endIndex);
+}
+
+SuperString SuperString::SubstringSequence::trim() const {
     // TODO: General code, specify
     std::size_t startIndex = 0;
     std::size_t endIndex = this->length();
@@ -675,13 +3219,13 @@ SuperString SuperString::CopyUTF8Sequence::trim() const {
         result = this->codeUnitAt(++startIndex);
     }
     result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+    while(endIndex > startIndex && result.isOk() && SuperString::isWhiteSpace(result.ok())) {
         result = this->codeUnitAt(--endIndex - 1);
     }
     return this->substring(startIndex, endIndex).ok();
 }
 
-SuperString SuperString::CopyUTF8Sequence::trimLeft() const {
+SuperString SuperString::SubstringSequence::trimLeft() const {
     // TODO: General code, specify
     std::size_t startIndex = 0;
     Result<int, Error> result = this->codeUnitAt(startIndex);
@@ -691,7 +3235,7 @@ SuperString SuperString::CopyUTF8Sequence::trimLeft() const {
     return this->substring(startIndex, this->length()).ok();
 }
 
-SuperString SuperString::CopyUTF8Sequence::trimRight() const {
+SuperString SuperString::SubstringSequence::trimRight() const {
     // TODO: General code, specify
     std::size_t endIndex = this->length();
     Result<int, Error> result = this->codeUnitAt(endIndex - 1);
@@ -701,55 +3245,122 @@ SuperString SuperString::CopyUTF8Sequence::trimRight() const {
     return this->substring(0, endIndex).ok();
 }
 
-std::size_t SuperString::CopyUTF8Sequence::keepingCost() const {
-    std::size_t cost = sizeof(CopyUTF8Sequence) + this->_memoryLength;
-    return cost;
+std::size_t SuperString::SubstringSequence::keepingCost() const {
+    return sizeof(SubstringSequence); // the source is charged to itself, it may be shared
 }
 
-void SuperString::CopyUTF8Sequence::doDelete() const {
-    CopyUTF8Sequence *self = ((CopyUTF8Sequence *) (std::size_t) this);
+std::size_t SuperString::SubstringSequence::reconstructionCost(const StringSequence *) const {
+    return ReferenceStringSequence::compactionCost(this->_sequence,
+                                                   this->_startIndex,
+                                                   this->_endIndex);
+}
+
+void SuperString::SubstringSequence::reconstruct(const StringSequence *sequence) const {
+    SubstringSequence *self = ((SubstringSequence *) ((std::size_t) this));
+    if(self->_sequence == sequence) {
+        const StringSequence *compacted = ReferenceStringSequence::compact(sequence, self->_startIndex,
+                                                                           self->_endIndex);
+        sequence->removeReferencer(&self->_referencer);
+        sequence->collect();
+        self->_sequence = compacted;
+        self->_endIndex -= self->_startIndex;
+        self->_startIndex = 0;
+        compacted->addReferencer(&self->_referencer);
+        self->refreshSummary();
+    }
+}
+
+void SuperString::SubstringSequence::flatten(const StringSequence *leaf) const {
+    SubstringSequence *self = ((SubstringSequence *) ((std::size_t) this));
+    const StringSequence *sequence = self->_sequence;
+    sequence->removeReferencer(&self->_referencer);
+    self->_sequence = leaf;
+    self->_endIndex -= self->_startIndex;
+    self->_startIndex = 0;
+    leaf->addReferencer(&self->_referencer);
+    sequence->collect();
+    self->refreshSummary();
+}
+
+void SuperString::SubstringSequence::doDelete() const {
+    SubstringSequence *self = ((SubstringSequence *) (std::size_t) this);
     if(!self->isToBeDeleted()) {
-        self->_length = 0; // Just a trick, we don't want any more variable
+        self->markToBeDeleted();
         delete self;
     }
 }
 
-bool SuperString::CopyUTF8Sequence::isToBeDeleted() const {
-    return this->_length == 0;
+bool SuperString::SubstringSequence::isToBeDeleted() const {
+    return this->isMarkedToBeDeleted();
 }
 
-//*-- ConstUTF16BESequence (internal)
-SuperString::ConstUTF16BESequence::ConstUTF16BESequence(const SuperString::Byte *bytes)
-        : _bytes(bytes),
-          _status(SuperString::ConstUTF16BESequence::Status::LengthNotComputed) {
-    // nothing go here
+//*-- SuperString::ConcatenationSequence (internal)
+SuperString::ConcatenationSequence::ConcatenationSequence(const StringSequence *leftSequence,
+                                                          const StringSequence *rightSequence) {
+    this->_left = leftSequence;
+    this->_right = rightSequence;
+    this->_leftReferencer._sequence = this;
+    this->_rightReferencer._sequence = this;
+    this->_left->addReferencer(&this->_leftReferencer);
+    this->_right->addReferencer(&this->_rightReferencer);
+    this->_summary = this->summarize();
 }
 
-SuperString::ConstUTF16BESequence::~ConstUTF16BESequence() {
+SuperString::ConcatenationSequence::~ConcatenationSequence() {
     this->reconstructReferencers();
+    this->_left->removeReferencer(&this->_leftReferencer);
+    // a sequence on both sides is only collected once unlinked from both
+    if(this->_left != this->_right) {
+        this->_left->collect();
+    }
+    this->_right->removeReferencer(&this->_rightReferencer);
+    this->_right->collect();
 }
 
-std::size_t SuperString::ConstUTF16BESequence::length() const /*override*/ {
-    if(this->_status == Status::LengthNotComputed) {
-        ConstUTF16BESequence *self = ((ConstUTF16BESequence *) ((std::size_t) this)); // to keep this method `const`
-        self->_status = Status::LengthComputed;
-        self->_length = SuperString::UTF16BE::length(this->_bytes);
+SuperString::Summary SuperString::ConcatenationSequence::summarize() const {
+    Summary summary;
+    summary._length = this->_left->length() +
+                      this->_right->length();
+    summary._memoryLength = this->_left->memoryLength() +
+                            this->_right->memoryLength();
+    summary._depth = std::max(this->_left->depth(),
+                              this->_right->depth()) + 1;
+    return summary;
+}
+
+std::uint64_t SuperString::ConcatenationSequence::computeHash() const {
+    const StringSequence *right = this->_right;
+    return SuperString::Hash::concatenate(this->_left->hash(), right->hash(),
+                                          right->length());
+}
+
+bool SuperString::ConcatenationSequence::isConcatenation() const {
+    return true;
+}
+
+SuperString::Result<int, SuperString::Error>
+SuperString::ConcatenationSequence::codeUnitAt(std::size_t index) const {
+    if(this->length() <= index) {
+        return Result<int, Error>(Error::RangeError);
     }
-    return this->_length;
+    std::size_t leftLength = this->_left->length();
+    if(index < leftLength) {
+        return this->_left->codeUnitAt(index);
+    }
+    return this->_right->codeUnitAt(index - leftLength);
 }
 
-SuperString::Result<int, SuperString::Error> SuperString::ConstUTF16BESequence::codeUnitAt(
-        std::size_t index) const {
-    if(index < this->length()) {
-        return SuperString::UTF16BE::codeUnitAt(this->_bytes, index);
+SuperString::Piece SuperString::ConcatenationSequence::pieceAt(std::size_t index) const {
+    std::size_t leftLength = this->_left->length();
+    if(index < leftLength) {
+        return Piece(this->_left, 0, leftLength, 0);
     }
-    return Result<int, SuperString::Error>(Error::RangeError);
+    return Piece(this->_right, leftLength, this->length(), 0);
 }
 
 SuperString::Result<SuperString, SuperString::Error>
-SuperString::ConstUTF16BESequence::substring(std::size_t startIndex,
-                                             std::size_t endIndex) const {
-    // TODO: General code, specify + repeated * times
+SuperString::ConcatenationSequence::substring(std::size_t startIndex,
+                                              std::size_t endIndex) const {
     if(this->length() < startIndex || this->length() < endIndex) {
         return Result<SuperString, Error>(Error::RangeError);
     }
@@ -757,22 +3368,53 @@ SuperString::ConstUTF16BESequence::substring(std::size_t startIndex,
     return Result<SuperString, Error>(SuperString(sequence));
 }
 
-bool SuperString::ConstUTF16BESequence::print(std::ostream &stream) const {
-    SuperString::UTF16BE::print(stream, this->_bytes, this->length());
-    return true;
+bool SuperString::ConcatenationSequence::print(std::ostream &stream) const {
+    bool isOk = true;
+    isOk &= this->_left->print(stream);
+    isOk &= this->_right->print(stream);
+    return isOk;
 }
 
-bool SuperString::ConstUTF16BESequence::print(std::ostream &stream, std::size_t startIndex,
-                                                           std::size_t endIndex) const {
-    std::size_t length = this->length();
-    if(length < startIndex || length < endIndex) {
+bool SuperString::ConcatenationSequence::print(std::ostream &stream, std::size_t startIndex,
+                                                            std::size_t endIndex) const {
+    bool isOk = true;
+    if(startIndex < this->_left->length()) {
+        if(endIndex < this->_left->length()) {
+            isOk &= this->_left->print(stream, startIndex, endIndex);
+        } else {
+            isOk &= this->_left->print(stream, startIndex,
+                                                                 this->_left->length());
+            isOk &= this->_right->print(stream, 0,
+                                                                  endIndex -
+                                                                  this->_left->length());
+        }
+    } else {
+        if((endIndex - this->_left->length()) <=
+           this->_right->length()) {
+            isOk &= this->_right->print(stream, startIndex -
+                                                                          this->_left->length(),
+                                                                  endIndex -
+                                                                  this->_left->length());
+        }
+    }
+    return isOk;
+}
+
+bool SuperString::ConcatenationSequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                      std::size_t endIndex) const {
+    std::size_t leftLength = this->_left->length();
+    if(startIndex < leftLength &&
+       !this->_left->forEachChunk(callback, startIndex, std::min(endIndex, leftLength))) {
         return false;
     }
-    SuperString::UTF16BE::print(stream, this->_bytes, startIndex, endIndex);
+    if(leftLength < endIndex) {
+        return this->_right->forEachChunk(
+                callback, std::max(startIndex, leftLength) - leftLength, endIndex - leftLength);
+    }
     return true;
 }
 
-SuperString SuperString::ConstUTF16BESequence::trim() const {
+SuperString SuperString::ConcatenationSequence::trim() const {
     // TODO: General code, specify
     std::size_t startIndex = 0;
     std::size_t endIndex = this->length();
@@ -781,13 +3423,13 @@ SuperString SuperString::ConstUTF16BESequence::trim() const {
         result = this->codeUnitAt(++startIndex);
     }
     result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+    while(endIndex > startIndex && result.isOk() && SuperString::isWhiteSpace(result.ok())) {
         result = this->codeUnitAt(--endIndex - 1);
     }
     return this->substring(startIndex, endIndex).ok();
 }
 
-SuperString SuperString::ConstUTF16BESequence::trimLeft() const {
+SuperString SuperString::ConcatenationSequence::trimLeft() const {
     // TODO: General code, specify
     std::size_t startIndex = 0;
     Result<int, Error> result = this->codeUnitAt(startIndex);
@@ -797,7 +3439,7 @@ SuperString SuperString::ConstUTF16BESequence::trimLeft() const {
     return this->substring(startIndex, this->length()).ok();
 }
 
-SuperString SuperString::ConstUTF16BESequence::trimRight() const {
+SuperString SuperString::ConcatenationSequence::trimRight() const {
     // TODO: General code, specify
     std::size_t endIndex = this->length();
     Result<int, Error> result = this->codeUnitAt(endIndex - 1);
@@ -807,82 +3449,237 @@ SuperString SuperString::ConstUTF16BESequence::trimRight() const {
     return this->substring(0, endIndex).ok();
 }
 
-std::size_t SuperString::ConstUTF16BESequence::keepingCost() const {
-    return sizeof(ConstUTF16BESequence);
+std::size_t SuperString::ConcatenationSequence::keepingCost() const {
+    return sizeof(ConcatenationSequence); // the sides are charged to themselves, they may be shared
+}
+
+std::size_t SuperString::ConcatenationSequence::reconstructionCost(const StringSequence *sequence) const {
+    return ReferenceStringSequence::compactionCost(sequence, 0, sequence->length());
+}
+
+void SuperString::ConcatenationSequence::reconstruct(const StringSequence *sequence) const {
+    ConcatenationSequence *self = ((ConcatenationSequence *) ((std::size_t) this));
+    bool isLeft = self->_left == sequence;
+    if(isLeft || self->_right == sequence) {
+        // one side at a time, both sides may be the same sequence
+        Referencer *referencer = isLeft ? &self->_leftReferencer : &self->_rightReferencer;
+        const StringSequence *compacted = ReferenceStringSequence::compact(sequence, 0, sequence->length());
+        sequence->removeReferencer(referencer);
+        sequence->collect();
+        if(isLeft) {
+            self->_left = compacted;
+        } else {
+            self->_right = compacted;
+        }
+        compacted->addReferencer(referencer);
+        self->refreshSummary();
+    }
+}
+
+void SuperString::ConcatenationSequence::flatten(const StringSequence *leaf) const {
+    ConcatenationSequence *self = ((ConcatenationSequence *) ((std::size_t) this));
+    // both sides keep their lengths, as views on the leaf
+    std::size_t leftLength = self->_left->length();
+    const StringSequence *left = self->_left;
+    self->_left = new SubstringSequence(leaf, 0, leftLength);
+    left->removeReferencer(&self->_leftReferencer);
+    self->_left->addReferencer(&self->_leftReferencer);
+    // collecting the left side may reconstruct this sequence, the right side is read after it
+    if(left != self->_right) {
+        left->collect();
+    }
+    const StringSequence *right = self->_right;
+    self->_right = new SubstringSequence(leaf, leftLength, self->length());
+    right->removeReferencer(&self->_rightReferencer);
+    self->_right->addReferencer(&self->_rightReferencer);
+    right->collect();
+    self->refreshSummary();
+}
+
+SuperString::ConcatenationSequence *
+SuperString::ConcatenationSequence::join(const StringSequence *left, const StringSequence *right) {
+    Pair<const StringSequence *, const StringSequence *> children(left, right);
+    if(left->depth() > right->depth() + 1 && left->isConcatenation()) {
+        children = ConcatenationSequence::joinRight((const ConcatenationSequence *) left, right);
+    } else if(right->depth() > left->depth() + 1 && right->isConcatenation()) {
+        children = ConcatenationSequence::joinLeft(left, (const ConcatenationSequence *) right);
+    }
+    return new ConcatenationSequence(children.first(), children.second());
+}
+
+SuperString::Pair<const SuperString::StringSequence *, const SuperString::StringSequence *>
+SuperString::ConcatenationSequence::joinRight(const ConcatenationSequence *left, const StringSequence *right) {
+    // AVL join, descending the right spine of [left] until it meets the depth of [right],
+    // only the final nodes are created, rotations are resolved before creating them.
+    const StringSequence *outer = left->_left;
+    const StringSequence *inner = left->_right;
+    if(inner->depth() > right->depth() + 1 && inner->isConcatenation()) {
+        Pair<const StringSequence *, const StringSequence *> joined = joinRight(
+                (const ConcatenationSequence *) inner, right);
+        std::size_t joinedDepth = std::max(joined.first()->depth(), joined.second()->depth()) + 1;
+        if(joinedDepth <= outer->depth() + 1) {
+            return Pair<const StringSequence *, const StringSequence *>(
+                    outer, new ConcatenationSequence(joined.first(), joined.second()));
+        }
+        return Pair<const StringSequence *, const StringSequence *>(
+                new ConcatenationSequence(outer, joined.first()), joined.second());
+    }
+    std::size_t joinedDepth = std::max(inner->depth(), right->depth()) + 1;
+    if(joinedDepth > outer->depth() + 1 && inner->isConcatenation()) {
+        const ConcatenationSequence *middle = (const ConcatenationSequence *) inner;
+        return Pair<const StringSequence *, const StringSequence *>(
+                new ConcatenationSequence(outer, middle->_left),
+                new ConcatenationSequence(middle->_right, right));
+    }
+    return Pair<const StringSequence *, const StringSequence *>(outer, new ConcatenationSequence(inner, right));
+}
+
+SuperString::Pair<const SuperString::StringSequence *, const SuperString::StringSequence *>
+SuperString::ConcatenationSequence::joinLeft(const StringSequence *left, const ConcatenationSequence *right) {
+    // mirror of `joinRight`, descending the left spine of [right]
+    const StringSequence *outer = right->_right;
+    const StringSequence *inner = right->_left;
+    if(inner->depth() > left->depth() + 1 && inner->isConcatenation()) {
+        Pair<const StringSequence *, const StringSequence *> joined = joinLeft(
+                left, (const ConcatenationSequence *) inner);
+        std::size_t joinedDepth = std::max(joined.first()->depth(), joined.second()->depth()) + 1;
+        if(joinedDepth <= outer->depth() + 1) {
+            return Pair<const StringSequence *, const StringSequence *>(
+                    new ConcatenationSequence(joined.first(), joined.second()), outer);
+        }
+        return Pair<const StringSequence *, const StringSequence *>(
+                joined.first(), new ConcatenationSequence(joined.second(), outer));
+    }
+    std::size_t joinedDepth = std::max(left->depth(), inner->depth()) + 1;
+    if(joinedDepth > outer->depth() + 1 && inner->isConcatenation()) {
+        const ConcatenationSequence *middle = (const ConcatenationSequence *) inner;
+        return Pair<const StringSequence *, const StringSequence *>(
+                new ConcatenationSequence(left, middle->_left),
+                new ConcatenationSequence(middle->_right, outer));
+    }
+    return Pair<const StringSequence *, const StringSequence *>(new ConcatenationSequence(left, inner), outer);
 }
 
-void SuperString::ConstUTF16BESequence::doDelete() const {
-    ConstUTF16BESequence *self = ((ConstUTF16BESequence *) (std::size_t) this);
+void SuperString::ConcatenationSequence::doDelete() const {
+    ConcatenationSequence *self = ((ConcatenationSequence *) (std::size_t) this);
     if(!self->isToBeDeleted()) {
-        self->_status = Status::ToBeDestructed; // Just a trick, we don't want any more variable
+        self->markToBeDeleted();
         delete self;
     }
 }
 
-bool SuperString::ConstUTF16BESequence::isToBeDeleted() const {
-    return this->_status == Status::ToBeDestructed;
+bool SuperString::ConcatenationSequence::isToBeDeleted() const {
+    return this->isMarkedToBeDeleted();
 }
 
-//*-- SuperString::CopyUTF16BESequence (internal)
-SuperString::CopyUTF16BESequence::CopyUTF16BESequence(const SuperString::Byte *bytes) {
-    Pair<std::size_t, std::size_t> lengthAndMemoryLength = SuperString::UTF16BE::lengthAndMemoryLength(bytes);
-    this->_length = lengthAndMemoryLength.first();
-    this->_memoryLength = lengthAndMemoryLength.second();
-    this->_data = new Byte[this->_memoryLength];
-    std::copy_n(bytes, this->_memoryLength, this->_data);
+//*-- MultipleSequence (internal)
+SuperString::MultipleSequence::MultipleSequence(const StringSequence *sequence, std::size_t time) {
+    this->_time = time;
+    this->_sequence = sequence;
+    this->_referencer._sequence = this;
+    this->_sequence->addReferencer(&this->_referencer);
+    this->_summary = this->summarize();
 }
 
-SuperString::CopyUTF16BESequence::CopyUTF16BESequence(const SuperString::ConstUTF16BESequence *sequence) {
-    Pair<std::size_t, std::size_t> lengthAndMemoryLength = SuperString::UTF16BE::lengthAndMemoryLength(sequence->_bytes);
-    this->_length = lengthAndMemoryLength.first();
-    this->_memoryLength = lengthAndMemoryLength.second();
-    this->_data = new Byte[this->_memoryLength];
-    std::copy_n(sequence->_bytes, this->_memoryLength, this->_data);
+SuperString::MultipleSequence::~MultipleSequence() {
+    this->reconstructReferencers();
+    this->_sequence->removeReferencer(&this->_referencer);
+    this->_sequence->collect();
 }
 
-SuperString::CopyUTF16BESequence::~CopyUTF16BESequence() {
-    this->reconstructReferencers();
-    delete this->_data;
+SuperString::Summary SuperString::MultipleSequence::summarize() const {
+    Summary summary;
+    summary._length = this->_sequence->length() * this->_time;
+    summary._memoryLength = this->_sequence->memoryLength();
+    summary._depth = this->_sequence->depth() + 1;
+    return summary;
 }
 
-std::size_t SuperString::CopyUTF16BESequence::length() const {
-    return this->_length;
+std::uint64_t SuperString::MultipleSequence::computeHash() const {
+    const StringSequence *sequence = this->_sequence;
+    return SuperString::Hash::repeat(sequence->hash(), sequence->length(), this->_time);
 }
 
-SuperString::Result<int, SuperString::Error>
-SuperString::CopyUTF16BESequence::codeUnitAt(std::size_t index) const {
+SuperString::Result<int, SuperString::Error> SuperString::MultipleSequence::codeUnitAt(std::size_t index) const {
     if(index < this->length()) {
-        return SuperString::UTF16BE::codeUnitAt(this->_data, index);
+        return this->_sequence->codeUnitAt(
+                index % this->_sequence->length());
     }
-    return Result<int, SuperString::Error>(Error::RangeError);
+    return Result<int, Error>(Error::RangeError);
+}
+
+SuperString::Piece SuperString::MultipleSequence::pieceAt(std::size_t index) const {
+    std::size_t unitLength = this->_sequence->length();
+    std::size_t startIndex = index - index % unitLength;
+    return Piece(this->_sequence, startIndex, startIndex + unitLength, 0);
 }
 
 SuperString::Result<SuperString, SuperString::Error>
-SuperString::CopyUTF16BESequence::substring(std::size_t startIndex, std::size_t endIndex) const {
-    // TODO: General code, specify + repeated * times
-    if(this->length() < startIndex || this->length() < endIndex) {
+SuperString::MultipleSequence::substring(std::size_t startIndex,
+                                         std::size_t endIndex) const {
+    std::size_t length = this->length();
+    if(length < startIndex || length < endIndex) {
         return Result<SuperString, Error>(Error::RangeError);
     }
     SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
     return Result<SuperString, Error>(SuperString(sequence));
 }
 
-bool SuperString::CopyUTF16BESequence::print(std::ostream &stream) const {
-    SuperString::UTF16BE::print(stream, this->_data, this->length());
+bool SuperString::MultipleSequence::print(std::ostream &stream) const {
+    for(std::size_t i = 0; i < this->_time; i++) {
+        this->_sequence->print(stream);
+    }
     return true;
 }
 
-bool SuperString::CopyUTF16BESequence::print(std::ostream &stream, std::size_t startIndex,
-                                                          std::size_t endIndex) const {
-    std::size_t length = this->length();
-    if(length < startIndex || length < endIndex) {
-        return false;
+bool SuperString::MultipleSequence::print(std::ostream &stream, std::size_t startIndex,
+                                                       std::size_t endIndex) const {
+    bool printing = false;
+    std::size_t unitLength = this->_sequence->length();
+    for(std::size_t i = 0; i < this->_time; i++) {
+        std::size_t iterationStartIndex = i * unitLength;
+        std::size_t iterationEndIndex = (i + 1) * unitLength;
+        if(!printing) {
+            if(iterationStartIndex <= startIndex) {
+                if(endIndex < iterationEndIndex) {
+                    this->_sequence->print(stream, startIndex - iterationStartIndex,
+                                                                endIndex - iterationStartIndex);
+                    break;
+                } else {
+                    printing = true;
+                    this->_sequence->print(stream, startIndex - iterationStartIndex,
+                                                                unitLength);
+                }
+            }
+        } else {
+            if(endIndex <= iterationEndIndex) {
+                this->_sequence->print(stream, 0, endIndex - iterationStartIndex);
+            } else {
+                this->_sequence->print(stream);
+            }
+        }
+    }
+    return true;
+}
+
+bool SuperString::MultipleSequence::forEachChunk(const SuperString::ChunkCallback &callback, std::size_t startIndex,
+                                                 std::size_t endIndex) const {
+    // each repetition comes out as its own chunks
+    std::size_t unitLength = this->_sequence->length();
+    if(unitLength == 0) {
+        return true;
+    }
+    for(std::size_t i = startIndex / unitLength; i * unitLength < endIndex; i++) {
+        std::size_t iterationStartIndex = std::max(startIndex, i * unitLength) - i * unitLength;
+        std::size_t iterationEndIndex = std::min(endIndex, (i + 1) * unitLength) - i * unitLength;
+        if(!this->_sequence->forEachChunk(callback, iterationStartIndex, iterationEndIndex)) {
+            return false;
+        }
     }
-    SuperString::UTF16BE::print(stream, this->_data, startIndex, endIndex);
     return true;
 }
 
-SuperString SuperString::CopyUTF16BESequence::trim() const {
+SuperString SuperString::MultipleSequence::trim() const {
     // TODO: General code, specify
     std::size_t startIndex = 0;
     std::size_t endIndex = this->length();
@@ -891,13 +3688,13 @@ SuperString SuperString::CopyUTF16BESequence::trim() const {
         result = this->codeUnitAt(++startIndex);
     }
     result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
+    while(endIndex > startIndex && result.isOk() && SuperString::isWhiteSpace(result.ok())) {
         result = this->codeUnitAt(--endIndex - 1);
     }
     return this->substring(startIndex, endIndex).ok();
 }
 
-SuperString SuperString::CopyUTF16BESequence::trimLeft() const {
+SuperString SuperString::MultipleSequence::trimLeft() const {
     // TODO: General code, specify
     std::size_t startIndex = 0;
     Result<int, Error> result = this->codeUnitAt(startIndex);
@@ -907,7 +3704,7 @@ SuperString SuperString::CopyUTF16BESequence::trimLeft() const {
     return this->substring(startIndex, this->length()).ok();
 }
 
-SuperString SuperString::CopyUTF16BESequence::trimRight() const {
+SuperString SuperString::MultipleSequence::trimRight() const {
     // TODO: General code, specify
     std::size_t endIndex = this->length();
     Result<int, Error> result = this->codeUnitAt(endIndex - 1);
@@ -917,1013 +3714,1955 @@ SuperString SuperString::CopyUTF16BESequence::trimRight() const {
     return this->substring(0, endIndex).ok();
 }
 
-std::size_t SuperString::CopyUTF16BESequence::keepingCost() const {
-    std::size_t cost = sizeof(CopyUTF16BESequence) + this->_memoryLength;
-    return cost;
+std::size_t SuperString::MultipleSequence::keepingCost() const {
+    return sizeof(MultipleSequence); // the repeated sequence is charged to itself, it may be shared
 }
 
-void SuperString::CopyUTF16BESequence::doDelete() const {
-    CopyUTF16BESequence *self = ((CopyUTF16BESequence *) (std::size_t) this);
-    if(!self->isToBeDeleted()) {
-        self->_length = 0; // Just a trick, we don't want any more variable
-        delete self;
+std::size_t SuperString::MultipleSequence::reconstructionCost(const StringSequence *sequence) const {
+    return ReferenceStringSequence::compactionCost(sequence, 0, sequence->length());
+}
+
+void SuperString::MultipleSequence::reconstruct(const StringSequence *sequence) const {
+    MultipleSequence *self = ((MultipleSequence *) ((std::size_t) this));
+    if(sequence == self->_sequence) {
+        const StringSequence *compacted = ReferenceStringSequence::compact(sequence, 0, sequence->length());
+        sequence->removeReferencer(&self->_referencer);
+        sequence->collect();
+        self->_sequence = compacted;
+        compacted->addReferencer(&self->_referencer);
+        self->refreshSummary();
     }
 }
 
-bool SuperString::CopyUTF16BESequence::isToBeDeleted() const {
-    return this->_length == 0;
+void SuperString::MultipleSequence::flatten(const StringSequence *leaf) const {
+    MultipleSequence *self = ((MultipleSequence *) ((std::size_t) this));
+    const StringSequence *sequence = self->_sequence;
+    sequence->removeReferencer(&self->_referencer);
+    self->_time = 1;
+    self->_sequence = leaf;
+    leaf->addReferencer(&self->_referencer);
+    sequence->collect();
+    self->refreshSummary();
 }
 
-//*-- SuperString::ConstUTF32Sequence (internal)
-SuperString::ConstUTF32Sequence::ConstUTF32Sequence(const SuperString::Byte *bytes)
-        : _bytes(((const int *) bytes)),
-          _status(SuperString::ConstUTF32Sequence::Status::LengthNotComputed) {
-    // nothing go here
+void SuperString::MultipleSequence::doDelete() const {
+    MultipleSequence *self = ((MultipleSequence *) (std::size_t) this);
+    if(!self->isToBeDeleted()) {
+        self->markToBeDeleted();
+        delete self;
+    }
 }
 
-SuperString::ConstUTF32Sequence::~ConstUTF32Sequence() {
-    this->reconstructReferencers();
+bool SuperString::MultipleSequence::isToBeDeleted() const {
+    return this->isMarkedToBeDeleted();
 }
 
-std::size_t SuperString::ConstUTF32Sequence::length() const /*override*/ {
-    if(this->_status == Status::LengthNotComputed) {
-        ConstUTF32Sequence *self = ((ConstUTF32Sequence *) ((std::size_t) this)); // to keep this method `const`
-        self->_status = Status::LengthComputed;
-        self->_length = SuperString::UTF32::length(((const Byte *) this->_bytes));
-    }
-    return this->_length;
+//*-- SuperString::MappedSequence<T> (internal)
+template<class T>
+SuperString::MappedSequence<T>::MappedSequence(void *address, std::size_t size, std::size_t memoryLength)
+        : T((const Byte *) address, memoryLength),
+          _address(address),
+          _size(size) {
+    // nothing go here
 }
 
-SuperString::Result<int, SuperString::Error>
-SuperString::ConstUTF32Sequence::codeUnitAt(std::size_t index) const {
-    if(index < this->length()) {
-        return Result<int, SuperString::Error>(SuperString::UTF32::codeUnitAt(((const Byte *) this->_bytes), index));
-    }
-    return Result<int, SuperString::Error>(Error::RangeError);
+template<class T>
+SuperString::MappedSequence<T>::~MappedSequence() {
+    this->reconstructReferencers(); // while the text data is still mapped, the destructor of T comes after
+    ::munmap(this->_address, this->_size);
 }
 
-SuperString::Result<SuperString, SuperString::Error>
-SuperString::ConstUTF32Sequence::substring(std::size_t startIndex,
-                                           std::size_t endIndex) const {
-    // TODO: General code, specify + repeated * times
-    if(this->length() < startIndex || this->length() < endIndex) {
-        return Result<SuperString, Error>(Error::RangeError);
-    }
-    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
-    return Result<SuperString, Error>(SuperString(sequence));
+//*-- SuperString::UTF8Index (internal)
+SuperString::UTF8Index::UTF8Index()
+        : _checkpoints(NULL),
+          _lastIndex(0),
+          _lastOffset(0),
+          _status(SuperString::UTF8Index::Status::NotBuilt) {
+    // nothing go here
 }
 
-bool SuperString::ConstUTF32Sequence::print(std::ostream &stream) const {
-    SuperString::UTF32::print(stream, ((const Byte *) this->_bytes));
-    return true;
+SuperString::UTF8Index::~UTF8Index() {
+    delete[] this->_checkpoints;
 }
 
-bool SuperString::ConstUTF32Sequence::print(std::ostream &stream, std::size_t startIndex,
-                                                         std::size_t endIndex) const {
-    if(this->length() < startIndex || this->length() < endIndex) {
-        return false;
+std::size_t SuperString::UTF8Index::memoryLength(std::size_t length) const {
+    if(this->_status == Status::Built) {
+        return (length / STEP + 1) * sizeof(std::size_t);
     }
-    SuperString::UTF32::print(stream, ((Byte *) this->_bytes), startIndex, endIndex);
-    return true;
+    return 0;
 }
 
-SuperString SuperString::ConstUTF32Sequence::trim() const {
-    Pair<std::size_t, std::size_t> indexes = SuperString::UTF32::trim(((Byte *) this->_bytes), this->_length);
-    return this->substring(indexes.first(), indexes.second()).ok();
+std::size_t SuperString::UTF8Index::offset(const SuperString::Byte *bytes, std::size_t length,
+                                           std::size_t index) const {
+    UTF8Index *self = ((UTF8Index *) ((std::size_t) this)); // to keep this method `const`
+    if(self->_status == Status::NotBuilt) {
+        self->build(bytes, length);
+    }
+    if(self->_status == Status::Identity) {
+        return index;
+    }
+    std::size_t i = index - index % STEP;
+    std::size_t offset = self->_checkpoints[index / STEP];
+#ifndef SUPERSTRING_THREAD_SAFE
+    if(i <= self->_lastIndex && self->_lastIndex <= index) {
+        i = self->_lastIndex;
+        offset = self->_lastOffset;
+    }
+#endif
+    while(i < index) {
+        std::size_t sequenceLength = SuperString::UTF8::sequenceLength(*(bytes + offset));
+        offset += (sequenceLength == 0) ? 1 : sequenceLength;
+        i++;
+    }
+#ifndef SUPERSTRING_THREAD_SAFE
+    self->_lastIndex = index;
+    self->_lastOffset = offset;
+#endif
+    return offset;
+}
+
+void SuperString::UTF8Index::build(const SuperString::Byte *bytes, std::size_t length) {
+#ifdef SUPERSTRING_THREAD_SAFE
+    std::lock_guard<std::recursive_mutex> guard(sequencesMutex);
+    if(this->_status != Status::NotBuilt) {
+        return; // built by another thread meanwhile
+    }
+#endif
+    this->_checkpoints = new std::size_t[length / STEP + 1];
+    std::size_t offset = 0;
+    for(std::size_t i = 0; i < length; i++) {
+        if(i % STEP == 0) {
+            this->_checkpoints[i / STEP] = offset;
+        }
+        std::size_t sequenceLength = SuperString::UTF8::sequenceLength(*(bytes + offset));
+        offset += (sequenceLength == 0) ? 1 : sequenceLength;
+    }
+    if(length % STEP == 0) {
+        this->_checkpoints[length / STEP] = offset;
+    }
+    if(offset == length) {
+        delete[] this->_checkpoints;
+        this->_checkpoints = NULL;
+        this->_status = Status::Identity;
+    } else {
+        this->_status = Status::Built;
+    }
 }
 
-SuperString SuperString::ConstUTF32Sequence::trimLeft() const {
-    return this->substring(SuperString::UTF32::trimLeft(((Byte *) this->_bytes)), this->length()).ok();
-}
+//*-- Length scanning (internal)
+// Finds the terminator of text data while counting its code units, a block of 16 or 32 bytes at a time
+// on x86-64, with AVX2 when the running CPU has it. Blocks are read at aligned addresses, so reading
+// past the terminator never reaches another page, only bytes that the sanitizers don't know about.
 
-SuperString SuperString::ConstUTF32Sequence::trimRight() const {
-    return this->substring(0, SuperString::UTF32::trimRight(((Byte *) this->_bytes), this->length())).ok();
+#ifndef SUPERSTRING_SIMD
+// returns the offset of the UTF-8 terminator, and counts the bytes before it that aren't continuation bytes
+static std::size_t scanUTF8Scalar(const SuperString::Byte *bytes, std::size_t *count) {
+    const SuperString::Byte *pointer = bytes;
+    std::size_t leads = 0;
+    while(*pointer != 0x00) {
+        leads += (*pointer & 0xc0) != 0x80;
+        pointer++;
+    }
+    *count = leads;
+    return pointer - bytes;
 }
+#endif
 
-std::size_t SuperString::ConstUTF32Sequence::keepingCost() const {
-    return sizeof(ConstUTF32Sequence);
+// returns the offset of the UTF-16 terminator, and counts the high surrogates before it, [high] being the
+// offset of the high byte in a code unit, 0 in UTF-16BE and 1 in UTF-16LE
+static std::size_t scanUTF16Scalar(const SuperString::Byte *bytes, std::size_t *count, std::size_t high) {
+    const SuperString::Byte *pointer = bytes;
+    std::size_t surrogates = 0;
+    while(*pointer != 0x00 || *(pointer + 1) != 0x00) {
+        surrogates += (*(pointer + high) & 0xfc) == 0xd8;
+        pointer += 2;
+    }
+    *count = surrogates;
+    return pointer - bytes;
 }
 
-void SuperString::ConstUTF32Sequence::doDelete() const {
-    ConstUTF32Sequence *self = ((ConstUTF32Sequence *) (std::size_t) this);
-    if(!self->isToBeDeleted()) {
-        self->_status = Status::ToBeDestructed; // Just a trick, we don't want any more variable
-        delete self;
+// returns the offset of the UTF-32 terminator
+static std::size_t scanUTF32Scalar(const SuperString::Byte *bytes) {
+    const int *pointer = (const int *) bytes;
+    while(*pointer != 0x00) {
+        pointer++;
     }
+    return (const SuperString::Byte *) pointer - bytes;
 }
 
-bool SuperString::ConstUTF32Sequence::isToBeDeleted() const {
-    return this->_status == Status::ToBeDestructed;
-}
+#ifdef SUPERSTRING_SIMD
+#define SUPERSTRING_SCAN __attribute__((no_sanitize("address", "thread")))
+#define SUPERSTRING_SCAN_AVX2 __attribute__((no_sanitize("address", "thread"), target("avx2,popcnt")))
 
-//*-- SuperString::CopyUTF32Sequence (internal)
-SuperString::CopyUTF32Sequence::CopyUTF32Sequence(const SuperString::Byte *bytes) {
-    this->_length = SuperString::UTF32::length(bytes);
-    this->_data = new int[this->_length + 1];
-    std::copy_n(bytes, this->_length + 1, this->_data);
+static bool hasAVX2() {
+    static const bool hasAVX2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") &&
+                                                       __builtin_cpu_supports("popcnt"));
+    return hasAVX2;
 }
 
-SuperString::CopyUTF32Sequence::CopyUTF32Sequence(const SuperString::ConstUTF32Sequence *sequence) {
-    this->_length = SuperString::UTF32::length(((const Byte *) sequence->_bytes));
-    this->_data = new int[this->_length + 1];
-    std::copy_n(sequence->_bytes, this->_length + 1, this->_data);
+// [matches] holds one bit per byte of a block, [zeros] those of the terminator, counts the matches before it
+static inline std::size_t countBefore(unsigned matches, unsigned zeros) {
+    return __builtin_popcount(matches & ((zeros & -zeros) - 1));
 }
 
-SuperString::CopyUTF32Sequence::~CopyUTF32Sequence() {
-    this->reconstructReferencers();
-    delete this->_data;
+// per-byte counters are summed every 255 blocks, before they overflow
+SUPERSTRING_SCAN static std::size_t sumCounters(__m128i counters) {
+    __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+    sums = _mm_add_epi64(sums, _mm_unpackhi_epi64(sums, sums));
+    return (std::size_t) _mm_cvtsi128_si64(sums);
 }
 
-std::size_t SuperString::CopyUTF32Sequence::length() const {
-    return this->_length;
+SUPERSTRING_SCAN_AVX2 static std::size_t sumCounters(__m256i counters) {
+    __m256i sums = _mm256_sad_epu8(counters, _mm256_setzero_si256());
+    __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    halves = _mm_add_epi64(halves, _mm_unpackhi_epi64(halves, halves));
+    return (std::size_t) _mm_cvtsi128_si64(halves);
 }
 
-SuperString::Result<int, SuperString::Error> SuperString::CopyUTF32Sequence::codeUnitAt(
-        std::size_t index) const {
-    if(index < this->length()) {
-        return Result<int, SuperString::Error>(SuperString::UTF32::codeUnitAt(((const Byte *) this->_data), index));
+SUPERSTRING_SCAN static std::size_t scanUTF8SSE2(const SuperString::Byte *bytes, std::size_t *count) {
+    const SuperString::Byte *block = (const SuperString::Byte *) ((std::uintptr_t) bytes & ~(std::uintptr_t) 15);
+    unsigned ignored = (1u << (bytes - block)) - 1; // bytes before the data
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i continuation = _mm_set1_epi8((char) 0xbf); // continuation bytes are the lowest signed ones
+    std::size_t leads = 0;
+    while(true) {
+        __m128i counters = _mm_setzero_si128();
+        for(int i = 0; i < 255; i++, block += 16) {
+            __m128i data = _mm_load_si128((const __m128i *) block);
+            __m128i isLead = _mm_cmpgt_epi8(data, continuation);
+            unsigned zeros = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(data, zero)) & ~ignored;
+            if(zeros != 0) {
+                leads += sumCounters(counters);
+                leads += countBefore((unsigned) _mm_movemask_epi8(isLead) & ~ignored, zeros);
+                *count = leads;
+                return block + __builtin_ctz(zeros) - bytes;
+            }
+            if(ignored != 0) {
+                leads += __builtin_popcount((unsigned) _mm_movemask_epi8(isLead) & ~ignored);
+                ignored = 0;
+            } else {
+                counters = _mm_sub_epi8(counters, isLead);
+            }
+        }
+        leads += sumCounters(counters);
+    }
+}
+
+SUPERSTRING_SCAN_AVX2 static std::size_t scanUTF8AVX2(const SuperString::Byte *bytes, std::size_t *count) {
+    const SuperString::Byte *block = (const SuperString::Byte *) ((std::uintptr_t) bytes & ~(std::uintptr_t) 31);
+    unsigned ignored = (unsigned) ((1ull << (bytes - block)) - 1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i continuation = _mm256_set1_epi8((char) 0xbf);
+    std::size_t leads = 0;
+    while(true) {
+        __m256i counters = _mm256_setzero_si256();
+        for(int i = 0; i < 255; i++, block += 32) {
+            __m256i data = _mm256_load_si256((const __m256i *) block);
+            __m256i isLead = _mm256_cmpgt_epi8(data, continuation);
+            unsigned zeros = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(data, zero)) & ~ignored;
+            if(zeros != 0) {
+                leads += sumCounters(counters);
+                leads += countBefore((unsigned) _mm256_movemask_epi8(isLead) & ~ignored, zeros);
+                *count = leads;
+                return block + __builtin_ctz(zeros) - bytes;
+            }
+            if(ignored != 0) {
+                leads += __builtin_popcount((unsigned) _mm256_movemask_epi8(isLead) & ~ignored);
+                ignored = 0;
+            } else {
+                counters = _mm256_sub_epi8(counters, isLead);
+            }
+        }
+        leads += sumCounters(counters);
+    }
+}
+
+// the data is 2-byte aligned, so code units don't straddle blocks, each has two bits in the masks
+SUPERSTRING_SCAN static std::size_t scanUTF16SSE2(const SuperString::Byte *bytes, std::size_t *count,
+                                                  std::size_t high) {
+    const SuperString::Byte *block = (const SuperString::Byte *) ((std::uintptr_t) bytes & ~(std::uintptr_t) 15);
+    unsigned ignored = (1u << (bytes - block)) - 1;
+    const __m128i zero = _mm_setzero_si128();
+    // the first byte in memory is the low one of a lane
+    const __m128i highMask = _mm_set1_epi16((short) (0x00fc << (8 * high)));
+    const __m128i highSurrogate = _mm_set1_epi16((short) (0x00d8 << (8 * high)));
+    std::size_t surrogates = 0;
+    for(;; block += 16) {
+        __m128i data = _mm_load_si128((const __m128i *) block);
+        unsigned zeros = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi16(data, zero)) & ~ignored;
+        unsigned highs = (unsigned) _mm_movemask_epi8(
+                _mm_cmpeq_epi16(_mm_and_si128(data, highMask), highSurrogate)) & ~ignored;
+        if(zeros != 0) {
+            *count = surrogates + countBefore(highs, zeros) / 2;
+            return block + __builtin_ctz(zeros) - bytes;
+        }
+        surrogates += __builtin_popcount(highs) / 2;
+        ignored = 0;
+    }
+}
+
+SUPERSTRING_SCAN_AVX2 static std::size_t scanUTF16AVX2(const SuperString::Byte *bytes, std::size_t *count,
+                                                       std::size_t high) {
+    const SuperString::Byte *block = (const SuperString::Byte *) ((std::uintptr_t) bytes & ~(std::uintptr_t) 31);
+    unsigned ignored = (unsigned) ((1ull << (bytes - block)) - 1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i highMask = _mm256_set1_epi16((short) (0x00fc << (8 * high)));
+    const __m256i highSurrogate = _mm256_set1_epi16((short) (0x00d8 << (8 * high)));
+    std::size_t surrogates = 0;
+    for(;; block += 32) {
+        __m256i data = _mm256_load_si256((const __m256i *) block);
+        unsigned zeros = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi16(data, zero)) & ~ignored;
+        unsigned highs = (unsigned) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi16(_mm256_and_si256(data, highMask), highSurrogate)) & ~ignored;
+        if(zeros != 0) {
+            *count = surrogates + countBefore(highs, zeros) / 2;
+            return block + __builtin_ctz(zeros) - bytes;
+        }
+        surrogates += __builtin_popcount(highs) / 2;
+        ignored = 0;
     }
-    return Result<int, SuperString::Error>(Error::RangeError);
 }
 
-SuperString::Result<SuperString, SuperString::Error>
-SuperString::CopyUTF32Sequence::substring(std::size_t startIndex,
-                                          std::size_t endIndex) const {
-    // TODO: General code, specify + repeated * times
-    if(this->length() < startIndex || this->length() < endIndex) {
-        return Result<SuperString, Error>(Error::RangeError);
+// the data is 4-byte aligned
+SUPERSTRING_SCAN static std::size_t scanUTF32SSE2(const SuperString::Byte *bytes) {
+    const SuperString::Byte *block = (const SuperString::Byte *) ((std::uintptr_t) bytes & ~(std::uintptr_t) 15);
+    unsigned ignored = (1u << (bytes - block)) - 1;
+    const __m128i zero = _mm_setzero_si128();
+    for(;; block += 16) {
+        __m128i data = _mm_load_si128((const __m128i *) block);
+        unsigned zeros = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi32(data, zero)) & ~ignored;
+        if(zeros != 0) {
+            return block + __builtin_ctz(zeros) - bytes;
+        }
+        ignored = 0;
     }
-    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
-    return Result<SuperString, Error>(SuperString(sequence));
-}
-
-bool SuperString::CopyUTF32Sequence::print(std::ostream &stream) const {
-    SuperString::UTF32::print(stream, ((const Byte *) this->_data));
-    return true;
 }
 
-bool SuperString::CopyUTF32Sequence::print(std::ostream &stream, std::size_t startIndex,
-                                                        std::size_t endIndex) const {
-    if(this->length() < startIndex || this->length() < endIndex) {
-        return false;
+SUPERSTRING_SCAN_AVX2 static std::size_t scanUTF32AVX2(const SuperString::Byte *bytes) {
+    const SuperString::Byte *block = (const SuperString::Byte *) ((std::uintptr_t) bytes & ~(std::uintptr_t) 31);
+    unsigned ignored = (unsigned) ((1ull << (bytes - block)) - 1);
+    const __m256i zero = _mm256_setzero_si256();
+    for(;; block += 32) {
+        __m256i data = _mm256_load_si256((const __m256i *) block);
+        unsigned zeros = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi32(data, zero)) & ~ignored;
+        if(zeros != 0) {
+            return block + __builtin_ctz(zeros) - bytes;
+        }
+        ignored = 0;
     }
-    SuperString::UTF32::print(stream, ((const Byte *) this->_data), startIndex, endIndex);
-    return true;
-}
-
-SuperString SuperString::CopyUTF32Sequence::trim() const {
-    Pair<std::size_t, std::size_t> indexes = SuperString::UTF32::trim(((const Byte *) this->_data), this->_length);
-    return this->substring(indexes.first(), indexes.second()).ok();
 }
+#endif
 
-SuperString SuperString::CopyUTF32Sequence::trimLeft() const {
-    return this->substring(SuperString::UTF32::trimLeft(((const Byte *) this->_data)), this->length()).ok();
-}
-
-SuperString SuperString::CopyUTF32Sequence::trimRight() const {
-    return this->substring(0, SuperString::UTF32::trimRight(((const Byte *) this->_data), this->length())).ok();
+static std::size_t scanUTF8(const SuperString::Byte *bytes, std::size_t *count) {
+#ifdef SUPERSTRING_SIMD
+    return hasAVX2() ? scanUTF8AVX2(bytes, count) : scanUTF8SSE2(bytes, count);
+#else
+    return scanUTF8Scalar(bytes, count);
+#endif
 }
 
-std::size_t SuperString::CopyUTF32Sequence::keepingCost() const {
-    std::size_t cost = sizeof(CopyASCIISequence);
-    if(this->_data != NULL) {
-        cost += this->length() + 1;
+static std::size_t scanUTF16(const SuperString::Byte *bytes, std::size_t *count, std::size_t high) {
+#ifdef SUPERSTRING_SIMD
+    if(((std::uintptr_t) bytes & 1) == 0) {
+        return hasAVX2() ? scanUTF16AVX2(bytes, count, high) : scanUTF16SSE2(bytes, count, high);
     }
-    return cost;
+#endif
+    return scanUTF16Scalar(bytes, count, high);
 }
 
-void SuperString::CopyUTF32Sequence::doDelete() const {
-    CopyUTF32Sequence *self = ((CopyUTF32Sequence *) (std::size_t) this);
-    if(!self->isToBeDeleted()) {
-        self->_length = 0; // Just a trick, we don't want any more variable
-        delete self;
+static std::size_t scanUTF32(const SuperString::Byte *bytes) {
+#ifdef SUPERSTRING_SIMD
+    if(((std::uintptr_t) bytes & 3) == 0) {
+        return hasAVX2() ? scanUTF32AVX2(bytes) : scanUTF32SSE2(bytes);
     }
+#endif
+    return scanUTF32Scalar(bytes);
 }
 
-bool SuperString::CopyUTF32Sequence::isToBeDeleted() const {
-    return this->_length == 0;
-}
-
-//*-- SuperString::SubstringSequence (internal)
-SuperString::SubstringSequence::SubstringSequence(const StringSequence *sequence, std::size_t startIndex,
-                                                  std::size_t endIndex) {
-    this->_kind = Kind::SUBSTRING;
-    this->_container._substring._sequence = sequence;
-    this->_container._substring._startIndex = startIndex;
-    this->_container._substring._endIndex = endIndex;
-    this->_container._substring._sequence->addReferencer(this);
-}
+//*-- Validation (internal)
+// Checks UTF-8 data against the well-formed byte sequences of Unicode, 32 bytes at a time with AVX2
+// by looking up each pair of consecutive bytes in three nibble tables (Keiser and Lemire), and a
+// byte at a time otherwise. The offset of an error is found again by the byte at a time check,
+// from the last character boundary before the block that failed.
 
-SuperString::SubstringSequence::~SubstringSequence() {
-    switch(this->kind()) {
-        case Kind::SUBSTRING:
-            this->_container._substring._sequence->removeReferencer(this);
-            if(this->_container._substring._sequence->refCount() == 0 &&
-               this->_container._substring._sequence->freeingCost() <
-               this->_container._substring._sequence->keepingCost()) {
-                this->_container._substring._sequence->doDelete();
-            }
+// checks UTF-8 from [from], a character boundary within [bytes], and counts the characters from there,
+// returns the offset of the terminator, or of the first ill-formed sequence with [isValid] set to false
+static std::size_t validateUTF8Scalar(const SuperString::Byte *bytes, const SuperString::Byte *from,
+                                      std::size_t *count, bool *isValid) {
+    const SuperString::Byte *pointer = from;
+    std::size_t characters = 0;
+    while(*pointer != 0x00) {
+        SuperString::Byte lead = *pointer;
+        if(lead < 0x80) {
+            pointer++;
+            characters++;
+            continue;
+        }
+        std::size_t continuations;
+        SuperString::Byte low = 0x80, high = 0xbf; // range of the first continuation byte
+        if(0xc2 <= lead && lead <= 0xdf) {
+            continuations = 1;
+        } else if(0xe0 <= lead && lead <= 0xef) {
+            continuations = 2;
+            low = (lead == 0xe0) ? 0xa0 : low; // overlong
+            high = (lead == 0xed) ? 0x9f : high; // surrogates
+        } else if(0xf0 <= lead && lead <= 0xf4) {
+            continuations = 3;
+            low = (lead == 0xf0) ? 0x90 : low; // overlong
+            high = (lead == 0xf4) ? 0x8f : high; // above U+10FFFF
+        } else {
+            break;
+        }
+        if(*(pointer + 1) < low || high < *(pointer + 1)) {
             break;
-        case Kind::RECONSTRUCTED:
-            delete this->_container._reconstructed._data;
+        }
+        std::size_t i = 2;
+        while(i <= continuations && (*(pointer + i) & 0xc0) == 0x80) { // stops at the terminator
+            i++;
+        }
+        if(i <= continuations) {
             break;
+        }
+        pointer += continuations + 1;
+        characters++;
     }
+    *count = characters;
+    *isValid = *pointer == 0x00;
+    return pointer - bytes;
 }
 
-SuperString::SubstringSequence::Kind SuperString::SubstringSequence::kind() const {
-    return (Kind) (((char) this->_kind) & 0b01111111);
+#ifdef SUPERSTRING_SIMD
+// error bits of the tables, a pair of bytes is ill-formed when a bit is set in all three lookups
+static const char UTF8_TOO_SHORT = 1 << 0; // a lead byte not followed by a continuation byte
+static const char UTF8_TOO_LONG = 1 << 1; // a continuation byte after an ASCII byte
+static const char UTF8_OVERLONG_3 = 1 << 2;
+static const char UTF8_TOO_LARGE = 1 << 3; // above U+10FFFF
+static const char UTF8_SURROGATE = 1 << 4;
+static const char UTF8_OVERLONG_2 = 1 << 5;
+static const char UTF8_TOO_LARGE_1000 = 1 << 6;
+static const char UTF8_OVERLONG_4 = 1 << 6;
+static const char UTF8_TWO_CONTINUATIONS = (char) (1 << 7); // expected only where a third or fourth byte goes
+static const char UTF8_CARRY = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTINUATIONS;
+
+SUPERSTRING_SCAN_AVX2 static __m256i lookupNibbles(__m256i nibbles, char t0, char t1, char t2, char t3, char t4,
+                                                   char t5, char t6, char t7, char t8, char t9, char t10,
+                                                   char t11, char t12, char t13, char t14, char t15) {
+    __m128i table = _mm_setr_epi8(t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15);
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(table), nibbles);
+}
+
+// returns the errors of the pairs of bytes ending in [data], preceded by [previous]
+SUPERSTRING_SCAN_AVX2 static __m256i checkUTF8Block(__m256i data, __m256i previous) {
+    const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+    __m256i shifted = _mm256_permute2x128_si256(previous, data, 0x21);
+    __m256i previous1 = _mm256_alignr_epi8(data, shifted, 15);
+    __m256i previous2 = _mm256_alignr_epi8(data, shifted, 14);
+    __m256i previous3 = _mm256_alignr_epi8(data, shifted, 13);
+    __m256i byte1High = lookupNibbles(_mm256_and_si256(_mm256_srli_epi16(previous1, 4), lowNibble),
+            UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+            UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+            UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS,
+            UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+            UTF8_TOO_SHORT,
+            UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+            UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+    __m256i byte1Low = lookupNibbles(_mm256_and_si256(previous1, lowNibble),
+            UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+            UTF8_CARRY | UTF8_OVERLONG_2,
+            UTF8_CARRY,
+            UTF8_CARRY,
+            UTF8_CARRY | UTF8_TOO_LARGE,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+            UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+    __m256i byte2High = lookupNibbles(_mm256_and_si256(_mm256_srli_epi16(data, 4), lowNibble),
+            UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+            UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+            UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 |
+            UTF8_OVERLONG_4,
+            UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+            UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+            UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+            UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+    // third and fourth bytes must be continuation bytes, that the lookups can't tell
+    __m256i isThird = _mm256_subs_epu8(previous2, _mm256_set1_epi8((char) (0xe0 - 0x80)));
+    __m256i isFourth = _mm256_subs_epu8(previous3, _mm256_set1_epi8((char) (0xf0 - 0x80)));
+    __m256i mustContinue = _mm256_and_si256(_mm256_or_si256(isThird, isFourth), _mm256_set1_epi8((char) 0x80));
+    return _mm256_xor_si256(mustContinue, special);
+}
+
+SUPERSTRING_SCAN_AVX2 static std::size_t validateUTF8AVX2(const SuperString::Byte *bytes, std::size_t *count,
+                                                          bool *isValid) {
+    const SuperString::Byte *block = (const SuperString::Byte *) ((std::uintptr_t) bytes & ~(std::uintptr_t) 31);
+    int startOffset = (int) (bytes - block);
+    unsigned ignored = (unsigned) ((1ull << startOffset) - 1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i positions = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+                                               19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    // a character isn't complete at the end of a block whose last bytes are above these
+    const __m256i incompleteLimits = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                      (char) (0xf0 - 1), (char) (0xe0 - 1), (char) (0xc0 - 1));
+    __m256i previous = zero, incomplete = zero, errors = zero;
+    std::size_t leads = 0;
+    for(;; block += 32) {
+        __m256i data = _mm256_load_si256((const __m256i *) block);
+        unsigned zeros = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(data, zero)) & ~ignored;
+        unsigned kept = ~ignored;
+        if(ignored != 0) { // bytes before the data are read as ASCII
+            data = _mm256_and_si256(data, _mm256_cmpgt_epi8(positions, _mm256_set1_epi8((char) (startOffset - 1))));
+        }
+        if(zeros != 0) { // and so are those after the terminator
+            int terminatorOffset = __builtin_ctz(zeros);
+            data = _mm256_and_si256(data, _mm256_cmpgt_epi8(_mm256_set1_epi8((char) terminatorOffset), positions));
+            kept &= (unsigned) ((1ull << terminatorOffset) - 1);
+        }
+        if(_mm256_movemask_epi8(data) == 0) {
+            errors = _mm256_or_si256(errors, incomplete);
+            incomplete = zero;
+        } else {
+            errors = _mm256_or_si256(errors, checkUTF8Block(data, previous));
+            incomplete = _mm256_subs_epu8(data, incompleteLimits);
+        }
+        if(!_mm256_testz_si256(errors, errors)) {
+            // the data before the block is well-formed, but maybe for its last character
+            const SuperString::Byte *start = (block < bytes) ? bytes : block, *from = start;
+            for(int i = 0; i < 4 && bytes < from; i++) {
+                from--;
+                if((*from & 0xc0) != 0x80) {
+                    break;
+                }
+            }
+            for(const SuperString::Byte *pointer = from; pointer < start; pointer++) {
+                leads -= (*pointer & 0xc0) != 0x80;
+            }
+            std::size_t offset = validateUTF8Scalar(bytes, from, count, isValid);
+            *count += leads;
+            return offset;
+        }
+        leads += __builtin_popcount(
+                (unsigned) _mm256_movemask_epi8(_mm256_cmpgt_epi8(data, _mm256_set1_epi8((char) 0xbf))) & kept);
+        if(zeros != 0) {
+            *count = leads;
+            *isValid = true;
+            return block + __builtin_ctz(zeros) - bytes;
+        }
+        previous = data;
+        ignored = 0;
+    }
 }
+#endif
 
-std::size_t SuperString::SubstringSequence::length() const /*override*/ {
-    switch(this->kind()) {
-        case Kind::SUBSTRING:
-            return this->_container._substring._endIndex - this->_container._substring._startIndex;
-        case Kind::RECONSTRUCTED:
-            return this->_container._reconstructed._length;
+static std::size_t validateUTF8(const SuperString::Byte *bytes, std::size_t *count, bool *isValid) {
+#ifdef SUPERSTRING_SIMD
+    if(hasAVX2()) {
+        return validateUTF8AVX2(bytes, count, isValid);
     }
+#endif
+    return validateUTF8Scalar(bytes, bytes, count, isValid);
 }
 
-SuperString::Result<int, SuperString::Error> SuperString::SubstringSequence::codeUnitAt(
-        std::size_t index) const {
-    if(index < this->length()) {
-        switch(this->kind()) {
-            case Kind::SUBSTRING:
-                return this->_container._substring._sequence->codeUnitAt(
-                        this->_container._substring._startIndex + index);
-            case Kind::RECONSTRUCTED:
-                return Result<int, SuperString::Error>(*(this->_container._reconstructed._data + index));
-        }
+SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+SuperString::validate(const SuperString::Byte *bytes, SuperString::Encoding encoding) {
+    switch(encoding) {
+        case Encoding::ASCII:
+            return SuperString::ASCII::validate(bytes);
+        case Encoding::UTF8:
+            return SuperString::UTF8::validate(bytes);
+        case Encoding::UTF16BE:
+            return SuperString::UTF16BE::validate(bytes);
+        case Encoding::UTF32:
+            return SuperString::UTF32::validate(bytes);
+        case Encoding::UTF16LE:
+            return SuperString::UTF16LE::validate(bytes);
     }
-    return Result<int, SuperString::Error>(Error::RangeError);
+    return Result<Pair<std::size_t, std::size_t>, std::size_t>((std::size_t) 0);
 }
 
-SuperString::Result<SuperString, SuperString::Error>
-SuperString::SubstringSequence::substring(std::size_t startIndex, std::size_t endIndex) const {
-    switch(this->kind()) {
-        case Kind::SUBSTRING:
-            if((this->_container._substring._sequence->length() <
-                (this->_container._substring._startIndex + startIndex)) ||
-               (this->_container._substring._sequence->length() <
-                (this->_container._substring._startIndex + endIndex))) {
-                return Result<SuperString, Error>(Error::RangeError);
-            } else {
-                return Result<SuperString, Error>(
-                        SuperString(new SubstringSequence(this->_container._substring._sequence,
-                                                          this->_container._substring._startIndex +
-                                                          startIndex,
-                                                          this->_container._substring._startIndex +
-                                                          endIndex)));
-            }
-        case Kind::RECONSTRUCTED:
-            // TODO: General code, specify + repeated * times
-            if(this->length() < startIndex || this->length() < endIndex) {
-                return Result<SuperString, Error>(Error::RangeError);
+//*-- Byte search (internal)
+// Needles up to SHORT_NEEDLE bytes are searched by comparing their first and last bytes to a block
+// of candidate positions at once, and checking the rest only where both match. Longer ones use the
+// Two-Way algorithm of Crochemore and Perrin, linear in the worst case, that skips by the last byte
+// of the window as in Horspool, sublinear on average.
+
+static const std::size_t SHORT_NEEDLE = 32;
+
+#ifdef SUPERSTRING_SIMD
+SUPERSTRING_SCAN_AVX2 static std::size_t searchShortAVX2(const SuperString::Byte *haystack, std::size_t length,
+                                                         const SuperString::Byte *needle, std::size_t needleLength) {
+    const __m256i first = _mm256_set1_epi8((char) needle[0]);
+    const __m256i last = _mm256_set1_epi8((char) needle[needleLength - 1]);
+    std::size_t i = 0;
+    for(; i + needleLength - 1 + 32 <= length; i += 32) {
+        __m256i blockFirst = _mm256_loadu_si256((const __m256i *) (haystack + i));
+        __m256i blockLast = _mm256_loadu_si256((const __m256i *) (haystack + i + needleLength - 1));
+        unsigned candidates = (unsigned) _mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last)));
+        while(candidates != 0) {
+            std::size_t offset = i + __builtin_ctz(candidates);
+            if(std::memcmp(haystack + offset + 1, needle + 1, needleLength - 2) == 0) {
+                return offset;
             }
-            SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
-            return Result<SuperString, Error>(SuperString(sequence));
+            candidates &= candidates - 1;
+        }
+    }
+    for(; i + needleLength <= length; i++) {
+        if(haystack[i] == needle[0] && std::memcmp(haystack + i + 1, needle + 1, needleLength - 1) == 0) {
+            return i;
+        }
     }
+    return length;
 }
 
-bool SuperString::SubstringSequence::print(std::ostream &stream) const {
-    switch(this->kind()) {
-        case Kind::SUBSTRING:
-            return this->_container._substring._sequence->print(stream, this->_container._substring._startIndex,
-                                                                this->_container._substring._endIndex);
-        case Kind::RECONSTRUCTED:
-            SuperString::UTF32::print(stream, ((Byte *) this->_container._reconstructed._data));
-            return true;
+SUPERSTRING_SCAN static std::size_t searchShortSSE2(const SuperString::Byte *haystack, std::size_t length,
+                                                    const SuperString::Byte *needle, std::size_t needleLength) {
+    const __m128i first = _mm_set1_epi8((char) needle[0]);
+    const __m128i last = _mm_set1_epi8((char) needle[needleLength - 1]);
+    std::size_t i = 0;
+    for(; i + needleLength - 1 + 16 <= length; i += 16) {
+        __m128i blockFirst = _mm_loadu_si128((const __m128i *) (haystack + i));
+        __m128i blockLast = _mm_loadu_si128((const __m128i *) (haystack + i + needleLength - 1));
+        unsigned candidates = (unsigned) _mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+        while(candidates != 0) {
+            std::size_t offset = i + __builtin_ctz(candidates);
+            if(std::memcmp(haystack + offset + 1, needle + 1, needleLength - 2) == 0) {
+                return offset;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    for(; i + needleLength <= length; i++) {
+        if(haystack[i] == needle[0] && std::memcmp(haystack + i + 1, needle + 1, needleLength - 1) == 0) {
+            return i;
+        }
     }
+    return length;
 }
-
-bool SuperString::SubstringSequence::print(std::ostream &stream, std::size_t startIndex,
-                                                        std::size_t endIndex) const {
-    switch(this->kind()) {
-        case Kind::SUBSTRING:
-            return this->_container._substring._sequence->print(stream,
-                                                                this->_container._substring._startIndex + startIndex,
-                                                                this->_container._substring._startIndex + endIndex);
-        case Kind::RECONSTRUCTED:
-            SuperString::UTF32::print(stream, ((Byte *) this->_container._reconstructed._data), startIndex, endIndex);
-            return true;
+#endif
+
+// the needle has between 2 and SHORT_NEEDLE bytes, returns [length] when not found
+static std::size_t searchShort(const SuperString::Byte *haystack, std::size_t length, const SuperString::Byte *needle,
+                               std::size_t needleLength) {
+#ifdef SUPERSTRING_SIMD
+    return hasAVX2() ? searchShortAVX2(haystack, length, needle, needleLength)
+                     : searchShortSSE2(haystack, length, needle, needleLength);
+#else
+    const SuperString::Byte *pointer = haystack, *end = haystack + length - needleLength + 1;
+    while(pointer < end && (pointer = (const SuperString::Byte *) std::memchr(pointer, needle[0], end - pointer)) != NULL) {
+        if(pointer[needleLength - 1] == needle[needleLength - 1] &&
+           std::memcmp(pointer + 1, needle + 1, needleLength - 2) == 0) {
+            return pointer - haystack;
+        }
+        pointer++;
+    }
+    return length;
+#endif
+}
+
+// splits [needle] into a left and a right part, returns the length of the left one and the period of the right one
+static std::size_t criticalFactorization(const SuperString::Byte *needle, std::size_t needleLength,
+                                         std::size_t *period) {
+    std::size_t suffixes[2], periods[2];
+    for(int order = 0; order < 2; order++) { // the maximal suffix for both byte orders
+        std::size_t maximalSuffix = (std::size_t) -1, j = 0, k = 1, p = 1;
+        while(j + k < needleLength) {
+            SuperString::Byte a = needle[j + k], b = needle[maximalSuffix + k];
+            if(order == 0 ? a < b : b < a) {
+                j += k;
+                k = 1;
+                p = j - maximalSuffix;
+            } else if(a == b) {
+                if(k != p) {
+                    k++;
+                } else {
+                    j += p;
+                    k = 1;
+                }
+            } else {
+                maximalSuffix = j++;
+                k = p = 1;
+            }
+        }
+        suffixes[order] = maximalSuffix + 1;
+        periods[order] = p;
     }
+    int order = (suffixes[1] < suffixes[0]) ? 0 : 1; // the one that starts last
+    *period = periods[order];
+    return suffixes[order];
 }
 
-SuperString SuperString::SubstringSequence::trim() const {
-    // TODO: General code, specify
-    std::size_t startIndex = 0;
-    std::size_t endIndex = this->length();
-    Result<int, Error> result = this->codeUnitAt(startIndex);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(++startIndex);
+// the needle has more than 2 bytes, returns [length] when not found
+static std::size_t searchTwoWay(const SuperString::Byte *haystack, std::size_t length, const SuperString::Byte *needle,
+                                std::size_t needleLength) {
+    std::size_t period;
+    std::size_t suffix = criticalFactorization(needle, needleLength, &period);
+    std::size_t shifts[256]; // distance from the last occurrence of each byte to the end of the needle
+    for(std::size_t i = 0; i < 256; i++) {
+        shifts[i] = needleLength;
     }
-    result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(--endIndex - 1);
+    for(std::size_t i = 0; i < needleLength; i++) {
+        shifts[needle[i]] = needleLength - i - 1;
+    }
+    std::size_t j = 0;
+    if(std::memcmp(needle, needle + period, suffix) == 0) {
+        // periodic needle, the prefix already matched after a shift by the period is remembered
+        std::size_t memory = 0;
+        while(j + needleLength <= length) {
+            std::size_t shift = shifts[haystack[j + needleLength - 1]];
+            if(shift > 0) {
+                if(memory != 0 && shift < period) {
+                    shift = needleLength - period;
+                }
+                memory = 0;
+                j += shift;
+                continue;
+            }
+            std::size_t i = std::max(suffix, memory);
+            while(i < needleLength - 1 && needle[i] == haystack[i + j]) {
+                i++;
+            }
+            if(needleLength - 1 <= i) {
+                i = suffix - 1;
+                while(memory < i + 1 && needle[i] == haystack[i + j]) {
+                    i--;
+                }
+                if(i + 1 < memory + 1) {
+                    return j;
+                }
+                memory = needleLength - period;
+                j += period;
+            } else {
+                j += i - suffix + 1;
+                memory = 0;
+            }
+        }
+    } else {
+        period = std::max(suffix, needleLength - suffix) + 1;
+        while(j + needleLength <= length) {
+            std::size_t shift = shifts[haystack[j + needleLength - 1]];
+            if(shift > 0) {
+                j += shift;
+                continue;
+            }
+            std::size_t i = suffix;
+            while(i < needleLength - 1 && needle[i] == haystack[i + j]) {
+                i++;
+            }
+            if(needleLength - 1 <= i) {
+                i = suffix - 1;
+                while(i != (std::size_t) -1 && needle[i] == haystack[i + j]) {
+                    i--;
+                }
+                if(i == (std::size_t) -1) {
+                    return j;
+                }
+                j += period;
+            } else {
+                j += i - suffix + 1;
+            }
+        }
     }
-    return this->substring(startIndex, endIndex).ok();
+    return length;
 }
 
-SuperString SuperString::SubstringSequence::trimLeft() const {
-    // TODO: General code, specify
-    std::size_t startIndex = 0;
-    Result<int, Error> result = this->codeUnitAt(startIndex);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(++startIndex);
+// returns the offset of the first occurrence of [needle] in [haystack] that is a multiple of [step],
+// or [length] when there is none
+static std::size_t searchBytes(const SuperString::Byte *haystack, std::size_t length, const SuperString::Byte *needle,
+                               std::size_t needleLength, std::size_t step) {
+    std::size_t from = 0;
+    while(from + needleLength <= length) {
+        std::size_t offset;
+        if(needleLength == 1) {
+            const void *found = std::memchr(haystack + from, needle[0], length - from);
+            offset = (found != NULL) ? (const SuperString::Byte *) found - (haystack + from) : length - from;
+        } else if(needleLength <= SHORT_NEEDLE) {
+            offset = searchShort(haystack + from, length - from, needle, needleLength);
+        } else {
+            offset = searchTwoWay(haystack + from, length - from, needle, needleLength);
+        }
+        offset += from;
+        if(offset == length || offset % step == 0) {
+            return offset;
+        }
+        from = offset + 1;
     }
-    return this->substring(startIndex, this->length()).ok();
+    return length;
 }
 
-SuperString SuperString::SubstringSequence::trimRight() const {
-    // TODO: General code, specify
-    std::size_t endIndex = this->length();
-    Result<int, Error> result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(--endIndex - 1);
+// counts the bytes that aren't continuation bytes in [length] bytes
+static std::size_t countUTF8Characters(const SuperString::Byte *bytes, std::size_t length) {
+    std::size_t count = 0, i = 0;
+#ifdef SUPERSTRING_SIMD
+    const __m128i continuation = _mm_set1_epi8((char) 0xbf);
+    for(; i + 16 <= length; i += 16) {
+        __m128i data = _mm_loadu_si128((const __m128i *) (bytes + i));
+        count += __builtin_popcount((unsigned) _mm_movemask_epi8(_mm_cmpgt_epi8(data, continuation)));
     }
-    return this->substring(0, endIndex).ok();
-}
-
-std::size_t SuperString::SubstringSequence::keepingCost() const {
-    switch(this->kind()) {
-        case Kind::SUBSTRING:
-            return sizeof(SubstringSequence) + this->_container._substring._sequence->keepingCost();
-        case Kind::RECONSTRUCTED:
-            return sizeof(SubstringSequence) + this->_container._reconstructed._length * sizeof(int);
+#endif
+    for(; i < length; i++) {
+        count += (bytes[i] & 0xc0) != 0x80;
     }
+    return count;
 }
 
-std::size_t SuperString::SubstringSequence::reconstructionCost(const StringSequence *sequence) const {
-    if(this->kind() == Kind::SUBSTRING) {
-        return sizeof(SubstringSequence) +
-               (this->_container._substring._endIndex - this->_container._substring._startIndex) * sizeof(int);
+// returns the offset of the first byte that differs between [bytes] and [otherBytes], or [length]
+// when their first [length] bytes are equal
+static std::size_t mismatchBytes(const SuperString::Byte *bytes, const SuperString::Byte *otherBytes,
+                                 std::size_t length) {
+    if(std::memcmp(bytes, otherBytes, length) == 0) {
+        return length;
     }
-    return 0;
+    std::size_t offset = 0;
+    while(offset + 64 <= length && std::memcmp(bytes + offset, otherBytes + offset, 64) == 0) {
+        offset += 64;
+    }
+    while(bytes[offset] == otherBytes[offset]) {
+        offset++;
+    }
+    return offset;
 }
 
-void SuperString::SubstringSequence::reconstruct(const StringSequence *sequence) const {
-    SubstringSequence *self = ((SubstringSequence *) ((std::size_t) this));
-    if(self->kind() == Kind::SUBSTRING) {
-        struct SubstringMetaInfo old = self->_container._substring;
-        struct ReconstructedMetaInfo nw;
-        nw._length = old._endIndex - old._startIndex;
-        nw._data = new int[nw._length];
-        for(std::size_t i = 0; i < nw._length; i++) {
-            nw._data[i] = old._sequence->codeUnitAt(old._startIndex + i).ok();
+//*-- Comparison (internal)
+int SuperString::compareChunk(const SuperString::Byte *&pointer, const SuperString::Byte *end,
+                              SuperString::Encoding encoding, const SuperString::Chunk &chunk) {
+    const Byte *otherPointer = chunk.bytes(), *otherEnd = chunk.bytes() + chunk.memoryLength();
+    Encoding otherEncoding = chunk.encoding();
+    bool isByteEncoded = (encoding == Encoding::ASCII || encoding == Encoding::UTF8) &&
+                         (otherEncoding == Encoding::ASCII || otherEncoding == Encoding::UTF8);
+    if(encoding == otherEncoding || isByteEncoded) {
+        if(pointer == otherPointer && (std::size_t) (end - pointer) >= chunk.memoryLength()) {
+            pointer += chunk.memoryLength(); // the same text data, shared by both strings
+            return 0;
+        }
+        std::size_t length = std::min((std::size_t) (end - pointer), chunk.memoryLength());
+        std::size_t offset = mismatchBytes(pointer, otherPointer, length);
+        if(offset == chunk.memoryLength()) {
+            pointer += offset;
+            return 0;
+        }
+        // back to the start of the character holding the first difference, the bytes before are
+        // equal so the characters are the same on both sides, then decoded below
+        if(offset == length && offset > 0) {
+            offset--; // the bytes of this side ended first
+        }
+        switch(encoding) {
+            case Encoding::ASCII:
+            case Encoding::UTF8:
+                while(offset > 0 && (pointer[offset] & 0xc0) == 0x80) {
+                    offset--;
+                }
+                break;
+            case Encoding::UTF16BE:
+                offset -= offset % 2;
+                if(offset >= 2 && (pointer[offset] & 0xfc) == 0xdc && (pointer[offset - 2] & 0xfc) == 0xd8) {
+                    offset -= 2;
+                }
+                break;
+            case Encoding::UTF16LE:
+                offset -= offset % 2;
+                if(offset >= 2 && (pointer[offset + 1] & 0xfc) == 0xdc && (pointer[offset - 1] & 0xfc) == 0xd8) {
+                    offset -= 2;
+                }
+                break;
+            case Encoding::UTF32:
+                offset -= offset % sizeof(int);
+                break;
         }
-        old._sequence->removeReferencer(self);
-        if(old._sequence->refCount() == 0 && old._sequence->freeingCost() < old._sequence->keepingCost()) {
-            old._sequence->doDelete();
+        pointer += offset;
+        otherPointer += offset;
+    }
+    // the code units one by one, as the order of the bytes isn't the one of the code units
+    while(pointer < end && otherPointer < otherEnd) {
+        int codeUnit = SuperString::Finder::decode(pointer, end, encoding);
+        int otherCodeUnit = SuperString::Finder::decode(otherPointer, otherEnd, otherEncoding);
+        if(codeUnit != otherCodeUnit) {
+            return (codeUnit < otherCodeUnit) ? -1 : 1;
         }
-        self->_kind = Kind::RECONSTRUCTED;
-        self->_container._reconstructed = nw;
     }
+    return 0;
 }
 
-void SuperString::SubstringSequence::doDelete() const {
-    SubstringSequence *self = ((SubstringSequence *) (std::size_t) this);
-    if(!self->isToBeDeleted()) {
-        self->_kind = (Kind) (((char) self->kind()) + 0b10000000); // Just a trick, we don't want any more variable
-        delete self;
+//*-- Splitting (internal)
+SuperString SuperString::piece(std::size_t startIndex, std::size_t endIndex) const {
+    if(startIndex == endIndex) {
+        // an empty leaf, which does not keep this string alive as a substring would
+        return SuperString::Const("");
+    }
+    if(startIndex == 0 && endIndex == this->length()) {
+        return *this;
     }
+    return this->_sequence->substring(startIndex, endIndex).ok();
 }
 
-bool SuperString::SubstringSequence::isToBeDeleted() const {
-    return (((char) this->_kind) & 0b10000000) == 0b10000000;
+bool SuperString::forEachBreak(int codeUnit, int previous, const std::function<bool(std::size_t, bool)> &callback,
+                               std::size_t threads) const {
+    std::vector<std::vector<std::size_t>> breaks;
+    std::vector<std::size_t> shifts;
+    if(threads == 1 || !this->findBreaks(codeUnit, previous, threads, breaks, shifts)) {
+        std::size_t index = 0; // of the first character of the chunk
+        int last = -1;
+        return this->forEachChunk([&](const Chunk &chunk) -> bool {
+            bool isContinued = SuperString::scanBreaks(chunk, index, codeUnit, previous, last, callback);
+            index += chunk.length();
+            return isContinued;
+        });
+    }
+    for(std::size_t task = 0; task < breaks.size(); task++) {
+        for(std::size_t i = 0; i < breaks[task].size(); i++) {
+            if(!callback(shifts[task] + (breaks[task][i] >> 1), (breaks[task][i] & 1) != 0)) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
-//*-- SuperString::ConcatenationSequence (internal)
-SuperString::ConcatenationSequence::ConcatenationSequence(const StringSequence *leftSequence,
-                                                          const StringSequence *rightSequence) {
-    this->_kind = Kind::CONCATENATION;
-    this->_container._concatenation._left = leftSequence;
-    this->_container._concatenation._right = rightSequence;
-    this->_container._concatenation._left->addReferencer(this);
-    this->_container._concatenation._right->addReferencer(this);
+bool SuperString::findBreaks(int codeUnit, int previous, std::size_t threads,
+                             std::vector<std::vector<std::size_t>> &breaks, std::vector<std::size_t> &shifts) const {
+    std::vector<Chunk> segments;
+    std::vector<std::size_t> tasks;
+    this->partition(segments, tasks);
+    if(tasks.size() <= 2) {
+        return false;
+    }
+    std::size_t taskCount = tasks.size() - 1;
+    breaks.resize(taskCount);
+    shifts.assign(taskCount + 1, 0);
+    std::vector<int> lasts(taskCount);
+    SuperString::runTasks(taskCount, threads, [&](std::size_t task) {
+        std::size_t index = 0;
+        int last = -1;
+        for(std::size_t i = tasks[task]; i < tasks[task + 1]; i++) {
+            Chunk segment = SuperString::countSegment(segments[i]);
+            SuperString::scanBreaks(segment, index, codeUnit, previous, last, [&](std::size_t at, bool isAfter) -> bool {
+                breaks[task].push_back((at << 1) | (std::size_t) isAfter);
+                return true;
+            });
+            index += segment.length();
+        }
+        shifts[task + 1] = index;
+        lasts[task] = last;
+    });
+    for(std::size_t task = 0; task < taskCount; task++) {
+        shifts[task + 1] += shifts[task];
+        // a break at the start of a task follows the last code unit of the previous one
+        if(task > 0 && !breaks[task].empty() && breaks[task][0] >> 1 == 0) {
+            breaks[task][0] = (std::size_t) (lasts[task - 1] == previous);
+        }
+    }
+    return true;
 }
 
-SuperString::ConcatenationSequence::~ConcatenationSequence() {
-    this->reconstructReferencers();
-    switch(this->kind()) {
-        case Kind::CONCATENATION:
-            this->_container._concatenation._left->removeReferencer(this);
-            if(this->_container._concatenation._left->refCount() == 0 &&
-               this->_container._concatenation._left->freeingCost() <
-               this->_container._concatenation._left->keepingCost()) {
-                this->_container._concatenation._left->doDelete();
+std::size_t SuperString::countBreaks(int codeUnit, std::size_t threads) const {
+    std::vector<Chunk> segments;
+    std::vector<std::size_t> tasks;
+    if(threads != 1) {
+        this->partition(segments, tasks);
+    }
+    std::size_t count = 0;
+    if(tasks.size() <= 2) {
+        this->forEachBreak(codeUnit, -1, [&](std::size_t, bool) -> bool {
+            count++;
+            return true;
+        }, 1);
+        return count;
+    }
+    std::size_t taskCount = tasks.size() - 1;
+    std::vector<std::size_t> counts(taskCount, 0);
+    SuperString::runTasks(taskCount, threads, [&](std::size_t task) {
+        int last = -1;
+        for(std::size_t i = tasks[task]; i < tasks[task + 1]; i++) {
+            // the indexes aren't needed, so the characters aren't counted
+            Chunk segment(segments[i].bytes(), segments[i].memoryLength(), segments[i].encoding(),
+                          segments[i].memoryLength());
+            SuperString::scanBreaks(segment, 0, codeUnit, -1, last, [&](std::size_t, bool) -> bool {
+                counts[task]++;
+                return true;
+            });
+        }
+    });
+    for(std::size_t task = 0; task < taskCount; task++) {
+        count += counts[task];
+    }
+    return count;
+}
+
+std::size_t SuperString::splitBreaks(int codeUnit, int previous, bool isLines, std::vector<SuperString> &pieces,
+                                     std::size_t threads) const {
+    std::vector<std::vector<std::size_t>> breaks;
+    std::vector<std::size_t> shifts;
+    if(!this->findBreaks(codeUnit, previous, threads, breaks, shifts)) {
+        return (std::size_t) -1;
+    }
+    // the start of the first piece of each task, and its position in [pieces], the piece after the last
+    // break going with the last task
+    std::size_t taskCount = breaks.size(), length = shifts[taskCount], first = pieces.size();
+    std::vector<std::size_t> starts(taskCount + 1, 0), positions(taskCount + 1, first);
+    for(std::size_t task = 0; task < taskCount; task++) {
+        starts[task + 1] = breaks[task].empty() ? starts[task] : shifts[task] + (breaks[task].back() >> 1) + 1;
+        positions[task + 1] = positions[task] + breaks[task].size();
+    }
+    if(!isLines || starts[taskCount] < length) {
+        positions[taskCount]++;
+    }
+    std::size_t count = positions[taskCount] - first;
+    // the nodes are made by the tasks, and linked to the sequence in order afterwards
+    pieces.resize(first + count);
+    void **nodes = new void *[count];
+    try {
+        NodePool::allocateMany(sizeof(SubstringSequence), count, nodes);
+    } catch(...) {
+        delete[] nodes;
+        pieces.resize(first);
+        throw;
+    }
+    const StringSequence *sequence = this->_sequence;
+    std::vector<Referencer *> heads(taskCount, NULL), tails(taskCount, NULL);
+    std::vector<std::size_t> costs(taskCount, 0);
+    SuperString::runTasks(taskCount, threads, [&](std::size_t task) {
+        std::size_t startIndex = starts[task];
+        for(std::size_t position = positions[task]; position < positions[task + 1]; position++) {
+            std::size_t i = position - positions[task], endIndex = length;
+            if(i < breaks[task].size()) {
+                std::size_t index = shifts[task] + (breaks[task][i] >> 1);
+                endIndex = (isLines && (breaks[task][i] & 1) != 0) ? index - 1 : index;
             }
-            this->_container._concatenation._right->removeReferencer(this);
-            if(this->_container._concatenation._right->refCount() == 0 &&
-               this->_container._concatenation._right->freeingCost() <
-               this->_container._concatenation._right->keepingCost()) {
-                this->_container._concatenation._right->doDelete();
+            if(startIndex < endIndex) {
+                // the node of an empty piece is given back below
+                pieces[position] = SuperString(::new(nodes[position - first]) SubstringSequence(
+                        sequence, startIndex, endIndex, heads[task], costs[task]));
+                if(tails[task] == NULL) {
+                    tails[task] = heads[task];
+                }
             }
-            break;
-        case Kind::LEFTRECONSTRUCTED:
-            delete this->_container._leftReconstructed._leftData;
-            this->_container._leftReconstructed._right->removeReferencer(this);
-            if(this->_container._leftReconstructed._right->refCount() == 0 &&
-               this->_container._leftReconstructed._right->freeingCost() <
-               this->_container._leftReconstructed._right->keepingCost()) {
-                this->_container._leftReconstructed._right->doDelete();
+            if(i < breaks[task].size()) {
+                startIndex = shifts[task] + (breaks[task][i] >> 1) + 1;
             }
-            break;
-        case Kind::RIGHTRECONSTRUCTED:
-            delete this->_container._rightReconstructed._rightData;
-            this->_container._rightReconstructed._left->removeReferencer(this);
-            if(this->_container._rightReconstructed._left->refCount() == 0 &&
-               this->_container._rightReconstructed._left->freeingCost() <
-               this->_container._rightReconstructed._left->keepingCost()) {
-                this->_container._rightReconstructed._left->doDelete();
+        }
+    });
+    for(std::size_t task = 0; task < taskCount; task++) {
+        sequence->addReferencers(heads[task], tails[task], costs[task]);
+    }
+    SuperString empty; // shared by the empty pieces
+    for(std::size_t position = first; position < first + count; position++) {
+        if(pieces[position]._sequence == NULL) {
+            NodePool::deallocate(nodes[position - first], sizeof(SubstringSequence));
+            if(empty._sequence == NULL) {
+                empty = this->piece(0, 0);
             }
-            break;
-        case Kind::RECONSTRUCTED:
-            delete this->_container._reconstructed._data;
+            pieces[position] = empty;
+        }
+    }
+    delete[] nodes;
+    return count;
+}
+
+bool SuperString::scanBreaks(const SuperString::Chunk &chunk, std::size_t index, int codeUnit, int previous,
+                             int &last, const std::function<bool(std::size_t, bool)> &callback) {
+    const Byte *bytes = chunk.bytes();
+    std::size_t memoryLength = chunk.memoryLength();
+    Encoding encoding = chunk.encoding();
+    if((encoding == Encoding::ASCII || encoding == Encoding::UTF8) && 0 <= codeUnit && codeUnit < 0x80) {
+        bool isSingleByte = chunk.length() == memoryLength; // no character to count then
+        std::size_t counted = 0, countedIndex = index; // bytes before countedIndex
+        const Byte *found = (const Byte *) std::memchr(bytes, codeUnit, memoryLength);
+        while(found != NULL) {
+            std::size_t offset = found - bytes;
+            countedIndex += isSingleByte ? offset - counted : countUTF8Characters(bytes + counted, offset - counted);
+            counted = offset;
+            if(!callback(countedIndex, ((offset > 0) ? (int) bytes[offset - 1] : last) == previous)) {
+                return false;
+            }
+            found = (const Byte *) std::memchr(found + 1, codeUnit, memoryLength - offset - 1);
+        }
+        if(memoryLength > 0) {
+            last = bytes[memoryLength - 1]; // a continuation byte is never an ASCII code unit
+        }
+    } else {
+        const Byte *pointer = bytes, *end = bytes + memoryLength;
+        std::size_t i = index;
+        while(pointer < end) {
+            int current = SuperString::Finder::decode(pointer, end, encoding);
+            if(current == codeUnit && !callback(i, last == previous)) {
+                return false;
+            }
+            last = current;
+            i++;
+        }
     }
+    return true;
 }
 
-SuperString::ConcatenationSequence::Kind SuperString::ConcatenationSequence::kind() const {
-    return (Kind) (((char) this->_kind) & 0b01111111);
+bool SuperString::forEachOccurrence(const SuperString::Finder &finder, const std::function<bool(std::size_t)> &callback,
+                                    std::size_t threads) const {
+    std::size_t length = this->length(), needleLength = finder.length();
+    std::vector<Chunk> segments;
+    std::vector<std::size_t> tasks;
+    if(threads != 1) {
+        this->partition(segments, tasks);
+    }
+    if(tasks.size() <= 2) {
+        std::size_t index = 0;
+        while(true) {
+            Result<std::size_t, Error> found = finder.find(this->_sequence, index, length, false);
+            if(found.isErr()) {
+                return true;
+            }
+            if(!callback(found.ok())) {
+                return false;
+            }
+            index = found.ok() + needleLength;
+        }
+    }
+    // all the occurrences starting in each task, overlapping ones included, then the ones that don't
+    // overlap the previous one are called back in order
+    std::size_t taskCount = tasks.size() - 1;
+    std::vector<std::vector<std::size_t>> occurrences(taskCount);
+    std::vector<std::size_t> lengths(taskCount);
+    SuperString::runTasks(taskCount, threads, [&](std::size_t task) {
+        std::vector<std::size_t> &found = occurrences[task];
+        lengths[task] = SuperString::scanOccurrences(finder, segments, tasks[task], tasks[task + 1],
+                                                     [&](std::size_t index) -> bool {
+                                                         found.push_back(index);
+                                                         return true;
+                                                     });
+    });
+    std::size_t shift = 0, nextIndex = 0;
+    for(std::size_t task = 0; task < taskCount; task++) {
+        for(std::size_t i = 0; i < occurrences[task].size(); i++) {
+            std::size_t index = shift + occurrences[task][i];
+            if(index >= nextIndex) {
+                if(!callback(index)) {
+                    return false;
+                }
+                nextIndex = index + needleLength;
+            }
+        }
+        shift += lengths[task];
+    }
+    return true;
 }
 
-std::size_t SuperString::ConcatenationSequence::length() const {
-    switch(this->kind()) {
-        case Kind::CONCATENATION:
-            return this->_container._concatenation._left->length() + this->_container._concatenation._right->length();
-        case Kind::LEFTRECONSTRUCTED:
-            return this->_container._leftReconstructed._leftLength +
-                   this->_container._leftReconstructed._right->length();
-        case Kind::RIGHTRECONSTRUCTED:
-            return this->_container._rightReconstructed._rightLength +
-                   this->_container._rightReconstructed._left->length();
-        case Kind::RECONSTRUCTED:
-            return this->_container._reconstructed._length;
+SuperString::Result<std::size_t, SuperString::Error>
+SuperString::findFirst(const SuperString::Finder &finder, std::size_t threads) const {
+    std::vector<Chunk> segments;
+    std::vector<std::size_t> tasks;
+    this->partition(segments, tasks);
+    if(tasks.size() <= 2) {
+        return finder.find(this->_sequence, 0, this->length(), false);
+    }
+    // the tasks are taken in order, the ones after a task that found an occurrence are skipped
+    std::size_t taskCount = tasks.size() - 1;
+    std::vector<std::size_t> firsts(taskCount, (std::size_t) -1);
+    std::vector<std::size_t> lengths(taskCount);
+    std::atomic<std::size_t> foundTask(taskCount);
+    SuperString::runTasks(taskCount, threads, [&](std::size_t task) {
+        if(task > foundTask.load(std::memory_order_relaxed)) {
+            return;
+        }
+        lengths[task] = SuperString::scanOccurrences(finder, segments, tasks[task], tasks[task + 1],
+                                                     [&](std::size_t index) -> bool {
+                                                         firsts[task] = index;
+                                                         return false;
+                                                     });
+        if(firsts[task] != (std::size_t) -1) {
+            std::size_t current = foundTask.load(std::memory_order_relaxed);
+            while(task < current && !foundTask.compare_exchange_weak(current, task, std::memory_order_relaxed));
+        }
+    });
+    std::size_t shift = 0;
+    for(std::size_t task = 0; task < taskCount; task++) {
+        if(firsts[task] != (std::size_t) -1) {
+            return Result<std::size_t, Error>(shift + firsts[task]);
+        }
+        shift += lengths[task];
     }
+    return Result<std::size_t, Error>(Error::NotFound);
 }
 
-SuperString::Result<int, SuperString::Error>
-SuperString::ConcatenationSequence::codeUnitAt(std::size_t index) const {
-    switch(this->kind()) {
-        case Kind::CONCATENATION:
-            if(index < this->_container._concatenation._left->length()) {
-                return Result<int, Error>(this->_container._concatenation._left->codeUnitAt(index));
-            } else if((index - this->_container._concatenation._left->length()) <
-                      this->_container._concatenation._right->length()) {
-                return Result<int, Error>(this->_container._concatenation._right->codeUnitAt(
-                        index - this->_container._concatenation._left->length()));
-            }
-            break;
-        case Kind::LEFTRECONSTRUCTED:
-            if(index < this->_container._leftReconstructed._leftLength) {
-                return Result<int, Error>(this->_container._leftReconstructed._leftData[index]);
-            } else if((index - this->_container._leftReconstructed._leftLength) <
-                      this->_container._leftReconstructed._right->length()) {
-                return Result<int, Error>(this->_container._leftReconstructed._right->codeUnitAt(
-                        index - this->_container._leftReconstructed._leftLength));
+std::size_t SuperString::scanOccurrences(const SuperString::Finder &finder, const std::vector<SuperString::Chunk> &segments,
+                                         std::size_t first, std::size_t last,
+                                         const std::function<bool(std::size_t)> &callback) {
+    std::size_t index = 0, state = 0;
+    for(std::size_t i = first; i < last; i++) {
+        Chunk segment = SuperString::countSegment(segments[i]);
+        if(!finder.scan(segment, index, state, callback)) {
+            return index + segment.length();
+        }
+        index += segment.length();
+    }
+    // the occurrences that start at the end of the task and end in the next ones
+    std::size_t consumed = 0;
+    for(std::size_t i = last; i < segments.size() && consumed < state; i++) {
+        const Byte *pointer = segments[i].bytes(), *end = pointer + segments[i].memoryLength();
+        while(consumed < state && pointer < end) {
+            state = finder.advance(state, SuperString::Finder::decode(pointer, end, segments[i].encoding()));
+            consumed++;
+            if(state == finder.length() && consumed < finder.length() &&
+               !callback(index + consumed - finder.length())) {
+                return index;
             }
-            break;
-        case Kind::RIGHTRECONSTRUCTED:
-            if(index < this->_container._rightReconstructed._left->length()) {
-                return Result<int, Error>(this->_container._rightReconstructed._left->codeUnitAt(index));
-            } else if((index - this->_container._rightReconstructed._left->length()) <
-                      this->_container._rightReconstructed._rightLength) {
-                return Result<int, Error>(
-                        this->_container._rightReconstructed._rightData[
-                                index - this->_container._rightReconstructed._left->length()
-                        ]);
+        }
+    }
+    return index;
+}
+
+void SuperString::partition(std::vector<SuperString::Chunk> &segments, std::vector<std::size_t> &tasks) const {
+    std::size_t taskSize = 0; // bytes in the last task
+    tasks.push_back(0);
+    this->forEachChunk([&](const Chunk &chunk) -> bool {
+        const Byte *bytes = chunk.bytes();
+        std::size_t memoryLength = chunk.memoryLength(), offset = 0;
+        while(offset < memoryLength) {
+            // cut the chunk where the task is full, moved to the next character boundary
+            std::size_t cut = std::min(memoryLength, offset + (PARTITION_SIZE - taskSize));
+            switch(chunk.encoding()) {
+                case Encoding::ASCII:
+                    break;
+                case Encoding::UTF8:
+                    while(cut < memoryLength && (bytes[cut] & 0xc0) == 0x80) {
+                        cut++;
+                    }
+                    break;
+                case Encoding::UTF16BE:
+                    cut += cut % 2;
+                    if(cut < memoryLength && (bytes[cut] & 0xfc) == 0xdc) {
+                        cut += 2;
+                    }
+                    break;
+                case Encoding::UTF16LE:
+                    cut += cut % 2;
+                    if(cut < memoryLength && (bytes[cut + 1] & 0xfc) == 0xdc) {
+                        cut += 2;
+                    }
+                    break;
+                case Encoding::UTF32:
+                    cut += (sizeof(int) - cut % sizeof(int)) % sizeof(int);
+                    break;
             }
-            break;
-        case Kind::RECONSTRUCTED:
-            if(index < this->_container._reconstructed._length) {
-                return Result<int, Error>(this->_container._reconstructed._data[index]);
+            bool isWhole = offset == 0 && cut == memoryLength;
+            segments.push_back(Chunk(bytes + offset, cut - offset, chunk.encoding(),
+                                     isWhole ? chunk.length() : (std::size_t) -1));
+            taskSize += cut - offset;
+            offset = cut;
+            if(taskSize >= PARTITION_SIZE) {
+                tasks.push_back(segments.size());
+                taskSize = 0;
             }
+        }
+        return true;
+    });
+    if(taskSize > 0) {
+        tasks.push_back(segments.size());
     }
-    return Result<int, Error>(Error::RangeError);
 }
 
-SuperString::Result<SuperString, SuperString::Error>
-SuperString::ConcatenationSequence::substring(std::size_t startIndex,
-                                              std::size_t endIndex) const {
-    if(this->length() < startIndex || this->length() < endIndex) {
-        return Result<SuperString, Error>(Error::RangeError);
+SuperString::Chunk SuperString::countSegment(const SuperString::Chunk &segment) {
+    if(segment.length() != (std::size_t) -1) {
+        return segment;
     }
-    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
-    return Result<SuperString, Error>(SuperString(sequence));
-}
-
-bool SuperString::ConcatenationSequence::print(std::ostream &stream) const {
-    bool isOk = true;
-    switch(this->kind()) {
-        case Kind::CONCATENATION:
-            isOk &= this->_container._concatenation._left->print(stream);
-            isOk &= this->_container._concatenation._right->print(stream);
-            break;
-        case Kind::LEFTRECONSTRUCTED:
-            SuperString::UTF32::print(stream, (const Byte *) this->_container._leftReconstructed._leftData);
-            isOk &= this->_container._leftReconstructed._right->print(stream);
-            break;
-        case Kind::RIGHTRECONSTRUCTED:
-            isOk &= this->_container._rightReconstructed._left->print(stream);
-            SuperString::UTF32::print(stream, (const Byte *) this->_container._rightReconstructed._rightData);
+    const Byte *bytes = segment.bytes();
+    std::size_t memoryLength = segment.memoryLength(), length = 0;
+    switch(segment.encoding()) {
+        case Encoding::ASCII:
+            length = memoryLength;
             break;
-        case Kind::RECONSTRUCTED:
-            SuperString::UTF32::print(stream, (const Byte *) this->_container._reconstructed._data);
+        case Encoding::UTF8:
+            length = countUTF8Characters(bytes, memoryLength);
             break;
-    }
-    return isOk;
-}
-
-bool SuperString::ConcatenationSequence::print(std::ostream &stream, std::size_t startIndex,
-                                                            std::size_t endIndex) const {
-    bool isOk = true;
-    switch(this->kind()) {
-        case Kind::CONCATENATION:
-            if(startIndex < this->_container._concatenation._left->length()) {
-                if(endIndex < this->_container._concatenation._left->length()) {
-                    isOk &= this->_container._concatenation._left->print(stream, startIndex, endIndex);
-                } else {
-                    isOk &= this->_container._concatenation._left->print(stream, startIndex,
-                                                                         this->_container._concatenation._left->length());
-                    isOk &= this->_container._concatenation._right->print(stream, 0,
-                                                                          endIndex -
-                                                                          this->_container._concatenation._left->length());
-                }
-            } else {
-                if((endIndex - this->_container._concatenation._left->length()) <
-                   this->_container._concatenation._right->length()) {
-                    isOk &= this->_container._concatenation._right->print(stream, startIndex -
-                                                                                  this->_container._concatenation._left->length(),
-                                                                          endIndex -
-                                                                          this->_container._concatenation._left->length());
-                }
+        case Encoding::UTF16BE:
+            for(std::size_t i = 0; i < memoryLength; i += 2) {
+                length += (bytes[i] & 0xfc) != 0xdc; // the second halves of surrogate pairs aren't counted
             }
             break;
-        case Kind::LEFTRECONSTRUCTED:
-            if(startIndex < this->_container._leftReconstructed._leftLength) {
-                if(endIndex < this->_container._leftReconstructed._leftLength) {
-                    SuperString::UTF32::print(stream, (const Byte *) this->_container._leftReconstructed._leftData,
-                                              startIndex, endIndex);
-                } else {
-                    SuperString::UTF32::print(stream, (const Byte *) this->_container._leftReconstructed._leftData,
-                                              startIndex, this->_container._leftReconstructed._leftLength);
-                    isOk &= this->_container._leftReconstructed._right->print(stream, 0,
-                                                                              endIndex -
-                                                                              this->_container._leftReconstructed._leftLength);
-                }
-            } else {
-                if((endIndex - this->_container._leftReconstructed._leftLength) <
-                   this->_container._leftReconstructed._right->length()) {
-                    isOk &= this->_container._leftReconstructed._right->print(stream, startIndex -
-                                                                                      this->_container._leftReconstructed._leftLength,
-                                                                              endIndex -
-                                                                              this->_container._leftReconstructed._leftLength);
-                }
+        case Encoding::UTF16LE:
+            for(std::size_t i = 1; i < memoryLength; i += 2) {
+                length += (bytes[i] & 0xfc) != 0xdc;
             }
             break;
-        case Kind::RIGHTRECONSTRUCTED:
-            if(startIndex < this->_container._rightReconstructed._left->length()) {
-                if(endIndex < this->_container._rightReconstructed._left->length()) {
-                    isOk &= this->_container._rightReconstructed._left->print(stream, startIndex, endIndex);
-                } else {
-                    isOk &= this->_container._rightReconstructed._left->print(stream, startIndex,
-                                                                      this->_container._rightReconstructed._left->length());
-                    SuperString::UTF32::print(stream, (const Byte *) this->_container._rightReconstructed._rightData, 0,
-                                              endIndex - this->_container._rightReconstructed._left->length());
-                }
-            } else {
-                if((endIndex - this->_container._rightReconstructed._left->length()) <
-                   this->_container._rightReconstructed._rightLength) {
-                    SuperString::UTF32::print(stream, (const Byte *) this->_container._rightReconstructed._rightData,
-                                              startIndex - this->_container._rightReconstructed._left->length(),
-                                              endIndex - this->_container._rightReconstructed._left->length());
-                }
-            }
+        case Encoding::UTF32:
+            length = memoryLength / sizeof(int);
             break;
-        case Kind::RECONSTRUCTED:
-            SuperString::UTF32::print(stream, (const Byte *) this->_container._reconstructed._data, startIndex,
-                                      endIndex);
     }
-    return isOk;
+    return Chunk(bytes, memoryLength, segment.encoding(), length);
 }
 
-SuperString SuperString::ConcatenationSequence::trim() const {
-    // TODO: General code, specify
-    std::size_t startIndex = 0;
-    std::size_t endIndex = this->length();
-    Result<int, Error> result = this->codeUnitAt(startIndex);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(++startIndex);
+void SuperString::runTasks(std::size_t count, std::size_t threads, const std::function<void(std::size_t)> &task) {
+    if(threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
     }
-    result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(--endIndex - 1);
+    threads = std::min(threads, count);
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto work = [&]() {
+        try {
+            for(std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                task(i);
+            }
+        } catch(...) {
+            std::lock_guard<std::mutex> guard(errorMutex);
+            if(!error) {
+                error = std::current_exception();
+            }
+            next = count;
+        }
+    };
+    std::vector<std::thread> workers;
+    for(std::size_t i = 1; i < threads; i++) {
+        try {
+            workers.push_back(std::thread(work));
+        } catch(const std::system_error &) {
+            break; // the threads already started take the remaining tasks
+        }
     }
-    return this->substring(startIndex, endIndex).ok();
-}
-
-SuperString SuperString::ConcatenationSequence::trimLeft() const {
-    // TODO: General code, specify
-    std::size_t startIndex = 0;
-    Result<int, Error> result = this->codeUnitAt(startIndex);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(++startIndex);
+    work();
+    for(std::size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    if(error) {
+        std::rethrow_exception(error);
     }
-    return this->substring(startIndex, this->length()).ok();
 }
 
-SuperString SuperString::ConcatenationSequence::trimRight() const {
-    // TODO: General code, specify
-    std::size_t endIndex = this->length();
-    Result<int, Error> result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(--endIndex - 1);
+//*-- SuperString::Finder (internal)
+SuperString::Finder::Finder(const SuperString &needle)
+        : _length(needle.length()),
+          _utf8(NULL),
+          _utf8Length(0),
+          _utf16be(NULL),
+          _utf16le(NULL),
+          _utf16Length(0),
+          _isASCII(true) {
+    this->_codeUnits = new int[this->_length + 1];
+    std::size_t i = 0;
+    needle.forEachChunk([&](const Chunk &chunk) -> bool {
+        const Byte *pointer = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+        while(pointer < end && i < this->_length) {
+            this->_codeUnits[i++] = SuperString::Finder::decode(pointer, end, chunk.encoding());
+        }
+        return true;
+    });
+    // borders of the prefixes, to carry partial matches across chunks
+    this->_fallbacks = new std::size_t[this->_length + 1];
+    this->_fallbacks[0] = 0;
+    if(this->_length > 0) {
+        this->_fallbacks[1] = 0;
+    }
+    for(std::size_t j = 1; j < this->_length; j++) {
+        std::size_t k = this->_fallbacks[j];
+        while(k > 0 && this->_codeUnits[j] != this->_codeUnits[k]) {
+            k = this->_fallbacks[k];
+        }
+        this->_fallbacks[j + 1] = (this->_codeUnits[j] == this->_codeUnits[k]) ? k + 1 : 0;
+    }
+    // the needle as the bytes of each encoding
+    bool isUnicode = true;
+    for(std::size_t j = 0; j < this->_length; j++) {
+        isUnicode &= 0 <= this->_codeUnits[j] && this->_codeUnits[j] <= 0x10ffff;
+        this->_isASCII &= 0 <= this->_codeUnits[j] && this->_codeUnits[j] < 0x80;
+    }
+    if(isUnicode) {
+        this->_utf8 = new Byte[this->_length * 4 + 1];
+        this->_utf16be = new Byte[this->_length * 4 + 1];
+        this->_utf16le = new Byte[this->_length * 4 + 1];
+        for(std::size_t j = 0; j < this->_length; j++) {
+            int c = this->_codeUnits[j];
+            this->_utf8Length += SuperString::UTF8::encode(c, this->_utf8 + this->_utf8Length);
+            Byte *units = this->_utf16be + this->_utf16Length;
+            if(c < 0x10000) {
+                units[0] = (Byte) (c >> 8);
+                units[1] = (Byte) c;
+                this->_utf16Length += 2;
+            } else {
+                c -= 0x10000;
+                units[0] = (Byte) (0xd8 | (c >> 18));
+                units[1] = (Byte) (c >> 10);
+                units[2] = (Byte) (0xdc | ((c >> 8) & 0x03));
+                units[3] = (Byte) c;
+                this->_utf16Length += 4;
+            }
+        }
+        // the same code units, with their bytes swapped
+        for(std::size_t j = 0; j < this->_utf16Length; j += 2) {
+            this->_utf16le[j] = this->_utf16be[j + 1];
+            this->_utf16le[j + 1] = this->_utf16be[j];
+        }
     }
-    return this->substring(0, endIndex).ok();
 }
 
-std::size_t SuperString::ConcatenationSequence::keepingCost() const {
-    switch(this->kind()) {
-        case Kind::CONCATENATION:
-            return sizeof(ConcatenationSequence) + this->_container._concatenation._left->keepingCost() +
-                   this->_container._concatenation._right->keepingCost();
-        case Kind::LEFTRECONSTRUCTED:
-            return sizeof(ConcatenationSequence) + this->_container._leftReconstructed._leftLength * sizeof(int) +
-                   this->_container._leftReconstructed._right->keepingCost();
-        case Kind::RIGHTRECONSTRUCTED:
-            return sizeof(ConcatenationSequence) + this->_container._rightReconstructed._left->keepingCost() +
-                   this->_container._rightReconstructed._rightLength * sizeof(int);
-        case Kind::RECONSTRUCTED:
-            return sizeof(ConcatenationSequence) + this->_container._reconstructed._length * sizeof(int);
-    }
+SuperString::Finder::~Finder() {
+    delete[] this->_codeUnits;
+    delete[] this->_fallbacks;
+    delete[] this->_utf8;
+    delete[] this->_utf16be;
+    delete[] this->_utf16le;
 }
 
-std::size_t SuperString::ConcatenationSequence::reconstructionCost(const StringSequence *sequence) const {
-    switch(this->kind()) {
-        case Kind::CONCATENATION:
-            if(sequence == this->_container._concatenation._left) {
-                return sizeof(ConcatenationSequence) +
-                       this->_container._concatenation._left->length() * sizeof(int);
-            } else if(sequence == this->_container._concatenation._right) {
-                return sizeof(ConcatenationSequence) +
-                       this->_container._concatenation._right->length() * sizeof(int);
-            }
-            return 0;
-        case Kind::LEFTRECONSTRUCTED:
-            if(sequence == this->_container._leftReconstructed._right) {
-                return sizeof(ConcatenationSequence) +
-                       this->_container._leftReconstructed._right->length() * sizeof(int);
-            } else {
-                return 0;
-            }
-        case Kind::RIGHTRECONSTRUCTED:
-            if(sequence == this->_container._rightReconstructed._left) {
-                return sizeof(ConcatenationSequence) +
-                       this->_container._rightReconstructed._left->length() * sizeof(int);
-            } else {
-                return 0;
-            }
-        case Kind::RECONSTRUCTED:
-            return 0;
-    }
+std::size_t SuperString::Finder::length() const {
+    return this->_length;
 }
 
-void SuperString::ConcatenationSequence::reconstruct(const StringSequence *sequence) const {
-    ConcatenationSequence *self = ((ConcatenationSequence *) ((std::size_t) this));
-    if(self->kind() == Kind::CONCATENATION) {
-        struct ConcatenationMetaInfo old = self->_container._concatenation;
-        if(old._left == sequence) {
-            struct LeftReconstructedMetaInfo nw;
-            nw._right = old._right;
-            nw._leftLength = old._left->length();
-            nw._leftData = new int[nw._leftLength];
-            for(std::size_t i = 0; i < nw._leftLength; i++) {
-                nw._leftData[i] = old._left->codeUnitAt(i).ok();
-            }
-            old._left->removeReferencer(self);
-            if(old._left->refCount() == 0 && old._left->freeingCost() < old._left->keepingCost()) {
-                old._left->doDelete();
-            }
-            self->_kind = Kind::LEFTRECONSTRUCTED;
-            self->_container._leftReconstructed = nw;
-        } else if(old._right == sequence) {
-            struct RightReconstructedMetaInfo nw;
-            nw._left = old._right;
-            nw._rightLength = old._right->length();
-            nw._rightData = new int[nw._rightLength];
-            for(std::size_t i = 0; i < nw._rightLength; i++) {
-                nw._rightData[i] = old._right->codeUnitAt(i).ok();
-            }
-            old._right->removeReferencer(self);
-            if(old._right->refCount() == 0 && old._right->freeingCost() < old._right->keepingCost()) {
-                old._right->doDelete();
-            }
-            self->_kind = Kind::RIGHTRECONSTRUCTED;
-            self->_container._rightReconstructed = nw;
-        }
-    } else if(self->kind() == Kind::LEFTRECONSTRUCTED) {
-        struct LeftReconstructedMetaInfo old = self->_container._leftReconstructed;
-        if(old._right == sequence) {
-            struct ReconstructedMetaInfo nw;
-            nw._length = old._leftLength + old._right->length();
-            nw._data = new int[nw._length];
-            for(std::size_t i = 0; i < nw._length; i++) {
-                if(i < old._leftLength) {
-                    nw._data[i] = old._leftData[i];
-                } else {
-                    nw._data[i] = old._right->codeUnitAt(i - old._leftLength).ok();
-                }
+SuperString::Result<std::size_t, SuperString::Error>
+SuperString::Finder::find(const StringSequence *sequence, std::size_t startIndex, std::size_t endIndex,
+                          bool isLast) const {
+    std::size_t length = this->_length;
+    if(length == 0) {
+        return Result<std::size_t, Error>(isLast ? endIndex : startIndex);
+    }
+    if(endIndex < startIndex + length) {
+        return Result<std::size_t, Error>(Error::NotFound);
+    }
+    std::size_t found = (std::size_t) -1;
+    std::size_t index = startIndex; // of the first character of the chunk
+    std::size_t state = 0; // length of the partial match ending before the chunk
+    sequence->forEachChunk([&](const Chunk &chunk) -> bool {
+        bool isContinued = this->scan(chunk, index, state, [&](std::size_t matchIndex) -> bool {
+            found = matchIndex;
+            return isLast;
+        });
+        index += chunk.length();
+        return isContinued;
+    }, startIndex, endIndex);
+    if(found == (std::size_t) -1) {
+        return Result<std::size_t, Error>(Error::NotFound);
+    }
+    return Result<std::size_t, Error>(found);
+}
+
+bool SuperString::Finder::scan(const SuperString::Chunk &chunk, std::size_t index, std::size_t &state,
+                               const std::function<bool(std::size_t)> &callback) const {
+    std::size_t length = this->_length;
+    const Byte *begin = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+    const Byte *pointer = begin;
+    std::size_t consumed = 0;
+    // partial matches that started in previous chunks
+    while(consumed < state && pointer < end) {
+        state = this->advance(state, SuperString::Finder::decode(pointer, end, chunk.encoding()));
+        consumed++;
+        if(state == length && consumed < length && !callback(index + consumed - length)) {
+            return false;
+        }
+    }
+    // matches within the chunk
+    const Byte *needle = NULL;
+    std::size_t needleLength = 0, step = 1;
+    switch(chunk.encoding()) {
+        case Encoding::ASCII:
+            needle = this->_isASCII ? this->_utf8 : NULL;
+            needleLength = this->_utf8Length;
+            break;
+        case Encoding::UTF8:
+            needle = this->_utf8;
+            needleLength = this->_utf8Length;
+            break;
+        case Encoding::UTF16BE:
+            needle = this->_utf16be;
+            needleLength = this->_utf16Length;
+            step = 2;
+            break;
+        case Encoding::UTF16LE:
+            needle = this->_utf16le;
+            needleLength = this->_utf16Length;
+            step = 2;
+            break;
+        case Encoding::UTF32:
+            needle = (const Byte *) this->_codeUnits;
+            needleLength = length * sizeof(int);
+            step = sizeof(int);
+            break;
+    }
+    if(needle != NULL && length <= chunk.length()) {
+        std::size_t memoryLength = chunk.memoryLength();
+        std::size_t from = 0, countedOffset = 0, countedIndex = 0;
+        while(true) {
+            std::size_t offset = searchBytes(begin + from, memoryLength - from, needle, needleLength, step) + from;
+            if(offset >= memoryLength) {
+                break;
             }
-            old._right->removeReferencer(self);
-            if(old._right->refCount() == 0 && old._right->freeingCost() < old._right->keepingCost()) {
-                old._right->doDelete();
+            // the index of the match within the chunk
+            switch(chunk.encoding()) {
+                case Encoding::ASCII:
+                    countedIndex = offset;
+                    break;
+                case Encoding::UTF8:
+                    countedIndex += countUTF8Characters(begin + countedOffset, offset - countedOffset);
+                    break;
+                case Encoding::UTF16BE:
+                    for(std::size_t i = countedOffset; i < offset; i += 2) {
+                        countedIndex += !(i > 0 && (begin[i - 2] & 0xfc) == 0xd8);
+                    }
+                    break;
+                case Encoding::UTF16LE:
+                    for(std::size_t i = countedOffset; i < offset; i += 2) {
+                        countedIndex += !(i > 0 && (begin[i - 1] & 0xfc) == 0xd8);
+                    }
+                    break;
+                case Encoding::UTF32:
+                    countedIndex = offset / sizeof(int);
+                    break;
             }
-            self->_kind = Kind::RECONSTRUCTED;
-            self->_container._reconstructed = nw;
-        }
-    } else if(self->kind() == Kind::RIGHTRECONSTRUCTED) {
-        struct RightReconstructedMetaInfo old = self->_container._rightReconstructed;
-        if(old._left == sequence) {
-            struct ReconstructedMetaInfo nw;
-            nw._length = old._left->length() + old._rightLength;
-            nw._data = new int[nw._length];
-            std::size_t leftLength = old._left->length();
-            for(std::size_t i = 0; i < nw._length; i++) {
-                if(i < leftLength) {
-                    nw._data[i] = old._left->codeUnitAt(i).ok();
-                } else {
-                    nw._data[i] = old._rightData[i - leftLength];
-                }
+            countedOffset = offset;
+            // starts in the middle of a surrogate pair
+            bool isSplitPair = offset > 0 && ((chunk.encoding() == Encoding::UTF16BE &&
+                                               (begin[offset - 2] & 0xfc) == 0xd8) ||
+                                              (chunk.encoding() == Encoding::UTF16LE &&
+                                               (begin[offset - 1] & 0xfc) == 0xd8));
+            if(!isSplitPair && !callback(index + countedIndex)) {
+                return false;
             }
-            old._left->removeReferencer(self);
-            if(old._left->refCount() == 0 && old._left->freeingCost() < old._left->keepingCost()) {
-                old._left->doDelete();
+            from = offset + step;
+        }
+    }
+    // the partial match at the end of the chunk is within its last characters
+    if(consumed < chunk.length()) {
+        const Byte *tail = end;
+        std::size_t tailLength = 0;
+        while(tail > pointer && tailLength < length - 1) {
+            if(chunk.encoding() == Encoding::UTF16BE) {
+                tail -= (tail - pointer >= 4 && (*(tail - 4) & 0xfc) == 0xd8) ? 4 : 2;
+            } else if(chunk.encoding() == Encoding::UTF16LE) {
+                tail -= (tail - pointer >= 4 && (*(tail - 3) & 0xfc) == 0xd8) ? 4 : 2;
+            } else if(chunk.encoding() == Encoding::UTF8) {
+                while(--tail > pointer && (*tail & 0xc0) == 0x80);
+            } else {
+                tail -= (chunk.encoding() == Encoding::UTF32) ? sizeof(int) : 1;
             }
-            self->_kind = Kind::RECONSTRUCTED;
-            self->_container._reconstructed = nw;
+            tailLength++;
+        }
+        if(tail > pointer) {
+            state = 0;
+        }
+        while(tail < end) {
+            state = this->advance(state, SuperString::Finder::decode(tail, end, chunk.encoding()));
         }
     }
+    return true;
 }
 
-void SuperString::ConcatenationSequence::doDelete() const {
-    ConcatenationSequence *self = ((ConcatenationSequence *) (std::size_t) this);
-    if(!this->isToBeDeleted()) {
-        *((char *) &self->_kind) = ((char) self->kind()) + 0b10000000; // Just a trick, we don't want any more variable
-        delete self;
+std::size_t SuperString::Finder::advance(std::size_t state, int codeUnit) const {
+    if(state == this->_length) {
+        state = this->_fallbacks[state];
     }
+    while(state > 0 && this->_codeUnits[state] != codeUnit) {
+        state = this->_fallbacks[state];
+    }
+    return (this->_codeUnits[state] == codeUnit) ? state + 1 : 0;
 }
 
-bool SuperString::ConcatenationSequence::isToBeDeleted() const {
-    return (((char) this->_kind) & 0b10000000) == 0b10000000;
-}
-
-//*-- MultipleSequence (internal)
-SuperString::MultipleSequence::MultipleSequence(const StringSequence *sequence, std::size_t time) {
-    this->_kind = Kind::MULTIPLE;
-    this->_container._multiple._time = time;
-    this->_container._multiple._sequence = sequence;
-    this->_container._multiple._sequence->addReferencer(this);
-}
-
-SuperString::MultipleSequence::~MultipleSequence() {
-    this->reconstructReferencers();
-    switch(this->kind()) {
-        case Kind::MULTIPLE:
-            this->_container._multiple._sequence->removeReferencer(this);
-            if(this->_container._multiple._sequence->refCount() == 0 &&
-               this->_container._multiple._sequence->freeingCost() <
-               this->_container._multiple._sequence->keepingCost()) {
-                this->_container._multiple._sequence->doDelete();
+int SuperString::Finder::decode(const SuperString::Byte *&pointer, const SuperString::Byte *end,
+                                SuperString::Encoding encoding) {
+    int codeUnit = 0;
+    switch(encoding) {
+        case Encoding::ASCII:
+            codeUnit = *pointer;
+            pointer++;
+            break;
+        case Encoding::UTF8:
+            // continuation bytes belong to the character before them, as when counting characters
+            codeUnit = *pointer & ((*pointer >= 0xf0) ? 0x07 : (*pointer >= 0xe0) ? 0x0f : (*pointer >= 0xc0) ? 0x1f
+                                                                                                    : 0x7f);
+            pointer++;
+            while(pointer < end && (*pointer & 0xc0) == 0x80) {
+                codeUnit = codeUnit << 6 | (*pointer & 0x3f);
+                pointer++;
+            }
+            break;
+        case Encoding::UTF16BE:
+            if((*pointer & 0xfc) == 0xd8 && pointer + 4 <= end) {
+                codeUnit = 0x10000 + ((*pointer & 0x03) << 18) + (*(pointer + 1) << 10) +
+                           ((*(pointer + 2) & 0x03) << 8) + *(pointer + 3);
+                pointer += 4;
+            } else {
+                codeUnit = (*pointer << 8) + *(pointer + 1);
+                pointer += 2;
             }
             break;
-        case Kind::RECONSTRUCTED:
-            delete this->_container._reconstructed._data;
+        case Encoding::UTF32:
+            codeUnit = *((const int *) pointer);
+            pointer += sizeof(int);
+            break;
+        case Encoding::UTF16LE:
+            if((*(pointer + 1) & 0xfc) == 0xd8 && pointer + 4 <= end) {
+                codeUnit = 0x10000 + ((*(pointer + 1) & 0x03) << 18) + (*pointer << 10) +
+                           ((*(pointer + 3) & 0x03) << 8) + *(pointer + 2);
+                pointer += 4;
+            } else {
+                codeUnit = (*(pointer + 1) << 8) + *pointer;
+                pointer += 2;
+            }
             break;
     }
+    return codeUnit;
+}
+
+//*-- SuperString::Hash
+std::uint64_t SuperString::Hash::multiply(std::uint64_t a, std::uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128) a * b;
+    return SuperString::Hash::reduce((std::uint64_t) (product & MODULUS) + (std::uint64_t) (product >> 61));
+#else
+    // with 31-bit halves, 2^62 being 2 and 2^61 being 1 modulo `MODULUS`
+    std::uint64_t aHigh = a >> 31, aLow = a & 0x7fffffff;
+    std::uint64_t bHigh = b >> 31, bLow = b & 0x7fffffff;
+    std::uint64_t middle = aHigh * bLow + aLow * bHigh;
+    return SuperString::Hash::reduce(2 * (aHigh * bHigh) + (middle >> 30) + ((middle & 0x3fffffff) << 31) +
+                                     aLow * bLow);
+#endif
+}
+
+std::uint64_t SuperString::Hash::power(std::size_t exponent) {
+    std::uint64_t result = 1, base = BASE;
+    while(exponent > 0) {
+        if(exponent & 1) {
+            result = SuperString::Hash::multiply(result, base);
+        }
+        base = SuperString::Hash::multiply(base, base);
+        exponent >>= 1;
+    }
+    return result;
 }
 
-SuperString::MultipleSequence::Kind SuperString::MultipleSequence::kind() const {
-    return (Kind) (((char) this->_kind) & 0b01111111);
+std::uint64_t SuperString::Hash::concatenate(std::uint64_t left, std::uint64_t right, std::size_t rightLength) {
+    return SuperString::Hash::reduce(SuperString::Hash::multiply(left, SuperString::Hash::power(rightLength)) + right);
 }
 
-std::size_t SuperString::MultipleSequence::length() const {
-    switch(this->kind()) {
-        case Kind::MULTIPLE:
-            return this->_container._multiple._sequence->length() * this->_container._multiple._time;
-        case Kind::RECONSTRUCTED:
-            return this->_container._reconstructed._dataLength * this->_container._reconstructed._time;
+std::uint64_t SuperString::Hash::repeat(std::uint64_t hash, std::size_t length, std::size_t times) {
+    // the sum of the powers of `BASE^length` below [times], doubling the number of repetitions bit by bit
+    std::uint64_t step = SuperString::Hash::power(length);
+    std::uint64_t sum = 0, stepPower = 1; // for the repetitions so far
+    for(int bit = (int) sizeof(std::size_t) * 8 - 1; bit >= 0; bit--) {
+        sum = SuperString::Hash::reduce(SuperString::Hash::multiply(sum, stepPower) + sum);
+        stepPower = SuperString::Hash::multiply(stepPower, stepPower);
+        if((times >> bit) & 1) {
+            sum = SuperString::Hash::reduce(SuperString::Hash::multiply(sum, step) + 1);
+            stepPower = SuperString::Hash::multiply(stepPower, step);
+        }
     }
+    return SuperString::Hash::multiply(hash, sum);
 }
 
-SuperString::Result<int, SuperString::Error> SuperString::MultipleSequence::codeUnitAt(std::size_t index) const {
-    std::size_t length = this->length();
-    if(index < length) {
-        switch(this->kind()) {
-            case Kind::MULTIPLE:
-                return this->_container._multiple._sequence->codeUnitAt(
-                        index % this->_container._multiple._sequence->length());
-            case Kind::RECONSTRUCTED:
-                return this->_container._reconstructed._data[index % this->_container._reconstructed._dataLength];
+std::uint64_t SuperString::Hash::update(std::uint64_t hash, const SuperString::Chunk &chunk) {
+    // the terms of the ASCII characters in a group of eight, `(c + 1) * BASE^(7 - position)`
+    static const struct Terms {
+        std::uint64_t _terms[8][128];
+
+        Terms() {
+            for(std::uint64_t c = 0; c < 128; c++) {
+                this->_terms[7][c] = c + 1;
+                for(int position = 6; position >= 0; position--) {
+                    this->_terms[position][c] = SuperString::Hash::multiply(this->_terms[position + 1][c], BASE);
+                }
+            }
+        }
+    } terms;
+    const Byte *pointer = chunk.bytes(), *end = chunk.bytes() + chunk.memoryLength();
+    Encoding encoding = chunk.encoding();
+    bool isByteEncoded = encoding == Encoding::ASCII || encoding == Encoding::UTF8;
+    std::uint64_t base8 = SuperString::Hash::power(8);
+    while(pointer < end) {
+        std::uint64_t bytes = 0x8080808080808080ULL;
+        if(isByteEncoded && end - pointer >= 8) {
+            std::memcpy(&bytes, pointer, 8);
+        }
+        if((bytes & 0x8080808080808080ULL) == 0) {
+            // eight ASCII characters at a time, so that only one multiplication depends on the previous hash,
+            // the terms are summed by halves to stay below 2^63
+            std::uint64_t first = terms._terms[0][pointer[0]] + terms._terms[1][pointer[1]] +
+                                  terms._terms[2][pointer[2]] + terms._terms[3][pointer[3]];
+            std::uint64_t second = terms._terms[4][pointer[4]] + terms._terms[5][pointer[5]] +
+                                   terms._terms[6][pointer[6]] + terms._terms[7][pointer[7]];
+            hash = SuperString::Hash::reduce(SuperString::Hash::multiply(hash, base8) +
+                                             SuperString::Hash::reduce(first) + SuperString::Hash::reduce(second));
+            pointer += 8;
+        } else {
+            int codeUnit = SuperString::Finder::decode(pointer, end, encoding);
+            hash = SuperString::Hash::reduce(SuperString::Hash::multiply(hash, BASE) + (unsigned int) codeUnit + 1);
         }
     }
-    return Result<int, Error>(Error::RangeError);
+    return hash;
 }
 
-SuperString::Result<SuperString, SuperString::Error>
-SuperString::MultipleSequence::substring(std::size_t startIndex,
-                                         std::size_t endIndex) const {
-    std::size_t length = this->length();
-    if(length < startIndex || length < endIndex) {
-        return Result<SuperString, Error>(Error::RangeError);
-    }
-    SubstringSequence *sequence = new SubstringSequence(this, startIndex, endIndex);
-    return Result<SuperString, Error>(SuperString(sequence));
+std::uint64_t SuperString::Hash::reduce(std::uint64_t value) {
+    value = (value & MODULUS) + (value >> 61);
+    return value - (MODULUS & (0 - (std::uint64_t) (value >= MODULUS)));
 }
 
-bool SuperString::MultipleSequence::print(std::ostream &stream) const {
-    switch(this->kind()) {
-        case Kind::MULTIPLE:
-            for(std::size_t i = 0; i < this->_container._multiple._time; i++) {
-                this->_container._multiple._sequence->print(stream);
-            }
-            break;
-        case Kind::RECONSTRUCTED:
-            for(std::size_t i = 0; i < this->_container._multiple._time; i++) {
-                SuperString::UTF32::print(stream, (const Byte *) this->_container._reconstructed._data);
-            }
-            break;
+//*-- SuperString::Writer (internal)
+// UTF-16BE, UTF-16LE and UTF-32 data is transcoded a block of 16 code units at a time, narrowed with SSE2 when the
+// whole block is ASCII, otherwise encoded one character at a time. A block never takes more than 64 bytes.
+
+#ifdef SUPERSTRING_SIMD
+// narrows the 16 UTF-16BE code units at [bytes] to [output], if they are all ASCII
+static bool narrowUTF16BE(const SuperString::Byte *bytes, SuperString::Byte *output) {
+    __m128i first = _mm_loadu_si128((const __m128i *) bytes);
+    __m128i second = _mm_loadu_si128((const __m128i *) (bytes + 16));
+    // the high byte of a code unit is the low one of a lane
+    __m128i nonASCII = _mm_and_si128(_mm_or_si128(first, second), _mm_set1_epi16((short) 0x80ff));
+    if(_mm_movemask_epi8(_mm_cmpeq_epi8(nonASCII, _mm_setzero_si128())) != 0xffff) {
+        return false;
     }
+    _mm_storeu_si128((__m128i *) output, _mm_packus_epi16(_mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8)));
     return true;
 }
 
-bool SuperString::MultipleSequence::print(std::ostream &stream, std::size_t startIndex,
-                                                       std::size_t endIndex) const {
-    bool printing = false;
-    std::size_t unitLength;
-    switch(this->kind()) {
-        case Kind::MULTIPLE:
-            unitLength = this->_container._multiple._sequence->length();
-            for(std::size_t i = 0; i < this->_container._multiple._time; i++) {
-                std::size_t iterationStartIndex = i * unitLength;
-                std::size_t iterationEndIndex = (i + 1) * unitLength;
-                if(!printing) {
-                    if(iterationStartIndex <= startIndex) {
-                        if(endIndex < iterationEndIndex) {
-                            this->_container._multiple._sequence->print(stream, startIndex - iterationStartIndex,
-                                                                        endIndex - iterationStartIndex);
-                            break;
-                        } else {
-                            printing = true;
-                            this->_container._multiple._sequence->print(stream, startIndex - iterationStartIndex,
-                                                                        unitLength);
-                        }
-                    }
-                } else {
-                    if(endIndex <= iterationEndIndex) {
-                        this->_container._multiple._sequence->print(stream, 0, endIndex - iterationStartIndex);
-                    } else {
-                        this->_container._multiple._sequence->print(stream);
-                    }
-                }
-            }
-            break;
-        case Kind::RECONSTRUCTED:
-            unitLength = this->_container._reconstructed._dataLength;
-            for(std::size_t i = 0; i < this->_container._reconstructed._time; i++) {
-                std::size_t iterationStartIndex = i * unitLength;
-                std::size_t iterationEndIndex = (i + 1) * unitLength;
-                if(!printing) {
-                    if(iterationStartIndex <= startIndex) {
-                        if(endIndex < iterationEndIndex) {
-                            SuperString::UTF32::print(stream, (const Byte *) this->_container._reconstructed._data,
-                                                      startIndex - iterationStartIndex,
-                                                      endIndex - iterationStartIndex);
-                            break;
-                        } else {
-                            printing = true;
-                            SuperString::UTF32::print(stream, (const Byte *) this->_container._reconstructed._data,
-                                                      startIndex - iterationStartIndex,
-                                                      unitLength);
-                        }
-                    }
-                } else {
-                    if(endIndex <= iterationEndIndex) {
-                        SuperString::UTF32::print(stream, (const Byte *) this->_container._reconstructed._data,
-                                                  0, endIndex - iterationStartIndex);
-                    } else {
-                        SuperString::UTF32::print(stream, (const Byte *) this->_container._reconstructed._data);
-                    }
-                }
-            }
-            break;
+// narrows the 16 UTF-16LE code units at [bytes] to [output], if they are all ASCII
+static bool narrowUTF16LE(const SuperString::Byte *bytes, SuperString::Byte *output) {
+    __m128i first = _mm_loadu_si128((const __m128i *) bytes);
+    __m128i second = _mm_loadu_si128((const __m128i *) (bytes + 16));
+    // a code unit is a lane as it is, no swapping
+    __m128i nonASCII = _mm_and_si128(_mm_or_si128(first, second), _mm_set1_epi16((short) 0xff80));
+    if(_mm_movemask_epi8(_mm_cmpeq_epi8(nonASCII, _mm_setzero_si128())) != 0xffff) {
+        return false;
     }
+    _mm_storeu_si128((__m128i *) output, _mm_packus_epi16(first, second));
     return true;
 }
 
-SuperString SuperString::MultipleSequence::trim() const {
-    // TODO: General code, specify
-    std::size_t startIndex = 0;
-    std::size_t endIndex = this->length();
-    Result<int, Error> result = this->codeUnitAt(startIndex);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(++startIndex);
-    }
-    result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(--endIndex - 1);
+// narrows the 16 UTF-32 code units at [bytes] to [output], if they are all ASCII
+static bool narrowUTF32(const SuperString::Byte *bytes, SuperString::Byte *output) {
+    __m128i first = _mm_loadu_si128((const __m128i *) bytes);
+    __m128i second = _mm_loadu_si128((const __m128i *) (bytes + 16));
+    __m128i third = _mm_loadu_si128((const __m128i *) (bytes + 32));
+    __m128i fourth = _mm_loadu_si128((const __m128i *) (bytes + 48));
+    __m128i nonASCII = _mm_and_si128(_mm_or_si128(_mm_or_si128(first, second), _mm_or_si128(third, fourth)),
+                                     _mm_set1_epi32(~0x7f));
+    if(_mm_movemask_epi8(_mm_cmpeq_epi8(nonASCII, _mm_setzero_si128())) != 0xffff) {
+        return false;
     }
-    return this->substring(startIndex, endIndex).ok();
+    _mm_storeu_si128((__m128i *) output, _mm_packus_epi16(_mm_packs_epi32(first, second),
+                                                          _mm_packs_epi32(third, fourth)));
+    return true;
+}
+#endif
+
+// kept out of the header, along with `struct iovec`
+struct SuperString::Writer::State {
+    struct iovec _vectors[VECTORS];
+    std::size_t _count = 0;
+    std::size_t _mark = 0; // the start of the buffered bytes not in a vector yet
+    std::size_t _length = 0;
+    SuperString::Byte _buffer[CAPACITY];
+};
+
+SuperString::Writer::Writer(std::ostream &stream)
+        : _stream(&stream),
+          _fd(-1),
+          _isOk(true),
+          _written(0),
+          _state(new State) {
+    // nothing go here
 }
 
-SuperString SuperString::MultipleSequence::trimLeft() const {
-    // TODO: General code, specify
-    std::size_t startIndex = 0;
-    Result<int, Error> result = this->codeUnitAt(startIndex);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(++startIndex);
+SuperString::Writer::Writer(int fd)
+        : _stream(NULL),
+          _fd(fd),
+          _isOk(true),
+          _written(0),
+          _state(new State) {
+    // nothing go here
+}
+
+SuperString::Writer::~Writer() {
+    delete this->_state;
+}
+
+bool SuperString::Writer::isOk() const {
+    return this->_isOk;
+}
+
+std::size_t SuperString::Writer::written() const {
+    return this->_written;
+}
+
+bool SuperString::Writer::write(const SuperString::Chunk &chunk) {
+    switch(chunk.encoding()) {
+        case Encoding::UTF16BE:
+            this->writeUTF16BE(chunk.bytes(), chunk.memoryLength());
+            break;
+        case Encoding::UTF16LE:
+            this->writeUTF16LE(chunk.bytes(), chunk.memoryLength());
+            break;
+        case Encoding::UTF32:
+            this->writeUTF32(chunk.bytes(), chunk.memoryLength());
+            break;
+        default:
+            this->writeBytes(chunk.bytes(), chunk.memoryLength());
     }
-    return this->substring(startIndex, this->length()).ok();
+    return this->_isOk;
 }
 
-SuperString SuperString::MultipleSequence::trimRight() const {
-    // TODO: General code, specify
-    std::size_t endIndex = this->length();
-    Result<int, Error> result = this->codeUnitAt(endIndex - 1);
-    while(result.isOk() && SuperString::isWhiteSpace(result.ok())) {
-        result = this->codeUnitAt(--endIndex - 1);
+void SuperString::Writer::writeBytes(const SuperString::Byte *bytes, std::size_t memoryLength) {
+    if(this->_stream == NULL && GATHER_SIZE <= memoryLength) {
+        if(this->_state->_mark < this->_state->_length) {
+            std::size_t mark = this->_state->_mark;
+            this->_state->_mark = this->_state->_length;
+            this->gather(this->_state->_buffer + mark, this->_state->_length - mark);
+        }
+        this->gather(bytes, memoryLength);
+        return;
+    }
+    if(CAPACITY - this->_state->_length < memoryLength) {
+        this->flush();
+        // only a stream gets here with that much, the file descriptor gathers from GATHER_SIZE bytes on
+        if(CAPACITY <= memoryLength) {
+            this->_stream->write((const char *) bytes, memoryLength);
+            return;
+        }
     }
-    return this->substring(0, endIndex).ok();
+    std::memcpy(this->_state->_buffer + this->_state->_length, bytes, memoryLength);
+    this->_state->_length += memoryLength;
 }
 
-std::size_t SuperString::MultipleSequence::keepingCost() const {
-    switch(this->kind()) {
-        case Kind::MULTIPLE:
-            return sizeof(MultipleSequence) + this->_container._multiple._sequence->keepingCost();
-        case Kind::RECONSTRUCTED:
-            return sizeof(MultipleSequence) + this->_container._reconstructed._dataLength * sizeof(int);
+void SuperString::Writer::writeUTF16BE(const SuperString::Byte *bytes, std::size_t memoryLength) {
+    const Byte *pointer = bytes;
+    const Byte *end = bytes + memoryLength;
+    while(pointer < end) {
+        if(CAPACITY - this->_state->_length < 64) {
+            this->flush();
+        }
+        Byte *output = this->_state->_buffer + this->_state->_length;
+        const Byte *blockEnd = (end - pointer < 32) ? end : pointer + 32;
+#ifdef SUPERSTRING_SIMD
+        if(blockEnd - pointer == 32 && narrowUTF16BE(pointer, output)) {
+            this->_state->_length += 16;
+            pointer = blockEnd;
+            continue;
+        }
+#endif
+        // a surrogate pair may end past the block, never past the data
+        while(pointer < blockEnd) {
+            output += SuperString::UTF8::encode(SuperString::Finder::decode(pointer, end, Encoding::UTF16BE), output);
+        }
+        this->_state->_length = output - this->_state->_buffer;
     }
-    return 0;
 }
 
-std::size_t SuperString::MultipleSequence::reconstructionCost(const StringSequence *sequence) const {
-    switch(this->kind()) {
-        case Kind::MULTIPLE:
-            return sizeof(SubstringSequence) +
-                   this->_container._multiple._sequence->length() * this->_container._multiple._time * 2;
-        case Kind::RECONSTRUCTED:
-            return 0;
+void SuperString::Writer::writeUTF16LE(const SuperString::Byte *bytes, std::size_t memoryLength) {
+    const Byte *pointer = bytes;
+    const Byte *end = bytes + memoryLength;
+    while(pointer < end) {
+        if(CAPACITY - this->_state->_length < 64) {
+            this->flush();
+        }
+        Byte *output = this->_state->_buffer + this->_state->_length;
+        const Byte *blockEnd = (end - pointer < 32) ? end : pointer + 32;
+#ifdef SUPERSTRING_SIMD
+        if(blockEnd - pointer == 32 && narrowUTF16LE(pointer, output)) {
+            this->_state->_length += 16;
+            pointer = blockEnd;
+            continue;
+        }
+#endif
+        while(pointer < blockEnd) {
+            output += SuperString::UTF8::encode(SuperString::Finder::decode(pointer, end, Encoding::UTF16LE), output);
+        }
+        this->_state->_length = output - this->_state->_buffer;
     }
 }
 
-void SuperString::MultipleSequence::reconstruct(const StringSequence *sequence) const {
-    MultipleSequence *self = ((MultipleSequence *) ((std::size_t) this));
-    if(self->kind() == Kind::MULTIPLE) {
-        struct MultipleMetaInfo old = self->_container._multiple;
-        if(sequence == old._sequence) {
-            struct ReconstructedMetaInfo nw;
-            nw._time = old._time;
-            nw._dataLength = old._sequence->length();
-            nw._data = new int[nw._dataLength];
-            for(std::size_t i = 0; i < nw._dataLength; i++) {
-                nw._data[i] = old._sequence->codeUnitAt(i).ok();
-            }
-            old._sequence->removeReferencer(self);
-            if(old._sequence->refCount() == 0 && old._sequence->freeingCost() < old._sequence->keepingCost()) {
-                old._sequence->doDelete();
-            }
-            self->_kind = Kind::RECONSTRUCTED;
-            self->_container._reconstructed = nw;
+void SuperString::Writer::writeUTF32(const SuperString::Byte *bytes, std::size_t memoryLength) {
+    const Byte *pointer = bytes;
+    const Byte *end = bytes + memoryLength;
+    while(pointer < end) {
+        if(CAPACITY - this->_state->_length < 64) {
+            this->flush();
+        }
+        Byte *output = this->_state->_buffer + this->_state->_length;
+        const Byte *blockEnd = (end - pointer < 64) ? end : pointer + 64;
+#ifdef SUPERSTRING_SIMD
+        if(blockEnd - pointer == 64 && narrowUTF32(pointer, output)) {
+            this->_state->_length += 16;
+            pointer = blockEnd;
+            continue;
         }
+#endif
+        while(pointer < blockEnd) {
+            output += SuperString::UTF8::encode(*((const int *) pointer), output);
+            pointer += 4;
+        }
+        this->_state->_length = output - this->_state->_buffer;
     }
 }
 
-void SuperString::MultipleSequence::doDelete() const {
-    MultipleSequence *self = ((MultipleSequence *) (std::size_t) this);
-    if(!self->isToBeDeleted()) {
-        self->_kind = (Kind) (((char) self->kind()) + 0b10000000); // Just a trick, we don't want any more variable
-        delete self;
+void SuperString::Writer::flush() {
+    if(this->_stream != NULL) {
+        if(this->_state->_length != 0) {
+            this->_stream->write((const char *) this->_state->_buffer, this->_state->_length);
+            this->_state->_length = 0;
+        }
+        return;
+    }
+    if(this->_state->_mark < this->_state->_length) {
+        this->_state->_vectors[this->_state->_count].iov_base = this->_state->_buffer + this->_state->_mark;
+        this->_state->_vectors[this->_state->_count].iov_len = this->_state->_length - this->_state->_mark;
+        this->_state->_count++;
+    }
+    struct iovec *vector = this->_state->_vectors;
+    struct iovec *end = this->_state->_vectors + this->_state->_count;
+    while(this->_isOk && vector < end) {
+        ssize_t written = ::writev(this->_fd, vector, (int) (end - vector));
+        if(written < 0) {
+            this->_isOk = errno == EINTR;
+            continue;
+        }
+        this->_written += (std::size_t) written;
+        // a short write leaves the rest of the vectors, the first one maybe in part
+        while(vector < end && vector->iov_len <= (std::size_t) written) {
+            written -= vector->iov_len;
+            vector++;
+        }
+        if(vector < end) {
+            vector->iov_base = (Byte *) vector->iov_base + written;
+            vector->iov_len -= written;
+        }
     }
+    this->_state->_count = 0;
+    this->_state->_mark = 0;
+    this->_state->_length = 0;
 }
 
-bool SuperString::MultipleSequence::isToBeDeleted() const {
-    return (((char) this->_kind) & 0b10000000) == 0b10000000;
+void SuperString::Writer::gather(const SuperString::Byte *bytes, std::size_t memoryLength) {
+    this->_state->_vectors[this->_state->_count].iov_base = (void *) bytes;
+    this->_state->_vectors[this->_state->_count].iov_len = memoryLength;
+    this->_state->_count++;
+    if(this->_state->_count == VECTORS - 1) {
+        this->flush();
+    }
 }
 
 //*-- SuperString::ASCII
 std::size_t SuperString::ASCII::length(const SuperString::Byte *bytes) {
+    return std::strlen((const char *) bytes); // vectorized by the C library
+}
+
+SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+SuperString::ASCII::validate(const SuperString::Byte *bytes) {
     const Byte *pointer = bytes;
-    while(*pointer != 0x00) {
+    while(*pointer != 0x00 && *pointer < 0x80) {
         pointer++;
     }
-    return pointer - bytes;
+    if(*pointer != 0x00) {
+        return Result<Pair<std::size_t, std::size_t>, std::size_t>((std::size_t) (pointer - bytes));
+    }
+    return Result<Pair<std::size_t, std::size_t>, std::size_t>(
+            Pair<std::size_t, std::size_t>(pointer - bytes, pointer - bytes + 1));
 }
 
 int SuperString::ASCII::codeUnitAt(const SuperString::Byte *bytes, std::size_t index) {
     return ((int) *(bytes + index));
 }
 
-void SuperString::ASCII::print(std::ostream &stream, const SuperString::Byte *bytes) {
-    stream << (const char *) bytes;
-}
-
 void SuperString::ASCII::print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
                                std::size_t endIndex) {
     stream.write(((char *) (bytes + startIndex)), endIndex - startIndex);
@@ -1931,240 +5670,161 @@ void SuperString::ASCII::print(std::ostream &stream, const SuperString::Byte *by
 
 SuperString::Pair<std::size_t, std::size_t>
 SuperString::ASCII::trim(const SuperString::Byte *bytes, std::size_t length) {
-    std::size_t startIndex = 0;
-    std::size_t endIndex = length;
-    char c = *(bytes + startIndex);
-    while(c != 0x00 && SuperString::isWhiteSpace(c)) {
-        c = *(bytes + (++startIndex));
-    }
-    c = *(bytes + (endIndex - 1));
-    while(endIndex > 0 && SuperString::isWhiteSpace(c)) {
-        c = *(bytes + (--endIndex - 1));
-    }
+    std::size_t startIndex = SuperString::ASCII::trimLeft(bytes, length);
+    std::size_t endIndex = startIndex + SuperString::ASCII::trimRight(bytes + startIndex, length - startIndex);
     return Pair<std::size_t, std::size_t>(startIndex, endIndex);
 }
 
-std::size_t SuperString::ASCII::trimLeft(const SuperString::Byte *bytes) {
+std::size_t SuperString::ASCII::trimLeft(const SuperString::Byte *bytes, std::size_t length) {
     std::size_t startIndex = 0;
-    char c = *(bytes + startIndex);
-    while(c != 0x00 && SuperString::isWhiteSpace(c)) {
-        c = *(bytes + ++startIndex);
+    while(startIndex < length && SuperString::isWhiteSpace((char) *(bytes + startIndex))) {
+        startIndex++;
     }
     return startIndex;
 }
 
 std::size_t SuperString::ASCII::trimRight(const SuperString::Byte *bytes, std::size_t length) {
     std::size_t endIndex = length;
-    char c = *(bytes + (endIndex - 1));
-    while(endIndex > 0 && SuperString::isWhiteSpace(c)) {
-        c = *(bytes + (--endIndex - 1));
+    while(endIndex > 0 && SuperString::isWhiteSpace((char) *(bytes + (endIndex - 1)))) {
+        endIndex--;
     }
     return endIndex;
 }
 
 // SuperString::UTF8
+// counts the bytes that aren't continuation bytes, one per character
 std::size_t SuperString::UTF8::length(const SuperString::Byte *bytes) {
-    std::size_t length = 0;
-    const Byte *pointer = bytes;
-    while(*pointer != 0x00) {
-        if((*pointer & 0xf8) == 0xf0) { pointer += 4; }
-        else if((*pointer & 0xf0) == 0xe0) { pointer += 3; }
-        else if((*pointer & 0xe0) == 0xc0) { pointer += 2; }
-        else if((*pointer & 0x80) == 0x00) { pointer++; }
-        else return 0;
-        length++;
-    }
+    std::size_t length;
+    scanUTF8(bytes, &length);
     return length;
 }
 
+std::size_t SuperString::UTF8::length(const SuperString::Byte *bytes, std::size_t memoryLength) {
+    return countUTF8Characters(bytes, memoryLength);
+}
+
 SuperString::Pair<std::size_t, std::size_t>
 SuperString::UTF8::lengthAndMemoryLength(const SuperString::Byte *bytes) {
-    std::size_t length = 0;
-    const Byte *pointer = bytes;
-    while(*pointer != 0x00) {
-        if((*pointer & 0xf8) == 0xf0) { pointer += 4; }
-        else if((*pointer & 0xf0) == 0xe0) { pointer += 3; }
-        else if((*pointer & 0xe0) == 0xc0) { pointer += 2; }
-        else if((*pointer & 0x80) == 0x00) { pointer++; }
-        else return Pair<std::size_t, std::size_t>(0, 0); // handle error
-        length++;
-    }
-    return Pair<std::size_t, std::size_t>(length, pointer - bytes + 1);
+    std::size_t length;
+    std::size_t offset = scanUTF8(bytes, &length);
+    return Pair<std::size_t, std::size_t>(length, offset + 1);
 }
 
-SuperString::Result<int, SuperString::Error>
-SuperString::UTF8::codeUnitAt(const SuperString::Byte *bytes, std::size_t index) {
-    std::size_t i = 0;
-    const Byte *pointer = bytes;
-    while(*pointer != 0x00) {
-        int codeUnit = 0;
-        int remainingBytes = 0;
-        if((*pointer & 0xf8) == 0xf0) {
-            codeUnit = *pointer & 0x07;
-            remainingBytes = 3;
-        } else if((*pointer & 0xf0) == 0xe0) {
-            codeUnit = *pointer & 0x0f;
-            remainingBytes = 2;
-        } else if((*pointer & 0xe0) == 0xc0) {
-            codeUnit = *pointer & 0x1f;
-            remainingBytes = 1;
-        } else if((*pointer & 0x80) == 0x00) {
-            codeUnit = *pointer;
-        } else {
-            return Result<int, SuperString::Error>(Error::InvalidByteSequence);
-        }
-        while(remainingBytes-- > 0) {
-            pointer++;
-            codeUnit = codeUnit << 6 | (*pointer & 0x3f);
-        }
-        if(i == index) {
-            return Result<int, SuperString::Error>(codeUnit);
-        }
-        pointer++;
-        i++;
+SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+SuperString::UTF8::validate(const SuperString::Byte *bytes) {
+    std::size_t length;
+    bool isValid;
+    std::size_t offset = validateUTF8(bytes, &length, &isValid);
+    if(!isValid) {
+        return Result<Pair<std::size_t, std::size_t>, std::size_t>(offset);
     }
-    return Result<int, SuperString::Error>(Error::RangeError);
+    return Result<Pair<std::size_t, std::size_t>, std::size_t>(Pair<std::size_t, std::size_t>(length, offset + 1));
 }
 
-void SuperString::UTF8::print(std::ostream &stream, const SuperString::Byte *bytes) {
-    stream << bytes;
+std::size_t SuperString::UTF8::sequenceLength(SuperString::Byte leadByte) {
+    if((leadByte & 0xf8) == 0xf0) { return 4; }
+    else if((leadByte & 0xf0) == 0xe0) { return 3; }
+    else if((leadByte & 0xe0) == 0xc0) { return 2; }
+    else if((leadByte & 0x80) == 0x00) { return 1; }
+    return 0;
 }
 
-void SuperString::UTF8::print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
-                              std::size_t endIndex) {
-    Result<Pair<std::size_t, std::size_t>, Error> result = SuperString::UTF8::rangeIndexes(bytes, startIndex, endIndex);
-    if(result.isOk()) {
-        stream.write(((char *) (bytes + result.ok().first())), result.ok().second() - result.ok().first());
+int SuperString::UTF8::decode(const SuperString::Byte *bytes) {
+    if(*bytes < 0x80) {
+        return *bytes;
+    } else if(*bytes < 0xe0) {
+        return (*bytes & 0x1f) << 6 | (*(bytes + 1) & 0x3f);
+    } else if(*bytes < 0xf0) {
+        return (*bytes & 0x0f) << 12 | (*(bytes + 1) & 0x3f) << 6 | (*(bytes + 2) & 0x3f);
     }
+    return (*bytes & 0x07) << 18 | (*(bytes + 1) & 0x3f) << 12 | (*(bytes + 2) & 0x3f) << 6 | (*(bytes + 3) & 0x3f);
 }
 
-SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, SuperString::Error>
-SuperString::UTF8::rangeIndexes(
-        const SuperString::Byte *bytes, std::size_t startIndex, std::size_t endIndex) {
-    std::size_t i = 0;
-    std::size_t startOffset, endOffset;
-    bool first = false, second = false;
-    const Byte *pointer = bytes;
-    while(*pointer != '\0') {
-        if(!first) {
-            if(i == startIndex) {
-                first = true;
-                startOffset = ((std::size_t) pointer) - ((std::size_t) bytes);
-            }
-        } else {
-            if(i == endIndex) {
-                second = true;
-                endOffset = ((std::size_t) pointer) - ((std::size_t) bytes);
-                break;
-            }
-        }
-        if((*pointer & 0xf8) == 0xf0) { pointer += 4; }
-        else if((*pointer & 0xf0) == 0xe0) { pointer += 3; }
-        else if((*pointer & 0xe0) == 0xc0) { pointer += 2; }
-        else if((*pointer & 0x80) == 0x00) { pointer++; }
-        else return Result<Pair<std::size_t, std::size_t>, Error>(Error::InvalidByteSequence);
-        i++;
+SuperString::Result<int, SuperString::Error>
+SuperString::UTF8::decode(const SuperString::Byte *bytes, const SuperString::Byte *end) {
+    std::size_t length = SuperString::UTF8::sequenceLength(*bytes);
+    if(length == 0 || (std::size_t) (end - bytes) < length) {
+        return Result<int, SuperString::Error>(Error::InvalidByteSequence);
     }
-    if(!second) {
-        if(i == endIndex) {
-            second = true;
-            endOffset = ((std::size_t) pointer) - ((std::size_t) bytes);
+    for(std::size_t i = 1; i < length; i++) {
+        if((*(bytes + i) & 0xc0) != 0x80) {
+            return Result<int, SuperString::Error>(Error::InvalidByteSequence);
         }
     }
-    if(first && second) {
-        return Result<Pair<std::size_t, std::size_t>, Error>(Pair<std::size_t, std::size_t>(startOffset, endOffset));
-    }
-    return Result<Pair<std::size_t, std::size_t>, Error>(Error::RangeError);
+    return Result<int, SuperString::Error>(SuperString::UTF8::decode(bytes));
 }
 
-SuperString::Pair<SuperString::Byte *, std::size_t> SuperString::UTF8::codeUnitToChar(int c) {
-    char numBytes = 0;
-    Byte byte1, byte2, byte3, byte4;
+std::size_t SuperString::UTF8::encode(int c, SuperString::Byte *bytes) {
     if(c < 0x0080) {
-        byte1 = (Byte) c;
-        numBytes = 1;
+        bytes[0] = (Byte) c;
+        return 1;
     } else if(c < 0x0800) {
-        byte1 = (Byte) ((c >> 6) + (((Byte) 0b110) << 5));
-        byte2 = (Byte) ((((Byte) 0x2) << 6) + (c & 0b00000111111));
-        numBytes = 2;
+        bytes[0] = (Byte) (0xc0 | (c >> 6));
+        bytes[1] = (Byte) (0x80 | (c & 0x3f));
+        return 2;
     } else if(c < 0x10000) {
-        byte1 = (Byte) ((c >> 12) + (((Byte) 0b1110) << 4));
-        byte2 = (Byte) ((((Byte) 0x2) << 6) + (c >> 6 & 0b0000111111));
-        byte3 = (Byte) ((((Byte) 0x2) << 6) + (c & 0b0000000000111111));
-        numBytes = 3;
-    } else if(c < 0x200000) {
-        byte1 = (Byte) ((c >> 18) + (((Byte) 0b11110) << 3));
-        byte2 = (Byte) ((((Byte) 0x2) << 6) + (c >> 12 & 0b000111111));
-        byte3 = (Byte) ((((Byte) 0x2) << 6) + (c >> 6 & 0b000000000111111));
-        byte4 = (Byte) ((((Byte) 0x2) << 6) + (c & 0b00000000000000111111));
-        numBytes = 4;
-    }
-    Byte *bytes = new Byte[numBytes];
-    std::size_t j = 0;
-    while(j < numBytes) {
-        switch(j) {
-            case 0:
-                bytes[j] = byte1;
-                break;
-            case 1:
-                bytes[j] = byte2;
-                break;
-            case 2:
-                bytes[j] = byte3;
-                break;
-            case 3:
-                bytes[j] = byte4;
-                break;
-            default:;
-        }
-        j++;
+        bytes[0] = (Byte) (0xe0 | (c >> 12));
+        bytes[1] = (Byte) (0x80 | ((c >> 6) & 0x3f));
+        bytes[2] = (Byte) (0x80 | (c & 0x3f));
+        return 3;
     }
-    return Pair<Byte *, std::size_t>(bytes, numBytes);
+    bytes[0] = (Byte) (0xf0 | (c >> 18));
+    bytes[1] = (Byte) (0x80 | ((c >> 12) & 0x3f));
+    bytes[2] = (Byte) (0x80 | ((c >> 6) & 0x3f));
+    bytes[3] = (Byte) (0x80 | (c & 0x3f));
+    return 4;
 }
 
 // SuperString::UTF16BE
-std::size_t SuperString::UTF16BE::length(const SuperString::Byte *bytes) {
-    const Byte *pointer = bytes;
-    while(*pointer != 0x00 || *(pointer + 1) != 0x00) {
-        pointer += 2;
+// a surrogate pair is one character, counted at its high surrogate
+std::size_t SuperString::UTF16BE::length(const SuperString::Byte *bytes, std::size_t memoryLength) {
+    std::size_t surrogates = 0;
+    for(std::size_t i = 0; i < memoryLength; i += 2) {
+        surrogates += (bytes[i] & 0xfc) == 0xd8;
     }
-    return (pointer - bytes) / 2;
+    return memoryLength / 2 - surrogates;
 }
 
+// a surrogate pair is one character
 SuperString::Pair<std::size_t, std::size_t>
 SuperString::UTF16BE::lengthAndMemoryLength(const SuperString::Byte *bytes) {
+    std::size_t surrogates;
+    std::size_t offset = scanUTF16(bytes, &surrogates, 0);
+    return Pair<std::size_t, std::size_t>(offset / 2 - surrogates, offset + 2);
+}
+
+// surrogates come in pairs, a high one then a low one
+SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+SuperString::UTF16BE::validate(const SuperString::Byte *bytes) {
     std::size_t length = 0;
     const Byte *pointer = bytes;
     while(*pointer != 0x00 || *(pointer + 1) != 0x00) {
-        if((*pointer & 0xfc) == 0xd8) { pointer += 4; }
-        else { pointer += 2; }
+        if((*pointer & 0xfc) == 0xd8 && (*(pointer + 2) & 0xfc) == 0xdc) { pointer += 4; }
+        else if((*pointer & 0xf8) != 0xd8) { pointer += 2; }
+        else break;
         length++;
     }
-    return Pair<std::size_t, std::size_t>(length, pointer - bytes + 2);
+    if(*pointer != 0x00 || *(pointer + 1) != 0x00) {
+        return Result<Pair<std::size_t, std::size_t>, std::size_t>((std::size_t) (pointer - bytes));
+    }
+    return Result<Pair<std::size_t, std::size_t>, std::size_t>(
+            Pair<std::size_t, std::size_t>(length, pointer - bytes + 2));
 }
 
-SuperString::Result<int, SuperString::Error>
-SuperString::UTF16BE::codeUnitAt(const SuperString::Byte *bytes, std::size_t index) {
-    std::size_t i = 0;
-    const Byte *pointer = bytes;
-    while(*pointer != 0x00 || *(pointer + 1) != 0x00) {
-        int codeUnit = 0;
-        if((*pointer & 0xfc) == 0xd8) {
-            codeUnit = (*pointer & 0x03) << 18;
-            codeUnit += *(pointer + 1) << 10;
-            codeUnit += (*(pointer + 2) & 0x03) << 8;
-            codeUnit += *(pointer + 3);
-            pointer += 4;
-        } else {
-            codeUnit = (*pointer << 8) + (*(pointer + 1));
-            pointer += 2;
-        }
-        if(i == index) {
-            return Result<int, SuperString::Error>(codeUnit);
-        }
-        i++;
+std::size_t SuperString::UTF16BE::offset(const SuperString::Byte *bytes, std::size_t index) {
+    std::size_t offset = 0;
+    for(std::size_t i = 0; i < index; i++) {
+        offset += ((bytes[offset] & 0xfc) == 0xd8) ? 4 : 2;
     }
-    return Result<int, SuperString::Error>(Error::RangeError);
+    return offset;
+}
+
+int SuperString::UTF16BE::decode(const SuperString::Byte *bytes) {
+    if((*bytes & 0xfc) == 0xd8) {
+        return 0x10000 + ((*bytes & 0x03) << 18) + (*(bytes + 1) << 10) + ((*(bytes + 2) & 0x03) << 8) +
+               *(bytes + 3);
+    }
+    return (*bytes << 8) + *(bytes + 1);
 }
 
 void SuperString::UTF16BE::print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t length) {
@@ -2173,107 +5833,139 @@ void SuperString::UTF16BE::print(std::ostream &stream, const SuperString::Byte *
 
 void SuperString::UTF16BE::print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
                                  std::size_t endIndex) {
-    std::size_t i = 0;
-    const Byte *pointer = bytes;
-    while((*pointer != 0x00 || *(pointer + 1) != 0x00) && i < endIndex) {
-        int codeUnit = 0;
-        if((*pointer & 0xfc) == 0xd8) {
-            codeUnit = (*pointer & 0x03) << 18;
-            codeUnit += *(pointer + 1) << 10;
-            codeUnit += (*(pointer + 2) & 0x03) << 8;
-            codeUnit += *(pointer + 3);
-            pointer += 4;
-        } else {
-            codeUnit = (*pointer << 8) + (*(pointer + 1));
-            pointer += 2;
-        }
-        if(startIndex <= i) {
-            Pair<Byte *, std::size_t> encoded = SuperString::UTF8::codeUnitToChar(codeUnit);
-            stream.write((const char *) encoded.first(), encoded.second());
-            delete encoded.first();
-        }
-        i++;
-    }
+    std::size_t startOffset = SuperString::UTF16BE::offset(bytes, startIndex);
+    std::size_t memoryLength = SuperString::UTF16BE::offset(bytes + startOffset, endIndex - startIndex);
+    Writer writer(stream);
+    writer.writeUTF16BE(bytes + startOffset, memoryLength);
+    writer.flush();
 }
 
 // SuperString::UTF32
 std::size_t SuperString::UTF32::length(const SuperString::Byte *bytes) {
-    const Byte *pointer = bytes;
-    while(*((int *) pointer) != 0x00) {
-        pointer += 4;
-    }
-    return (pointer - bytes) / 4;
+    return scanUTF32(bytes) / 4;
 }
 
 SuperString::Pair<std::size_t, std::size_t> SuperString::UTF32::lengthAndMemoryLength(
         const SuperString::Byte *bytes) {
-    std::size_t length = 0;
-    const Byte *pointer = bytes;
-    while(*((int *) pointer) != 0x00) {
-        pointer += 4;
-        length++;
+    std::size_t offset = scanUTF32(bytes);
+    return Pair<std::size_t, std::size_t>(offset / 4, offset + 4);
+}
+
+// code points up to U+10FFFF, surrogates excluded
+SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+SuperString::UTF32::validate(const SuperString::Byte *bytes) {
+    const int *pointer = (const int *) bytes;
+    while(*pointer != 0x00) {
+        if(*pointer < 0 || 0x10ffff < *pointer || (0xd800 <= *pointer && *pointer <= 0xdfff)) {
+            break;
+        }
+        pointer++;
+    }
+    std::size_t offset = (const Byte *) pointer - bytes;
+    if(*pointer != 0x00) {
+        return Result<Pair<std::size_t, std::size_t>, std::size_t>(offset);
     }
-    return Pair<std::size_t, std::size_t>(length, pointer - bytes + 4);
+    return Result<Pair<std::size_t, std::size_t>, std::size_t>(Pair<std::size_t, std::size_t>(offset / 4, offset + 4));
 }
 
 int SuperString::UTF32::codeUnitAt(const SuperString::Byte *bytes, std::size_t index) {
     return *(((int *) bytes) + index);
 }
 
-void SuperString::UTF32::print(std::ostream &stream, const SuperString::Byte *bytes) {
-    const Byte *pointer = bytes;
-    while(*((int *) pointer) != 0x00) {
-        int codeUnit = *((int *) pointer);
-        Pair<Byte *, std::size_t> encoded = SuperString::UTF8::codeUnitToChar(codeUnit);
-        stream.write((const char *) encoded.first(), encoded.second());
-        delete encoded.first();
-        pointer += 4;
-    }
-}
-
 void SuperString::UTF32::print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
                                std::size_t endIndex) {
-    for(std::size_t i = startIndex; i < endIndex; i++) {
-        int codeUnit = *(((int *) bytes) + i);
-        Pair<Byte *, std::size_t> encoded = SuperString::UTF8::codeUnitToChar(codeUnit);
-        stream.write((const char *) encoded.first(), encoded.second());
-        delete encoded.first();
-    }
+    Writer writer(stream);
+    writer.writeUTF32(bytes + startIndex * sizeof(int), (endIndex - startIndex) * sizeof(int));
+    writer.flush();
 }
 
 SuperString::Pair<std::size_t, std::size_t>
 SuperString::UTF32::trim(const SuperString::Byte *bytes, std::size_t length) {
-    std::size_t startIndex = 0;
-    std::size_t endIndex = length;
-    int c = *(((const int *) bytes) + startIndex);
-    while(c != 0x00 && SuperString::isWhiteSpace(c)) {
-        c = *(((const int *) bytes) + ++startIndex);
-    }
-    c = *(((const int *) bytes) + (endIndex - 1));
-    while(endIndex > 0 && SuperString::isWhiteSpace(c)) {
-        c = *(((const int *) bytes) + (--endIndex - 1));
-    }
+    std::size_t startIndex = SuperString::UTF32::trimLeft(bytes, length);
+    std::size_t endIndex = startIndex + SuperString::UTF32::trimRight(bytes + startIndex * sizeof(int),
+                                                                      length - startIndex);
     return Pair<std::size_t, std::size_t>(startIndex, endIndex);
 }
 
-std::size_t SuperString::UTF32::trimLeft(const SuperString::Byte *bytes) {
+std::size_t SuperString::UTF32::trimLeft(const SuperString::Byte *bytes, std::size_t length) {
     std::size_t startIndex = 0;
-    int c = *(((const int *) bytes) + startIndex);
-    while(c != 0x00 && SuperString::isWhiteSpace(c)) {
-        c = *(((const int *) bytes) + ++startIndex);
+    while(startIndex < length && SuperString::isWhiteSpace(*(((const int *) bytes) + startIndex))) {
+        startIndex++;
     }
     return startIndex;
 }
 
 std::size_t SuperString::UTF32::trimRight(const SuperString::Byte *bytes, std::size_t length) {
     std::size_t endIndex = length;
-    int c = *(((const int *) bytes) + (endIndex - 1));
-    while(endIndex > 0 && SuperString::isWhiteSpace(c)) {
-        c = *(((const int *) bytes) + (--endIndex - 1));
+    while(endIndex > 0 && SuperString::isWhiteSpace(*(((const int *) bytes) + (endIndex - 1)))) {
+        endIndex--;
     }
     return endIndex;
 }
 
+// SuperString::UTF16LE
+// the same as UTF-16BE, with the high byte of each code unit after its low byte
+std::size_t SuperString::UTF16LE::length(const SuperString::Byte *bytes, std::size_t memoryLength) {
+    std::size_t surrogates = 0;
+    for(std::size_t i = 1; i < memoryLength; i += 2) {
+        surrogates += (bytes[i] & 0xfc) == 0xd8;
+    }
+    return memoryLength / 2 - surrogates;
+}
+
+SuperString::Pair<std::size_t, std::size_t>
+SuperString::UTF16LE::lengthAndMemoryLength(const SuperString::Byte *bytes) {
+    std::size_t surrogates;
+    std::size_t offset = scanUTF16(bytes, &surrogates, 1);
+    return Pair<std::size_t, std::size_t>(offset / 2 - surrogates, offset + 2);
+}
+
+SuperString::Result<SuperString::Pair<std::size_t, std::size_t>, std::size_t>
+SuperString::UTF16LE::validate(const SuperString::Byte *bytes) {
+    std::size_t length = 0;
+    const Byte *pointer = bytes;
+    while(*pointer != 0x00 || *(pointer + 1) != 0x00) {
+        if((*(pointer + 1) & 0xfc) == 0xd8 && (*(pointer + 3) & 0xfc) == 0xdc) { pointer += 4; }
+        else if((*(pointer + 1) & 0xf8) != 0xd8) { pointer += 2; }
+        else break;
+        length++;
+    }
+    if(*pointer != 0x00 || *(pointer + 1) != 0x00) {
+        return Result<Pair<std::size_t, std::size_t>, std::size_t>((std::size_t) (pointer - bytes));
+    }
+    return Result<Pair<std::size_t, std::size_t>, std::size_t>(
+            Pair<std::size_t, std::size_t>(length, pointer - bytes + 2));
+}
+
+std::size_t SuperString::UTF16LE::offset(const SuperString::Byte *bytes, std::size_t index) {
+    std::size_t offset = 0;
+    for(std::size_t i = 0; i < index; i++) {
+        offset += ((bytes[offset + 1] & 0xfc) == 0xd8) ? 4 : 2;
+    }
+    return offset;
+}
+
+int SuperString::UTF16LE::decode(const SuperString::Byte *bytes) {
+    if((*(bytes + 1) & 0xfc) == 0xd8) {
+        return 0x10000 + ((*(bytes + 1) & 0x03) << 18) + (*bytes << 10) + ((*(bytes + 3) & 0x03) << 8) +
+               *(bytes + 2);
+    }
+    return (*(bytes + 1) << 8) + *bytes;
+}
+
+void SuperString::UTF16LE::print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t length) {
+    SuperString::UTF16LE::print(stream, bytes, 0, length);
+}
+
+void SuperString::UTF16LE::print(std::ostream &stream, const SuperString::Byte *bytes, std::size_t startIndex,
+                                 std::size_t endIndex) {
+    std::size_t startOffset = SuperString::UTF16LE::offset(bytes, startIndex);
+    std::size_t memoryLength = SuperString::UTF16LE::offset(bytes + startOffset, endIndex - startIndex);
+    Writer writer(stream);
+    writer.writeUTF16LE(bytes + startOffset, memoryLength);
+    writer.flush();
+}
+
 //
 std::ostream &operator<<(std::ostream &stream, const SuperString &string) {
     string.print(stream);
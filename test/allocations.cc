@@ -0,0 +1,148 @@
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+#include "SuperString.hh"
+
+// counts every heap allocation made by the process
+static std::size_t allocations = 0;
+
+void *operator new(std::size_t size) {
+    allocations++;
+    void *pointer = std::malloc(size == 0 ? 1 : size);
+    if(pointer == NULL) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+// the slabs of sequence nodes are counted too, and those not given back yet
+static std::size_t blocks = 0;
+
+static void *allocateNode(std::size_t size) {
+    allocations++;
+    blocks++;
+    return std::malloc(size);
+}
+
+static void deallocateNode(void *pointer) {
+    blocks--;
+    std::free(pointer);
+}
+
+static long scan(const SuperString &string) {
+    long sum = 0;
+    for(std::size_t i = 0, length = string.length(); i < length; i++) {
+        sum += string.codeUnitAt(i).ok();
+    }
+    return sum;
+}
+
+static bool expectNoAllocation(const char *name, const SuperString &string) {
+    scan(string); // warm up lazily built state (lengths, indexes)
+    std::size_t before = allocations;
+    scan(string);
+    string.codeUnitAt(string.length()); // the error path too
+    std::size_t count = allocations - before;
+    std::cout << name << ": " << count << " allocation(s)\n";
+    return count == 0;
+}
+
+// sequence nodes come back to the pool when dropped, and are reused without allocating
+static bool expectRecycledNodes(const char *name, const SuperString &string) {
+    std::size_t live = SuperString::liveNodes();
+    for(std::size_t i = 0; i < 1000; i++) { // warm up the pool
+        SuperString part = string.substring(i % string.length(), string.length()).ok() + string;
+    }
+    std::size_t before = allocations;
+    for(std::size_t i = 0; i < 1000; i++) {
+        SuperString part = string.substring(i % string.length(), string.length()).ok() + string;
+    }
+    std::size_t count = allocations - before;
+    std::cout << name << ": " << count << " allocation(s), " << (SuperString::liveNodes() - live) << " node(s) left\n";
+    return count == 0 && SuperString::liveNodes() == live;
+}
+
+// the blocks of the nodes dropped after use go back to the allocator once trimmed
+static bool expectTrimmed(const char *name, const SuperString &string) {
+    SuperString::trimNodes();
+    std::size_t before = blocks;
+    std::size_t peak;
+    {
+        SuperString text = string;
+        for(std::size_t i = 0; i < 5000; i++) {
+            text = text + string.substring(i % string.length(), string.length()).ok();
+        }
+        std::vector<SuperString> pieces, batched;
+        SuperString delimited = (string + SuperString::Const(",")) * 5000;
+        delimited.split(SuperString::Const(","), pieces);
+        delimited.split(SuperString::Const(","), batched, true);
+        peak = blocks;
+    }
+    std::size_t size = SuperString::trimNodes();
+    std::cout << name << ": " << (peak - before) << " block(s) taken, " << size << " byte(s) given back, "
+              << (blocks - std::min(blocks, before)) << " left\n";
+    return size > 0 && peak > before && blocks <= before;
+}
+
+#ifdef SUPERSTRING_THREAD_SAFE
+// a thread that only frees the nodes of another one hands them back to it, rather than keep them all
+static bool expectHandedBack(const char *name, const SuperString &string) {
+    std::size_t first = 0;
+    std::size_t last = 0;
+    for(std::size_t round = 0; round < 20; round++) {
+        std::vector<SuperString> strings;
+        std::thread producer([&]() {
+            for(std::size_t i = 0; i < 5000; i++) {
+                strings.push_back(string.substring(i % string.length(), string.length()).ok() + string);
+            }
+        });
+        producer.join();
+        strings.clear();
+        last = blocks;
+        if(round == 0) {
+            first = last;
+        }
+    }
+    std::cout << name << ": " << first << " block(s) after a round, " << last << " after all of them\n";
+    return last <= first + first / 2;
+}
+#endif
+
+int main(int argc, char const *argv[]) {
+    SuperString::setAllocator(allocateNode, deallocateNode);
+    SuperString ascii = SuperString::Copy("Hello, World!", SuperString::Encoding::ASCII);
+    SuperString utf8 = SuperString::Const("h\xc3\xa9llo w\xc3\xb6rld \xe2\x82\xac");
+    SuperString copy = SuperString::Copy("h\xc3\xa9llo w\xc3\xb6rld \xe2\x82\xac");
+    SuperString concatenation = ascii + utf8;
+    SuperString nested = concatenation + copy;
+    SuperString substring = nested.substring(3, 20).ok();
+    SuperString multiple = utf8 * 4;
+
+    bool isOk = true;
+    isOk &= expectNoAllocation("ascii", ascii);
+    isOk &= expectNoAllocation("utf8", utf8);
+    isOk &= expectNoAllocation("copy", copy);
+    isOk &= expectNoAllocation("concatenation", nested);
+    isOk &= expectNoAllocation("substring", substring);
+    isOk &= expectNoAllocation("multiple", multiple);
+    isOk &= expectRecycledNodes("recycled nodes", nested);
+    isOk &= expectTrimmed("trimmed nodes", nested);
+#ifdef SUPERSTRING_THREAD_SAFE
+    isOk &= expectHandedBack("handed back nodes", nested);
+#endif
+    return isOk ? 0 : 1;
+}
@@ -3,32 +3,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <vector>
+#include <deque>
 #include <iostream>
 #include <string>
 
 #include "SuperString.hh"
 
 static void SplitToLines_SuperString(benchmark::State& state) {
-    char *content;
-    // file reading
-    FILE *f = fopen("/Users/btwael/Downloads/longtextfile.txt", "r+");
-    fseek(f, 0, SEEK_END);
-    long fsize = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    content = (char *) malloc(fsize + 1);
-    fread(content, fsize, 1, f);
-    fclose(f);
-
-    SuperString string = SuperString::Const(content, SuperString::Encoding::ASCII);
-    free(content);
+    // file mapping
+    SuperString string = SuperString::Map("/Users/btwael/Downloads/longtextfile.txt", SuperString::Encoding::ASCII,
+                                          SuperString::Access::Sequential).ok();
 
     std::vector<SuperString> lines;
-    SuperString::Size last = 0;
-    for(SuperString::Size i = 0; i < string.length(); i++) {
-        int c = string.codeUnitAt(i).ok();
-        if(c == '\n') {
-            lines.push_back(string.substring(last, i).ok());
-            last = i;
+    std::size_t last = 0;
+    for(SuperString::Cursor cursor = string.begin(); cursor != string.end(); ++cursor) {
+        if(*cursor == '\n') {
+            lines.push_back(string.substring(last, cursor.index()).ok());
+            last = cursor.index();
         }
     }
 }
@@ -62,4 +53,287 @@ static void SplitToLines_std_String(benchmark::State& state) {
 }
 BENCHMARK(SplitToLines_std_String);
 
+// Appends many small pieces one by one, then reads characters at random positions
+static void AppendThenRandomAccess_SuperString(benchmark::State& state) {
+    std::size_t count = (std::size_t) state.range(0);
+    std::vector<SuperString> pieces;
+    for(std::size_t i = 0; i < count; i++) {
+        pieces.push_back(SuperString::Const("0123456789abcdef\n", SuperString::Encoding::ASCII));
+    }
+    for(auto _ : state) {
+        SuperString string = pieces[0];
+        for(std::size_t i = 1; i < count; i++) {
+            string = string + pieces[i];
+        }
+        long sum = 0;
+        std::size_t length = string.length();
+        for(std::size_t i = 0; i < count; i++) {
+            sum += string.codeUnitAt((i * 7919) % length).ok();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(AppendThenRandomAccess_SuperString)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Same as above, with the chain left unbalanced as concatenations were before `join`: each prefix is hidden
+// behind a repetition of one, which `join` does not descend into
+static void AppendThenRandomAccess_Unbalanced_SuperString(benchmark::State& state) {
+    std::size_t count = (std::size_t) state.range(0);
+    std::vector<SuperString> pieces;
+    for(std::size_t i = 0; i < count; i++) {
+        pieces.push_back(SuperString::Const("0123456789abcdef\n", SuperString::Encoding::ASCII));
+    }
+    for(auto _ : state) {
+        SuperString string = pieces[0];
+        for(std::size_t i = 1; i < count; i++) {
+            string = string * 1 + pieces[i];
+        }
+        long sum = 0;
+        std::size_t length = string.length();
+        for(std::size_t i = 0; i < count; i++) {
+            sum += string.codeUnitAt((i * 7919) % length).ok();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(AppendThenRandomAccess_Unbalanced_SuperString)->Arg(1000)->Arg(10000);
+
+static void AppendThenRandomAccess_std_String(benchmark::State& state) {
+    std::size_t count = (std::size_t) state.range(0);
+    for(auto _ : state) {
+        std::string string = "0123456789abcdef\n";
+        for(std::size_t i = 1; i < count; i++) {
+            string += "0123456789abcdef\n";
+        }
+        long sum = 0;
+        std::size_t length = string.size();
+        for(std::size_t i = 0; i < count; i++) {
+            sum += string.at((i * 7919) % length);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(AppendThenRandomAccess_std_String)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Same as above, with the rope flattened into a single leaf before reading
+static void AppendFlattenThenRandomAccess_SuperString(benchmark::State& state) {
+    std::size_t count = (std::size_t) state.range(0);
+    std::vector<SuperString> pieces;
+    for(std::size_t i = 0; i < count; i++) {
+        pieces.push_back(SuperString::Const("0123456789abcdef\n", SuperString::Encoding::ASCII));
+    }
+    for(auto _ : state) {
+        SuperString string = pieces[0];
+        for(std::size_t i = 1; i < count; i++) {
+            string = string + pieces[i];
+        }
+        string = string.flatten();
+        long sum = 0;
+        std::size_t length = string.length();
+        for(std::size_t i = 0; i < count; i++) {
+            sum += string.codeUnitAt((i * 7919) % length).ok();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(AppendFlattenThenRandomAccess_SuperString)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Creates and drops short-lived substrings, mostly node allocation
+static void NodeChurn_SuperString(benchmark::State& state) {
+    SuperString string = SuperString::Const("0123456789abcdef\n", SuperString::Encoding::ASCII) * 64;
+    std::size_t length = string.length();
+    std::size_t i = 0;
+    for(auto _ : state) {
+        SuperString part = string.substring(i % length, length).ok();
+        benchmark::DoNotOptimize(part);
+        i += 17;
+    }
+}
+BENCHMARK(NodeChurn_SuperString);
+
+// Measures a large UTF-8 text, finding its terminator and counting its characters
+static void ConstLength_SuperString(benchmark::State& state) {
+    std::string text;
+    while(text.size() < (std::size_t) state.range(0)) {
+        text += "h\xc3\xa9llo w\xc3\xb6rld \xe2\x82\xac ";
+    }
+    for(auto _ : state) {
+        SuperString string = SuperString::Const(text.c_str());
+        benchmark::DoNotOptimize(string.length());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) text.size());
+}
+BENCHMARK(ConstLength_SuperString)->Arg(1 << 10)->Arg(1 << 20);
+
+// Same as above, with the memory length given, so that there is no terminator to find
+static void ConstKnownLength_SuperString(benchmark::State& state) {
+    std::string text;
+    while(text.size() < (std::size_t) state.range(0)) {
+        text += "h\xc3\xa9llo w\xc3\xb6rld \xe2\x82\xac ";
+    }
+    for(auto _ : state) {
+        SuperString string = SuperString::Const(text.data(), text.size());
+        benchmark::DoNotOptimize(string.length());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) text.size());
+}
+BENCHMARK(ConstKnownLength_SuperString)->Arg(1 << 10)->Arg(1 << 20);
+
+// Searches a needle that only appears at the end of a long rope of log lines
+static void IndexOf_SuperString(benchmark::State& state) {
+    std::deque<std::string> pieces;
+    SuperString string;
+    std::size_t line = 0;
+    while(string.length() < (std::size_t) state.range(0)) {
+        std::string piece;
+        while(piece.size() < (64 << 10)) {
+            piece += "2024-01-01 12:00:00 INFO request id=" + std::to_string(line++) + " served in 12ms\n";
+        }
+        pieces.push_back(piece);
+        string = string + SuperString::Const(pieces.back().c_str(), SuperString::Encoding::ASCII);
+    }
+    string = string + SuperString::Const("ERROR", SuperString::Encoding::ASCII);
+    SuperString needle = SuperString::Const("ERROR", SuperString::Encoding::ASCII);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(string.indexOf(needle));
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) string.length());
+}
+BENCHMARK(IndexOf_SuperString)->Arg(1 << 20)->Arg(1 << 26);
+
+// Searches hundreds of keywords at once in a long rope of log lines
+static void PatternSet_SuperString(benchmark::State& state) {
+    std::deque<std::string> pieces;
+    SuperString string;
+    std::size_t line = 0;
+    while(string.length() < (std::size_t) state.range(0)) {
+        std::string piece;
+        while(piece.size() < (64 << 10)) {
+            piece += "2024-01-01 12:00:00 INFO request id=" + std::to_string(line++) + " served in 12ms\n";
+        }
+        pieces.push_back(piece);
+        string = string + SuperString::Const(pieces.back().c_str(), SuperString::Encoding::ASCII);
+    }
+    std::deque<std::string> keywords;
+    std::vector<SuperString> patterns;
+    for(std::size_t i = 0; i < 500; i++) {
+        keywords.push_back("keyword" + std::to_string(i * 7919));
+        patterns.push_back(SuperString::Const(keywords.back().c_str(), SuperString::Encoding::ASCII));
+    }
+    patterns.push_back(SuperString::Const("id=4242 ", SuperString::Encoding::ASCII));
+    SuperString::PatternSet set(patterns.data(), patterns.size());
+    for(auto _ : state) {
+        std::size_t count = 0;
+        string.forEachMatch(set, [&](std::size_t, std::size_t) -> bool {
+            count++;
+            return true;
+        });
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) string.length());
+}
+BENCHMARK(PatternSet_SuperString)->Arg(1 << 20)->Arg(1 << 26);
+
+// Splits a long rope of log lines into substrings that share its text data
+static void SplitLines_SuperString(benchmark::State& state) {
+    std::deque<std::string> pieces;
+    SuperString string;
+    std::size_t line = 0;
+    while(string.length() < (std::size_t) state.range(0)) {
+        std::string piece;
+        while(piece.size() < (64 << 10)) {
+            piece += "2024-01-01 12:00:00 INFO request id=" + std::to_string(line++) + " served in 12ms\n";
+        }
+        pieces.push_back(piece);
+        string = string + SuperString::Const(pieces.back().c_str());
+    }
+    for(auto _ : state) {
+        std::vector<SuperString> lines;
+        string.splitLines(lines, true);
+        benchmark::DoNotOptimize(lines.data());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) string.length());
+}
+BENCHMARK(SplitLines_SuperString)->Arg(1 << 20)->Arg(1 << 26);
+
+// Same as above, with the text scanned and the substrings made by several threads
+static void ParallelSplitLines_SuperString(benchmark::State& state) {
+    std::deque<std::string> pieces;
+    SuperString string;
+    std::size_t line = 0;
+    while(string.length() < (std::size_t) state.range(0)) {
+        std::string piece;
+        while(piece.size() < (64 << 10)) {
+            piece += "2024-01-01 12:00:00 INFO request id=" + std::to_string(line++) + " served in 12ms\n";
+        }
+        pieces.push_back(piece);
+        string = string + SuperString::Const(pieces.back().c_str());
+    }
+    for(auto _ : state) {
+        std::vector<SuperString> lines;
+        string.splitLines(lines, true, (std::size_t) state.range(1));
+        benchmark::DoNotOptimize(lines.data());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) string.length());
+}
+BENCHMARK(ParallelSplitLines_SuperString)->Args({1 << 26, 1})->Args({1 << 26, 4})->Args({1 << 26, 16})
+                                         ->UseRealTime();
+
+// Prints a long UTF-32 string, transcoded to UTF-8, to a stream that drops it
+static void PrintUTF32_SuperString(benchmark::State& state) {
+    std::vector<int> codeUnits;
+    for(std::size_t i = 0; i < (std::size_t) state.range(0); i++) {
+        codeUnits.push_back((i % 61 == 0) ? 0xe9 : 'a' + (int) (i % 26));
+    }
+    codeUnits.push_back(0);
+    SuperString string = SuperString::Const(codeUnits.data());
+    std::ostream stream(NULL);
+    for(auto _ : state) {
+        stream.clear();
+        stream << string;
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) string.length());
+}
+BENCHMARK(PrintUTF32_SuperString)->Arg(1 << 10)->Arg(1 << 20);
+
+// Same as above, for a long UTF-16LE string
+static void PrintUTF16LE_SuperString(benchmark::State& state) {
+    std::string bytes;
+    for(std::size_t i = 0; i < (std::size_t) state.range(0); i++) {
+        int codeUnit = (i % 61 == 0) ? 0xe9 : 'a' + (int) (i % 26);
+        bytes += (char) codeUnit;
+        bytes += (char) 0;
+    }
+    SuperString string = SuperString::Const(bytes.data(), bytes.size(), SuperString::Encoding::UTF16LE);
+    std::ostream stream(NULL);
+    for(auto _ : state) {
+        stream.clear();
+        stream << string;
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) string.length());
+}
+BENCHMARK(PrintUTF16LE_SuperString)->Arg(1 << 10)->Arg(1 << 20);
+
+// Writes a long rope of log lines to /dev/null, its chunks gathered into a few system calls
+static void WriteTo_SuperString(benchmark::State& state) {
+    std::deque<std::string> pieces;
+    SuperString string;
+    std::size_t line = 0;
+    while(string.length() < (std::size_t) state.range(0)) {
+        std::string piece;
+        while(piece.size() < (64 << 10)) {
+            piece += "2024-01-01 12:00:00 INFO request id=" + std::to_string(line++) + " served in 12ms\n";
+        }
+        pieces.push_back(piece);
+        string = string + SuperString::Const(pieces.back().c_str());
+    }
+    FILE *f = fopen("/dev/null", "w");
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(string.writeTo(f).isOk());
+    }
+    fclose(f);
+    state.SetBytesProcessed((int64_t) state.iterations() * (int64_t) string.length());
+}
+BENCHMARK(WriteTo_SuperString)->Arg(1 << 20)->Arg(1 << 26);
+
 BENCHMARK_MAIN();
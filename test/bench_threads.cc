@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+
+#include "SuperString.hh"
+
+#ifdef SUPERSTRING_THREAD_SAFE
+#define SHARED_BENCHMARK(name) BENCHMARK(name)->ThreadRange(1, 8)
+#else
+// strings can't be shared between threads, only the uncontended cost is measured
+#define SHARED_BENCHMARK(name) BENCHMARK(name)
+#endif
+
+// A string read by all the threads, as a shared configuration or cache entry would be
+static SuperString shared = SuperString::Const("0123456789abcdef\n", SuperString::Encoding::ASCII) * 64 +
+                            SuperString::Copy("h\xc3\xa9llo w\xc3\xb6rld\n", SuperString::Encoding::UTF8);
+
+// Copies and drops the shared string, only its reference count changes
+static void CopyShared_SuperString(benchmark::State& state) {
+    for(auto _ : state) {
+        SuperString copy = shared;
+        benchmark::DoNotOptimize(copy);
+    }
+}
+SHARED_BENCHMARK(CopyShared_SuperString);
+
+// Takes substrings of the shared string, each one is linked to it then unlinked
+static void SubstringShared_SuperString(benchmark::State& state) {
+    std::size_t length = shared.length();
+    std::size_t i = 0;
+    for(auto _ : state) {
+        SuperString part = shared.substring(i % length, length).ok();
+        benchmark::DoNotOptimize(part);
+        i += 17;
+    }
+}
+SHARED_BENCHMARK(SubstringShared_SuperString);
+
+// Reads the shared string with a cursor, that retains the sequences on its path
+static void ScanShared_SuperString(benchmark::State& state) {
+    for(auto _ : state) {
+        long sum = 0;
+        SuperString::Cursor end = shared.end();
+        for(SuperString::Cursor cursor = shared.begin(); cursor != end; ++cursor) {
+            sum += *cursor;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+SHARED_BENCHMARK(ScanShared_SuperString);
+
+BENCHMARK_MAIN();
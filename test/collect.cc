@@ -0,0 +1,62 @@
+#include <sstream>
+#include <string>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// the UTF-8 text of [string]
+static std::string text(const SuperString &string) {
+    std::ostringstream stream;
+    stream << string;
+    return stream.str();
+}
+
+// a substring, a concatenation and a multiple over small parts of [leaf], a large Copy leaf holding the UTF-8
+// [expected], read the same text once it is dropped, and collected unless thread-safe
+static bool expectCollected(const char *name, SuperString leaf, const std::string &expected) {
+    SuperString ascii = SuperString::Const("!", SuperString::Encoding::ASCII);
+    std::size_t length = leaf.length();
+    leaf.codeUnitAt(length - 1); // builds the index of UTF-8 data
+    SuperString substring = leaf.substring(3, 13).ok();
+    SuperString concatenation = leaf.substring(length - 8, length).ok() + ascii;
+    SuperString multiple = leaf.substring(20, 25).ok() * 3;
+    std::string parts[] = {text(substring), text(concatenation), text(multiple)};
+    std::size_t live = SuperString::liveNodes();
+    bool isOk = text(leaf) == expected;
+    leaf = SuperString();
+    std::size_t nodes = SuperString::liveNodes() - live;
+#ifdef SUPERSTRING_THREAD_SAFE
+    // referencers are never reconstructed, the leaf is kept
+    isOk &= nodes == 0;
+#else
+    // the leaf is deleted, each substring of it reconstructed into a leaf of its own
+    isOk &= nodes == 2;
+#endif
+    isOk &= substring.length() == 10 && concatenation.length() == 9 && multiple.length() == 15 &&
+            text(substring) == parts[0] && text(concatenation) == parts[1] && text(multiple) == parts[2];
+    SuperString copy = SuperString::Copy(expected.c_str());
+    isOk &= substring == copy.substring(3, 13).ok() &&
+            concatenation == copy.substring(length - 8, length).ok() + ascii && multiple == copy.substring(20, 25).ok() * 3 && multiple.codeUnitAt(14).ok() == copy.codeUnitAt(24).ok();
+    return expect(name, isOk, std::to_string(nodes) + " node(s) more");
+}
+
+int main(int argc, char const *argv[]) {
+    // "héllo €\U0001F600 " over and over, in UTF-8 and in both byte orders of UTF-16
+    std::string utf8, utf16BE, utf16LE;
+    std::u16string units = u"héllo €\U0001F600 ";
+    for(std::size_t i = 0; i < 200; i++) {
+        utf8 += "h\xc3\xa9llo \xe2\x82\xac\xf0\x9f\x98\x80 ";
+        for(std::size_t j = 0; j < units.size(); j++) {
+            utf16BE += std::string(1, (char) (units[j] >> 8)) + (char) units[j];
+            utf16LE += std::string(1, (char) units[j]) + (char) (units[j] >> 8);
+        }
+    }
+
+    bool isOk = true;
+    isOk &= expectCollected("UTF-8", SuperString::Copy(utf8.c_str()), utf8);
+    isOk &= expectCollected("UTF-8, with a length", SuperString::Copy(utf8.data(), utf8.size()), utf8);
+    isOk &= expectCollected("UTF-16BE", SuperString::Copy(utf16BE.data(), utf16BE.size(),
+                                                          SuperString::Encoding::UTF16BE), utf8);
+    isOk &= expectCollected("UTF-16LE", SuperString::Copy(utf16LE.data(), utf16LE.size(),
+                                                          SuperString::Encoding::UTF16LE), utf8);
+    return isOk ? 0 : 1;
+}
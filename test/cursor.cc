@@ -0,0 +1,86 @@
+#include <string>
+#include <vector>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// walks [string] forwards then backwards, each code unit compared to `codeUnitAt`
+static bool expectWalk(const char *name, const SuperString &string) {
+    std::size_t length = string.length();
+    std::vector<int> codeUnits;
+    for(std::size_t i = 0; i < length; i++) {
+        codeUnits.push_back(string.codeUnitAt(i).ok());
+    }
+    bool isOk = true;
+    std::size_t index = 0;
+    for(SuperString::Cursor cursor = string.begin(); cursor != string.end(); ++cursor, index++) {
+        isOk &= index < length && cursor.index() == index && *cursor == codeUnits[index];
+    }
+    isOk &= index == length;
+    SuperString::Cursor cursor = string.end();
+    while(index > 0) {
+        --cursor;
+        index--;
+        isOk &= cursor.index() == index && *cursor == codeUnits[index];
+    }
+    isOk &= cursor == string.begin();
+    // zigzag, one step back for two steps forward
+    cursor = string.begin();
+    for(std::size_t i = 0; i + 2 < length; i++) {
+        ++cursor;
+        ++cursor;
+        --cursor;
+        isOk &= cursor.index() == i + 1 && *cursor == codeUnits[i + 1];
+    }
+    return expect(name, isOk, std::to_string(length) + " code unit(s)");
+}
+
+// moving past either end keeps the cursor on it
+static bool expectStops(const char *name, const SuperString &string) {
+    SuperString::Cursor cursor = string.begin();
+    --cursor;
+    bool isOk = cursor == string.begin() && cursor.index() == 0;
+    cursor = string.end();
+    ++cursor;
+    cursor++;
+    isOk &= cursor == string.end() && cursor.index() == string.length();
+    if(string.length() > 0) {
+        --cursor;
+        isOk &= cursor.index() == string.length() - 1 && *cursor == string.codeUnitAt(string.length() - 1).ok();
+    }
+    return expect(name, isOk, "stops");
+}
+
+int main(int argc, char const *argv[]) {
+    int codeUnits[] = {'a', 0xe9, 0x1f600, 'z', 0};
+    SuperString ascii = SuperString::Const("Hello", SuperString::Encoding::ASCII);
+    SuperString utf8 = SuperString::Const("h\xc3\xa9llo \xe2\x82\xac \xf0\x9f\x98\x80");
+    SuperString utf16 = SuperString::Const("\x00h\xd8\x3d\xde\x00\x00!", 8, SuperString::Encoding::UTF16BE);
+    SuperString utf32 = SuperString::Const(codeUnits);
+    SuperString concatenation = ascii + utf8 + utf16 + utf32 + ascii;
+    SuperString substring = concatenation.substring(3, 17).ok();
+    SuperString multiple = (utf16 + utf8) * 3;
+    // bytes that cannot start a character, stray continuations and characters cut short, each a code unit
+    SuperString invalid = SuperString::Const("a\xff" "bc");
+    SuperString malformed = SuperString::Copy("\x80x\xc3\xa9\x80\x80\xe2\x82\xac\xe2\x82" "b\xf0\x9f\x98\x80\xc3");
+
+    bool isOk = true;
+    isOk &= expectWalk("leaf", utf8);
+    isOk &= expectWalk("substring of a leaf", utf8.substring(1, 8).ok());
+    isOk &= expectWalk("concatenation", concatenation);
+    isOk &= expectWalk("substring", substring);
+    isOk &= expectWalk("multiple", multiple);
+    isOk &= expectWalk("substring of a multiple", multiple.substring(2, 25).ok());
+    isOk &= expectWalk("nested", (substring + multiple) * 2 + substring.substring(1, 5).ok());
+    bool isDecoded = invalid.length() == 4 && *invalid.begin() == 'a' && *++invalid.begin() ==
+                     invalid.codeUnitAt(1).ok() && *--invalid.end() == 'c';
+    isOk &= expect("invalid, code units", isDecoded, std::to_string(invalid.length()) + " code unit(s)");
+    isOk &= expectWalk("invalid", invalid);
+    isOk &= expectWalk("malformed", malformed);
+    isOk &= expectWalk("malformed, concatenation", utf8 + malformed + invalid + malformed.substring(2, 6).ok());
+    isOk &= expectWalk("malformed, multiple", (invalid + malformed) * 3);
+    isOk &= expectStops("empty", SuperString::Const(""));
+    isOk &= expectStops("leaf ends", utf8);
+    isOk &= expectStops("concatenation ends", concatenation);
+    isOk &= expectStops("multiple ends", multiple);
+    return isOk ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// the largest depth of a balanced tree of [leaves] leaves, where the depths of siblings differ by at most one
+static std::size_t balancedDepth(std::size_t leaves) {
+    std::size_t depth = 0;
+    for(std::size_t fewest = 2, fewer = 1; fewest <= leaves; depth++) { // the fewest leaves of depth + 1
+        std::size_t next = fewest + fewer;
+        fewer = fewest;
+        fewest = next;
+    }
+    return depth;
+}
+
+// [string] holds [expected], no deeper than a balanced tree of [leaves] leaves
+static bool expectBalanced(const char *name, const SuperString &string, const std::string &expected,
+                           std::size_t leaves) {
+    bool isOk = string.depth() <= balancedDepth(leaves) && string == SuperString::Const(expected.c_str());
+    return expect(name, isOk, "depth " + std::to_string(string.depth()) + " of " + std::to_string(leaves) + " leaves");
+}
+
+// [strings] and [texts] with every way of concatenating [leaves] in order, from [start] to [end], all kept
+static void concatenateAll(const std::vector<SuperString> &leaves, std::size_t start, std::size_t end,
+                           std::vector<SuperString> &strings, std::vector<std::string> &texts) {
+    if(end - start == 1) {
+        strings.push_back(leaves[start]);
+        texts.push_back(std::string(1, (char) ('a' + start)));
+        return;
+    }
+    for(std::size_t middle = start + 1; middle < end; middle++) {
+        std::vector<SuperString> lefts, rights;
+        std::vector<std::string> leftTexts, rightTexts;
+        concatenateAll(leaves, start, middle, lefts, leftTexts);
+        concatenateAll(leaves, middle, end, rights, rightTexts);
+        for(std::size_t i = 0; i < lefts.size(); i++) {
+            for(std::size_t j = 0; j < rights.size(); j++) {
+                strings.push_back(lefts[i] + rights[j]);
+                texts.push_back(leftTexts[i] + rightTexts[j]);
+            }
+        }
+        // the sides stay alive, so that none is reconstructed into a leaf
+        strings.insert(strings.end(), lefts.begin(), lefts.end());
+        texts.insert(texts.end(), leftTexts.begin(), leftTexts.end());
+        strings.insert(strings.end(), rights.begin(), rights.end());
+        texts.insert(texts.end(), rightTexts.begin(), rightTexts.end());
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    std::vector<SuperString> leaves;
+    std::string text;
+    for(std::size_t i = 0; i < 4000; i++) {
+        std::string piece = std::to_string(i) + ",";
+        leaves.push_back(SuperString::Copy(piece.c_str(), SuperString::Encoding::ASCII));
+        text += piece;
+    }
+    // appended one by one to the end and to the start, each string dropped for the next one
+    SuperString leftLeaning, rightLeaning;
+    std::string rightText;
+    for(std::size_t i = 0; i < leaves.size(); i++) {
+        leftLeaning = leftLeaning + leaves[i];
+        rightLeaning = leaves[i] + rightLeaning;
+        rightText = std::to_string(i) + "," + rightText;
+    }
+    // joined at random places, every string kept
+    std::vector<SuperString> parts(leaves), kept;
+    std::vector<std::string> partTexts;
+    for(std::size_t i = 0; i < leaves.size(); i++) {
+        partTexts.push_back(std::to_string(i) + ",");
+    }
+    std::srand(42);
+    while(parts.size() > 1) {
+        std::size_t i = (std::size_t) std::rand() % (parts.size() - 1);
+        kept.push_back(parts[i]);
+        kept.push_back(parts[i + 1]);
+        parts[i] = parts[i] + parts[i + 1];
+        partTexts[i] += partTexts[i + 1];
+        parts.erase(parts.begin() + (long) i + 1);
+        partTexts.erase(partTexts.begin() + (long) i + 1);
+    }
+
+    bool isOk = true;
+    isOk &= expectBalanced("left-leaning", leftLeaning, text, leaves.size());
+    isOk &= expectBalanced("right-leaning", rightLeaning, rightText, leaves.size());
+    isOk &= expectBalanced("random", parts[0], partTexts[0], leaves.size());
+    for(std::size_t count = 2; count <= 7; count++) {
+        std::vector<SuperString> strings, small;
+        std::vector<std::string> texts;
+        for(std::size_t i = 0; i < count; i++) {
+            small.push_back(SuperString::Copy(std::string(1, (char) ('a' + i)).c_str()));
+        }
+        concatenateAll(small, 0, count, strings, texts);
+        bool isBalanced = true;
+        for(std::size_t i = 0; i < strings.size(); i++) {
+            isBalanced &= strings[i].depth() <= balancedDepth(texts[i].size()) &&
+                          strings[i] == SuperString::Const(texts[i].c_str());
+        }
+        isOk &= expect(("every order, " + std::to_string(count) + " leaves").c_str(), isBalanced,
+                       std::to_string(strings.size()) + " string(s)");
+    }
+    return isOk ? 0 : 1;
+}
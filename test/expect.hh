@@ -0,0 +1,15 @@
+#ifndef BOUTGLAY_SUPERSTRING_TEST_EXPECT_HEADER
+#define BOUTGLAY_SUPERSTRING_TEST_EXPECT_HEADER
+
+#include <iostream>
+#include <string>
+
+/**
+ * Prints the outcome of the check called [name], [found] telling what it found, and returns [isOk].
+ */
+inline bool expect(const char *name, bool isOk, const std::string &found) {
+    std::cout << name << ": " << found << (isOk ? "" : " FAILED") << "\n";
+    return isOk;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include <sstream>
+#include <string>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// the UTF-8 text of [string]
+static std::string text(const SuperString &string) {
+    std::ostringstream stream;
+    stream << string;
+    return stream.str();
+}
+
+// [string] flattens into a single leaf in [encoding] holding the same text, the string itself unchanged
+static bool expectFlattened(const char *name, const SuperString &string, SuperString::Encoding encoding,
+                            bool isUTF8 = false) {
+    std::string expected = text(string);
+    std::size_t length = string.length();
+    SuperString flattened = string.flatten(isUTF8);
+    std::size_t chunks = 0;
+    bool isOk = true;
+    flattened.forEachChunk([&](const SuperString::Chunk &chunk) -> bool {
+        chunks++;
+        isOk &= chunk.encoding() == encoding && chunk.length() == length;
+        return true;
+    });
+    isOk &= chunks == ((length > 0) ? 1 : 0) && flattened.length() == length && text(flattened) == expected &&
+            flattened == string && string.length() == length && text(string) == expected;
+    for(std::size_t i = 0; isOk && i < length; i++) {
+        isOk &= flattened.codeUnitAt(i).ok() == string.codeUnitAt(i).ok();
+    }
+    return expect(name, isOk, std::to_string(length) + " code unit(s)");
+}
+
+int main(int argc, char const *argv[]) {
+    int codeUnits[] = {'z', 0x1f600, 0};
+    SuperString ascii = SuperString::Const("Hello", SuperString::Encoding::ASCII);
+    SuperString utf8 = SuperString::Const(" w\xc3\xb6rld");
+    SuperString euro = SuperString::Const("\x20\xac", 2, SuperString::Encoding::UTF16LE);
+    SuperString utf32 = SuperString::Const(codeUnits);
+    SuperString::Encoding ASCII = SuperString::Encoding::ASCII, UTF8 = SuperString::Encoding::UTF8,
+            UTF16BE = SuperString::Encoding::UTF16BE, UTF32 = SuperString::Encoding::UTF32;
+
+    bool isOk = true;
+    isOk &= expectFlattened("ASCII concatenation", ascii + SuperString::Const(" world") + ascii, ASCII);
+    isOk &= expectFlattened("ASCII repetition", (ascii + SuperString::Const("!")) * 5, ASCII);
+    isOk &= expectFlattened("Latin-1 concatenation", ascii + utf8, UTF16BE);
+    isOk &= expectFlattened("UCS-2 repetition", (utf8 + euro) * 3, UTF16BE);
+    isOk &= expectFlattened("UTF-32 concatenation", ascii + utf8 + euro + utf32, UTF32);
+    isOk &= expectFlattened("UTF-32 repetition", (euro + utf32) * 4, UTF32);
+    isOk &= expectFlattened("ASCII substring", (utf8 + ascii + utf32).substring(6, 10).ok(), ASCII);
+    isOk &= expectFlattened("nested", ((ascii + utf8) * 2 + euro).substring(3, 20).ok() * 2, UTF16BE);
+    isOk &= expectFlattened("UTF-8 concatenation", ascii + utf8 + euro + utf32, UTF8, true);
+    isOk &= expectFlattened("UTF-8 repetition", (utf8 + ascii) * 3, UTF8, true);
+    // ASCII text is already in UTF-8
+    isOk &= expectFlattened("UTF-8 repetition, ASCII", ascii * 3, ASCII, true);
+    isOk &= expectFlattened("empty repetition", SuperString::Const("") * 3, ASCII);
+    // a leaf stays as it is, a UTF-8 one included
+    isOk &= expectFlattened("leaf", utf32, UTF32);
+    isOk &= expectFlattened("UTF-8 leaf", utf8, UTF8, true);
+    // the other handles on a flattened node still read the same text
+    SuperString shared = (ascii + utf8) * 2;
+    SuperString other = shared;
+    shared.flatten();
+    bool isSame = other == (ascii + utf8 + ascii + utf8) && text(other) == text(shared);
+    isOk &= expect("shared", isSame, "same");
+    return isOk ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include <string>
+#include <vector>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// the same text, however it is built, hashes the same and is equal, before and after hashing
+static bool expectSame(const char *name, const std::vector<SuperString> &strings) {
+    bool isOk = true;
+    for(std::size_t i = 0; i < strings.size(); i++) {
+        isOk &= strings[i] == strings[0] && strings[0] == strings[i];
+    }
+    for(std::size_t i = 0; i < strings.size(); i++) {
+        isOk &= strings[i].hash() == strings[0].hash();
+    }
+    for(std::size_t i = 0; i < strings.size(); i++) {
+        isOk &= strings[i] == strings[0] && strings[0] == strings[i] && strings[i].compareTo(strings[0]) == 0;
+    }
+    return expect(name, isOk, std::to_string(strings.size()) + " string(s)");
+}
+
+// [a] and [b] differ, with or without their hashes
+static bool expectDifferent(const char *name, const SuperString &a, const SuperString &b) {
+    bool isOk = !(a == b) && !(b == a);
+    a.hash();
+    isOk &= !(a == b) && !(b == a);
+    b.hash();
+    isOk &= !(a == b) && !(b == a) && a.compareTo(b) != 0;
+    return expect(name, isOk, "different");
+}
+
+int main(int argc, char const *argv[]) {
+    int codeUnits[] = {'h', 0xe9, 'l', 'l', 'o', ' ', 0x20ac, 0x1f600, 0};
+    SuperString utf8 = SuperString::Const("h\xc3\xa9llo \xe2\x82\xac\xf0\x9f\x98\x80");
+    SuperString utf16 = SuperString::Const("\x00h\x00\xe9\x00l\x00l\x00o\x00 \x20\xac\xd8\x3d\xde\x00", 18,
+                                           SuperString::Encoding::UTF16BE);
+    SuperString utf32 = SuperString::Const(codeUnits);
+    SuperString concatenation = SuperString::Const("h\xc3\xa9l") + SuperString::Const("lo ") +
+                                SuperString::Const("\x20\xac\xd8\x3d\xde\x00", 6, SuperString::Encoding::UTF16BE);
+    SuperString wide = SuperString::Const("xxh\xc3\xa9llo \xe2\x82\xac\xf0\x9f\x98\x80xx");
+    SuperString abc = SuperString::Const("abc", SuperString::Encoding::ASCII);
+    SuperString empty = SuperString::Const("");
+
+    bool isOk = true;
+    isOk &= expectSame("encodings", {utf8, utf16, utf32, SuperString::Copy(codeUnits)});
+    isOk &= expectSame("concatenation and leaf", {utf8, concatenation, concatenation.flatten()});
+    isOk &= expectSame("substring", {utf8, wide.substring(2, 10).ok(), (abc + utf16 + abc).substring(3, 11).ok()});
+    isOk &= expectSame("multiple", {abc * 4, abc + abc + abc + abc, (abc + abc) * 2, (abc * 2) + abc.substr(0, 1) +
+                                                                                     SuperString::Const("bcabc")});
+    isOk &= expectSame("empty", {empty, SuperString(), utf8.substring(3, 3).ok(), empty * 3});
+    isOk &= expectDifferent("same length", utf8, SuperString::Const("h\xc3\xa9llo \xe2\x82\xac\xf0\x9f\x98\x81"));
+    isOk &= expectDifferent("same length, concatenation", concatenation, wide.substring(1, 9).ok());
+    isOk &= expectDifferent("other length", utf8, wide);
+    isOk &= expectDifferent("empty and not", abc, SuperString());
+    // an empty string with its hash, against one without any sequence
+    SuperString hashed = SuperString::Const("");
+    hashed.hash();
+    bool isEqual = hashed == SuperString() && SuperString() == hashed;
+    isOk &= expect("hashed empty and default", isEqual, "equal");
+    return isOk ? 0 : 1;
+}
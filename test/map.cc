@@ -0,0 +1,61 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// maps a temporary file holding [bytes] in [encoding], and compares it to [expected] and to a copy of [bytes]
+static bool expectMapped(const char *name, const std::string &bytes, SuperString::Encoding encoding,
+                         const SuperString &expected, SuperString::Access access = SuperString::Access::Normal) {
+    char path[] = "/tmp/SuperString.test.map.XXXXXX";
+    int fd = mkstemp(path);
+    bool isOk = ::write(fd, bytes.data(), bytes.size()) == (ssize_t) bytes.size();
+    ::close(fd);
+    SuperString::Result<SuperString, SuperString::Error> result = SuperString::Map(path, encoding, access);
+    unlink(path);
+    isOk &= result.isOk();
+    std::size_t length = 0;
+    if(isOk) {
+        SuperString string = result.ok();
+        length = string.length();
+        SuperString copy = SuperString::Copy(bytes.data(), bytes.size(), encoding);
+        isOk &= length == expected.length() && string == expected && string == copy && string.hash() == copy.hash();
+        if(length > 0) {
+            isOk &= string.codeUnitAt(length - 1).ok() == expected.codeUnitAt(length - 1).ok();
+        }
+        // a substring outlives the mapping, which is then released
+        SuperString tail = string.substring(length / 2, length).ok();
+        string = SuperString();
+        isOk &= tail == expected.substring(length / 2, length).ok();
+    }
+    return expect(name, isOk, std::to_string(length) + " code unit(s)");
+}
+
+int main(int argc, char const *argv[]) {
+    std::size_t pageSize = (std::size_t) sysconf(_SC_PAGESIZE);
+    std::string text = "h\xc3\xa9llo \xe2\x82\xac\xf0\x9f\x98\x80\nworld\n";
+    // exactly one and two pages, the terminator is then on a page of its own
+    std::string page(pageSize - 1, 'a');
+    page += 'z';
+    std::string pages = page + std::string(pageSize - 2, 'b') + "\xc3\xa9";
+    // "hé\U0001F600" and a stray byte
+    std::string utf16BE("\x00h\x00\xe9\xd8\x3d\xde\x00!", 9);
+    std::string utf16LE("h\x00\xe9\x00\x3d\xd8\x00\xde!", 9);
+    SuperString utf16 = SuperString::Const(utf16BE.data(), 8, SuperString::Encoding::UTF16BE);
+
+    bool isOk = true;
+    isOk &= expectMapped("UTF-8", text, SuperString::Encoding::UTF8, SuperString::Const(text.c_str()));
+    isOk &= expectMapped("sequential", text, SuperString::Encoding::UTF8, SuperString::Const(text.c_str()),
+                         SuperString::Access::Sequential);
+    isOk &= expectMapped("random", text, SuperString::Encoding::UTF8, SuperString::Const(text.c_str()),
+                         SuperString::Access::Random);
+    isOk &= expectMapped("empty", "", SuperString::Encoding::UTF8, SuperString::Const(""));
+    isOk &= expectMapped("one page", page, SuperString::Encoding::ASCII, SuperString::Const(page.c_str()));
+    isOk &= expectMapped("two pages", pages, SuperString::Encoding::UTF8, SuperString::Const(pages.c_str()));
+    isOk &= expectMapped("UTF-16BE, odd length", utf16BE, SuperString::Encoding::UTF16BE, utf16);
+    isOk &= expectMapped("UTF-16LE, odd length", utf16LE, SuperString::Encoding::UTF16LE, utf16);
+    bool isError = SuperString::Map("/nonexistent/SuperString.test.map").isErr();
+    isOk &= expect("nonexistent path", isError, "error");
+    return isOk ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <cstring>
+#include <sstream>
+#include <string>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// [string] holds [expected] code points, NULs included, and prints as the UTF-8 [bytes]
+static bool expectText(const char *name, const SuperString &string, const std::u32string &expected,
+                       const std::string &bytes) {
+    bool isOk = string.length() == expected.size();
+    for(std::size_t i = 0; isOk && i < expected.size(); i++) {
+        isOk &= string.codeUnitAt(i).ok() == (int) expected[i];
+    }
+    std::ostringstream stream;
+    stream << string;
+    isOk &= stream.str() == bytes;
+    return expect(name, isOk, std::to_string(string.length()) + " code unit(s)");
+}
+
+int main(int argc, char const *argv[]) {
+    // "a\0b\0\0é\0" in every encoding, with no terminator after it
+    std::string utf8("a\0b\0\0\xc3\xa9\0", 8);
+    std::string utf16BE("\0a\0\0\0b\0\0\0\0\0\xe9\0\0", 14);
+    std::string utf16LE("a\0\0\0b\0\0\0\0\0\xe9\0\0\0", 14);
+    int codeUnits[] = {'a', 0, 'b', 0, 0, 0xe9, 0};
+    std::u32string expected(U"a\0b\0\0é\0", 7);
+    char unterminated[8];
+    std::memcpy(unterminated, utf8.data(), sizeof(unterminated));
+    SuperString ascii = SuperString::Const("a\0b\0\0", 5, SuperString::Encoding::ASCII);
+    SuperString constUTF8 = SuperString::Const(unterminated, sizeof(unterminated));
+    SuperString copyUTF8 = SuperString::Copy(utf8.data(), utf8.size());
+    SuperString constUTF16BE = SuperString::Const(utf16BE.data(), utf16BE.size(), SuperString::Encoding::UTF16BE);
+    SuperString copyUTF16LE = SuperString::Copy(utf16LE.data(), utf16LE.size(), SuperString::Encoding::UTF16LE);
+    SuperString utf32 = SuperString::Const((const char *) codeUnits, sizeof(codeUnits), SuperString::Encoding::UTF32);
+
+    bool isOk = true;
+    isOk &= expectText("ASCII", ascii, expected.substr(0, 5), utf8.substr(0, 5));
+    isOk &= expectText("UTF-8, const", constUTF8, expected, utf8);
+    isOk &= expectText("UTF-8, copy", copyUTF8, expected, utf8);
+    isOk &= expectText("UTF-16BE", constUTF16BE, expected, utf8);
+    isOk &= expectText("UTF-16LE", copyUTF16LE, expected, utf8);
+    isOk &= expectText("UTF-32", utf32, expected, utf8);
+    isOk &= expectText("substring", constUTF8.substring(1, 6).ok(), expected.substr(1, 5), utf8.substr(1, 6));
+    isOk &= expectText("substring to the end", constUTF16BE.substring(3, 7).ok(), expected.substr(3), utf8.substr(3));
+    isOk &= expectText("concatenation", ascii + utf32, expected.substr(0, 5) + expected, utf8.substr(0, 5) + utf8);
+    isOk &= expectText("flattened", (ascii + copyUTF16LE).flatten(), expected.substr(0, 5) + expected,
+                       utf8.substr(0, 5) + utf8);
+    // equal across encodings, the NULs compared as any other character
+    bool isEqual = constUTF8 == copyUTF8 && constUTF8 == constUTF16BE && constUTF8 == copyUTF16LE &&
+                   constUTF8 == utf32 && constUTF8.hash() == utf32.hash() && ascii == constUTF8.substring(0, 5).ok() &&
+                   !(constUTF8 == ascii) && !(constUTF8 == SuperString::Const("a")) &&
+                   !(constUTF8.substring(0, 4).ok() == SuperString::Const("a\0b\0c", 5)) &&
+                   constUTF8.substring(0, 4).ok().compareTo(SuperString::Const("a\0b\0c", 5)) < 0;
+    isOk &= expect("equality", isEqual, "equal");
+    bool isFound = constUTF16BE.indexOf(SuperString::Const("\0\0", 2)).ok() == 3 &&
+                   constUTF16BE.lastIndexOf(SuperString::Const("\0", 1)).ok() == 6 &&
+                   constUTF16BE.count(SuperString::Const("\0", 1)) == 4;
+    isOk &= expect("search", isFound, "found");
+    // the last character cut short at the end of the text data, which has nothing after it
+    char truncated[3];
+    std::memcpy(truncated, "a\xf0\x9f", sizeof(truncated));
+    SuperString cut = SuperString::Const(truncated, sizeof(truncated));
+    bool isDecoded = cut.length() == 2 && cut.codeUnitAt(0).ok() == 'a' && cut.codeUnitAt(1).isErr();
+    std::size_t index = 0;
+    for(SuperString::Cursor cursor = cut.begin(); isDecoded && cursor != cut.end(); ++cursor, index++) {
+        isDecoded &= *cursor == cut.codeUnitAt(index).ok();
+    }
+    isOk &= expect("truncated", isDecoded && index == 2, std::to_string(index) + " code unit(s)");
+    return isOk ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SuperString.hh"
+#include "expect.hh"
+
+typedef std::vector<std::pair<std::size_t, std::size_t>> Matches;
+
+// the (pattern, index) of each occurrence of [patterns] in [text], overlapping ones included
+static Matches bruteForce(const std::vector<std::string> &patterns, const std::string &text) {
+    Matches matches;
+    for(std::size_t pattern = 0; pattern < patterns.size(); pattern++) {
+        std::size_t length = patterns[pattern].size();
+        for(std::size_t index = 0; length > 0 && index + length <= text.size(); index++) {
+            if(text.compare(index, length, patterns[pattern]) == 0) {
+                matches.push_back(std::make_pair(pattern, index));
+            }
+        }
+    }
+    return matches;
+}
+
+static bool expectMatches(const char *name, const std::vector<std::string> &patterns, const SuperString &string,
+                          const Matches &expected) {
+    std::vector<SuperString> strings;
+    for(std::size_t i = 0; i < patterns.size(); i++) {
+        strings.push_back(SuperString::Const(patterns[i].c_str()));
+    }
+    SuperString::PatternSet set(strings.data(), strings.size());
+    Matches matches;
+    string.forEachMatch(set, [&](std::size_t pattern, std::size_t index) -> bool {
+        matches.push_back(std::make_pair(pattern, index));
+        return true;
+    });
+    // in the order they end, those ending at the same index in any order
+    bool isOk = true;
+    for(std::size_t i = 1; i < matches.size(); i++) {
+        isOk &= matches[i - 1].second + strings[matches[i - 1].first].length() <=
+                matches[i].second + strings[matches[i].first].length();
+    }
+    Matches sorted = matches, sortedExpected = expected;
+    std::sort(sorted.begin(), sorted.end());
+    std::sort(sortedExpected.begin(), sortedExpected.end());
+    isOk &= sorted == sortedExpected;
+    return expect(name, isOk, std::to_string(matches.size()) + " match(es)");
+}
+
+static bool expectMatches(const char *name, const std::vector<std::string> &patterns, const std::string &text,
+                          std::size_t size) {
+    SuperString string;
+    for(std::size_t i = 0; i < text.size(); i += size) {
+        string = string + SuperString::Copy(text.substr(i, size).c_str());
+    }
+    return expectMatches(name, patterns, string, bruteForce(patterns, text));
+}
+
+int main(int argc, char const *argv[]) {
+    std::vector<std::string> prefixes = {"a", "ab", "abc", "abcd", "b", "bc", "c"};
+    std::vector<std::string> keywords = {"he", "she", "his", "hers", "her", "e"};
+    int codeUnits[] = {'c', 0xe9, 0x20ac, 0x1f600, 'c', 0xe9, 0};
+
+    bool isOk = true;
+    isOk &= expectMatches("prefixes of each other", prefixes, "xabcdabcabx", 100);
+    isOk &= expectMatches("prefixes across chunks", prefixes, "xabcdabcabx", 1);
+    isOk &= expectMatches("keywords", keywords, "ushers and his sheriff, hershe", 100);
+    isOk &= expectMatches("keywords across chunks", keywords, "ushers and his sheriff, hershe", 3);
+    isOk &= expectMatches("overlapping", {"aa", "aaa"}, "aaaaa", 2);
+    isOk &= expectMatches("duplicates", {"ab", "ab", "b"}, "abab", 1);
+    isOk &= expectMatches("empty patterns", {"", "a", ""}, "banana", 2);
+    isOk &= expectMatches("pattern longer than the text", {"banana split"}, "banana", 1);
+    isOk &= expectMatches("no pattern", {}, "banana", 1);
+    isOk &= expectMatches("empty text", {"a"}, "", 1);
+    // the patterns in UTF-8, the text in UTF-32, UTF-16BE and UTF-16LE
+    std::vector<std::string> unicode = {"\xc3\xa9\xe2\x82\xac", "\xe2\x82\xac\xf0\x9f\x98\x80", "c\xc3\xa9"};
+    Matches expected = {{2, 0}, {0, 1}, {1, 2}, {2, 4}};
+    isOk &= expectMatches("UTF-32 text", unicode, SuperString::Const(codeUnits), expected);
+    isOk &= expectMatches("UTF-16 texts", unicode,
+                          SuperString::Const("\x00" "c\x00\xe9\x20\xac", 6, SuperString::Encoding::UTF16BE) +
+                          SuperString::Const("\x3d\xd8\x00\xde" "c\x00\xe9\x00", 8, SuperString::Encoding::UTF16LE),
+                          expected);
+    return isOk ? 0 : 1;
+}
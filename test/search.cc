@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "SuperString.hh"
+#include "expect.hh"
+
+static const std::size_t NOT_FOUND = (std::size_t) -1;
+
+static std::size_t found(const SuperString::Result<std::size_t, SuperString::Error> &result) {
+    return result.isOk() ? result.ok() : NOT_FOUND;
+}
+
+static bool expectSearch(const char *name, const SuperString &string, const SuperString &needle, std::size_t first,
+                         std::size_t last, std::size_t count) {
+    bool isOk = found(string.indexOf(needle)) == first && found(string.indexOf(needle, 4)) == first &&
+                found(string.lastIndexOf(needle)) == last && string.count(needle) == count &&
+                string.count(needle, 4) == count;
+    return expect(name, isOk, "first " + std::to_string((long) found(string.indexOf(needle))) + ", last " +
+                              std::to_string((long) found(string.lastIndexOf(needle))) + ", " +
+                              std::to_string(string.count(needle)) + " occurrence(s)");
+}
+
+static bool expectPieces(const char *name, const SuperString &string, const SuperString &delimiter,
+                         const std::vector<std::string> &expected) {
+    std::vector<SuperString> pieces;
+    string.split(delimiter, pieces);
+    std::vector<SuperString> batched;
+    string.split(delimiter, batched, true, 4);
+    bool isOk = pieces.size() == expected.size() && batched.size() == expected.size();
+    for(std::size_t i = 0; isOk && i < expected.size(); i++) {
+        SuperString piece = SuperString::Const(expected[i].c_str());
+        isOk &= pieces[i] == piece && batched[i] == piece;
+    }
+    return expect(name, isOk, std::to_string(pieces.size()) + " piece(s)");
+}
+
+// the empty pieces of [string] split at [delimiter], or into lines when [delimiter] is empty, sequentially
+// and by [threads], work as any empty string
+static bool expectEmptyPieces(const char *name, const SuperString &string, const SuperString &delimiter,
+                              std::size_t threads) {
+    std::vector<SuperString> pieces, parallel;
+    if(delimiter.length() == 0) {
+        string.splitLines(pieces);
+        string.splitLines(parallel, false, threads);
+    } else {
+        string.split(delimiter, pieces);
+        string.split(delimiter, parallel, false, threads);
+    }
+    pieces.insert(pieces.end(), parallel.begin(), parallel.end());
+    SuperString text = SuperString::Const("text");
+    std::size_t empties = 0;
+    bool isOk = pieces.size() == 2 * parallel.size();
+    for(std::size_t i = 0; i < pieces.size(); i++) {
+        if(pieces[i].length() > 0) {
+            continue;
+        }
+        empties++;
+        SuperString piece = pieces[i];
+        isOk &= piece == SuperString::Const("") && (piece * 3).length() == 0 && (piece * 3) == piece &&
+                piece.substring(0, 0).isOk() && piece.substring(0, 0).ok().length() == 0 &&
+                (piece + text) == text && (text + piece) == text && (text + piece * 2 + text).length() == 8 &&
+                piece.hash() == SuperString::Const("").hash() && piece.flatten().length() == 0;
+    }
+    isOk &= empties > 0 && empties % 2 == 0;
+    return expect(name, isOk, std::to_string(empties) + " empty piece(s)");
+}
+
+// every needle cut from [text], searched in [text] made of pieces of [size] code units
+static bool expectAllNeedles(const char *name, const std::string &text, std::size_t size,
+                             SuperString::Encoding encoding) {
+    SuperString string;
+    for(std::size_t i = 0; i < text.size(); i += size) {
+        string = string + SuperString::Copy(text.substr(i, size).c_str(), encoding);
+    }
+    bool isOk = true;
+    for(std::size_t start = 0; start < text.size(); start++) {
+        for(std::size_t length = 1; start + length <= text.size() && length <= 9; length++) {
+            std::string needle = text.substr(start, length);
+            SuperString needleString = SuperString::Const(needle.c_str());
+            std::size_t first = text.find(needle);
+            std::size_t last = text.rfind(needle);
+            std::size_t count = 0;
+            for(std::size_t i = text.find(needle); i != std::string::npos; i = text.find(needle, i + length)) {
+                count++;
+            }
+            isOk &= found(string.indexOf(needleString)) == first && found(string.lastIndexOf(needleString)) == last &&
+                    string.count(needleString) == count;
+        }
+    }
+    return expect(name, isOk, "found");
+}
+
+// the UTF-8 [text] with "needle" across each boundary of the partitions scanned by the threads, and runs of
+// "xy" across one of them, the rest of it made of [filler]
+static std::string partitioned(const std::string &filler) {
+    std::size_t partition = 1 << 18;
+    std::string text;
+    for(std::size_t k = 1; k <= 5; k++) {
+        while(text.size() + filler.size() <= k * partition - 5) {
+            text += filler;
+        }
+        text.append(k * partition - 5 - text.size(), '.');
+        text += (k == 3) ? "xyxyxyxyxyx" : "..needle";
+    }
+    return text + filler;
+}
+
+// [needle] is found in [string], holding the UTF-8 [text], by 4 threads as it is by one, and where it is in [text]
+static bool expectParallelSearch(const char *name, const SuperString &string, const std::string &text,
+                                 const char *needle) {
+    SuperString needleString = SuperString::Const(needle);
+    std::size_t length = needleString.length();
+    // the index of each occurrence, in code units
+    std::vector<std::size_t> indexes;
+    for(std::size_t i = text.find(needle), index = 0, offset = 0; i != std::string::npos;
+        i = text.find(needle, i + std::string(needle).size())) {
+        for(; offset < i; offset++) {
+            index += (text[offset] & 0xc0) != 0x80;
+        }
+        indexes.push_back(index);
+    }
+    std::vector<SuperString> pieces, parallel;
+    string.split(needleString, pieces);
+    string.split(needleString, parallel, true, 4);
+    bool isOk = !indexes.empty() && found(string.indexOf(needleString, 4)) == indexes.front() &&
+                found(string.indexOf(needleString)) == indexes.front() && string.count(needleString, 4) ==
+                indexes.size() && string.count(needleString) == indexes.size() && pieces.size() == indexes.size() + 1 &&
+                parallel.size() == pieces.size();
+    for(std::size_t i = 0, startIndex = 0; isOk && i < pieces.size(); i++) {
+        std::size_t endIndex = (i < indexes.size()) ? indexes[i] : string.length();
+        isOk &= parallel[i] == pieces[i] && pieces[i] == string.substring(startIndex, endIndex).ok();
+        startIndex = endIndex + length;
+    }
+    return expect(name, isOk, std::to_string(indexes.size()) + " occurrence(s) in " + std::to_string(text.size()) +
+                              " byte(s)");
+}
+
+int main(int argc, char const *argv[]) {
+    SuperString aaaa = SuperString::Const("aaaa");
+    SuperString aa = SuperString::Const("aa");
+    SuperString empty = SuperString::Const("");
+    // "héllo €\U0001F600" in UTF-16BE and in UTF-32, the needles in UTF-8
+    SuperString utf16 = SuperString::Const("\x00h\x00\xe9\x00l\x00l\x00o\x00 \x20\xac\xd8\x3d\xde\x00", 18,
+                                           SuperString::Encoding::UTF16BE);
+    int codeUnits[] = {'h', 0xe9, 'l', 'l', 'o', ' ', 0x20ac, 0x1f600, 0};
+    SuperString utf32 = SuperString::Const(codeUnits);
+    SuperString euro = SuperString::Const("\xe2\x82\xac\xf0\x9f\x98\x80");
+    // chunks of every encoding, a needle across all of them
+    SuperString rope = SuperString::Const("xxab", SuperString::Encoding::ASCII) + SuperString::Const("c\xc3\xa9") +
+                       SuperString::Const("\x00\xe9\x00" "d", 4, SuperString::Encoding::UTF16BE) +
+                       SuperString::Const("\xe9\x00" "d\x00", 4, SuperString::Encoding::UTF16LE) + utf32;
+    SuperString across = SuperString::Const("bc\xc3\xa9\xc3\xa9" "d\xc3\xa9" "dh");
+
+    bool isOk = true;
+    isOk &= expectSearch("overlapping", aaaa, aa, 0, 2, 2);
+    isOk &= expectSearch("overlapping, odd", SuperString::Const("aaa"), aa, 0, 1, 1);
+    isOk &= expectSearch("overlapping, periodic", SuperString::Const("abababab"), SuperString::Const("abab"), 0, 4, 2);
+    isOk &= expectSearch("empty needle", aaaa, empty, 0, 4, 0);
+    isOk &= expectSearch("default needle", aaaa, SuperString(), 0, 4, 0);
+    isOk &= expectSearch("empty in empty", empty, empty, 0, 0, 0);
+    isOk &= expectSearch("needle longer than the text", aa, aaaa, NOT_FOUND, NOT_FOUND, 0);
+    isOk &= expectSearch("needle in empty", empty, aa, NOT_FOUND, NOT_FOUND, 0);
+    isOk &= expectSearch("UTF-8 in UTF-16BE", utf16, euro, 6, 6, 1);
+    isOk &= expectSearch("UTF-8 in UTF-32", utf32, euro, 6, 6, 1);
+    isOk &= expectSearch("UTF-16BE in UTF-32", utf32, utf16.substring(1, 8).ok(), 1, 1, 1);
+    isOk &= expectSearch("across chunks", rope, across, 3, 3, 1);
+    isOk &= expectSearch("across chunks, repeated", rope * 3, across, 3, 3 + 2 * rope.length(), 3);
+    isOk &= expectSearch("across a repetition", aa * 3, SuperString::Const("aaaaa"), 0, 1, 1);
+    isOk &= expectPieces("split, overlapping delimiters", SuperString::Const("aaaaa"), aa, {"", "", "a"});
+    isOk &= expectPieces("split, empty delimiter", aaaa, empty, {"aaaa"});
+    isOk &= expectPieces("split, long delimiter", aa, aaaa, {"aa"});
+    isOk &= expectPieces("split across chunks", rope, SuperString::Const("\xc3\xa9"),
+                         {"xxabc", "", "d", "dh", "llo \xe2\x82\xac\xf0\x9f\x98\x80"});
+    // enough partitions for the tasks to cut the pieces
+    std::string large;
+    while(large.size() < (3 << 20)) {
+        large += "line\n\n,,\r\n\r\nw\xc3\xb6rd\n";
+    }
+    SuperString largeString = SuperString::Const(large.c_str());
+    isOk &= expectEmptyPieces("empty lines", SuperString::Const("a\n\nb\r\n\r\n\n"), empty, 4);
+    isOk &= expectEmptyPieces("empty pieces", SuperString::Const(",a,,b,"), SuperString::Const(","), 4);
+    isOk &= expectEmptyPieces("empty pieces, long delimiter", aaaa + aa + aaaa, aa, 4);
+    isOk &= expectEmptyPieces("empty lines, in parallel", largeString, empty, 4);
+    isOk &= expectEmptyPieces("empty pieces, in parallel", largeString, SuperString::Const(","), 4);
+    // more than a megabyte, in one leaf or in chunks of another size than the partitions
+    std::string asciiText = partitioned("lorem ipsum dolor sit amet, ");
+    std::string utf8Text = partitioned("l\xc3\xb6rem \xe2\x82\xac ipsum \xf0\x9f\x98\x80 ");
+    SuperString chunked;
+    for(std::size_t i = 0; i < utf8Text.size();) {
+        std::size_t size = std::min(utf8Text.size() - i, (std::size_t) 100003);
+        while(i + size < utf8Text.size() && (utf8Text[i + size] & 0xc0) == 0x80) {
+            size++;
+        }
+        chunked = chunked + SuperString::Copy(utf8Text.data() + i, size);
+        i += size;
+    }
+    SuperString asciiLeaf = SuperString::Const(asciiText.c_str(), SuperString::Encoding::ASCII);
+    SuperString utf8Leaf = SuperString::Const(utf8Text.c_str());
+    for(const char *needle : {"needle", "xyx", "ipsum"}) {
+        isOk &= expectParallelSearch((std::string("in parallel, ASCII, ") + needle).c_str(), asciiLeaf, asciiText,
+                                     needle);
+        isOk &= expectParallelSearch((std::string("in parallel, UTF-8, ") + needle).c_str(), utf8Leaf, utf8Text,
+                                     needle);
+        isOk &= expectParallelSearch((std::string("in parallel, chunks, ") + needle).c_str(), chunked, utf8Text,
+                                     needle);
+    }
+    isOk &= expectAllNeedles("every needle, pieces of 1", "abracadabra cadabra abra", 1, SuperString::Encoding::ASCII);
+    isOk &= expectAllNeedles("every needle, pieces of 3", "abracadabra cadabra abra", 3, SuperString::Encoding::UTF8);
+    isOk &= expectAllNeedles("every needle, pieces of 5", "aabaaabaaaabaaaaab", 5, SuperString::Encoding::UTF8);
+    return isOk ? 0 : 1;
+}
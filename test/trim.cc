@@ -0,0 +1,66 @@
+#include <string>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// the UTF-16 bytes of [text] in the byte order of [order] ("BE" or "LE")
+static std::string encode(const char *order, const std::u16string &text) {
+    std::string bytes;
+    for(std::size_t i = 0; i < text.size(); i++) {
+        char high = (char) (text[i] >> 8), low = (char) text[i];
+        bytes += (order[0] == 'B') ? std::string(1, high) + low : std::string(1, low) + high;
+    }
+    return bytes;
+}
+
+// [string] trims to the UTF-8 [trimmed] on both ends, to [left] on the left and to [right] on the right
+static bool expectTrims(const std::string &name, const SuperString &string, const char *trimmed, const char *left,
+                        const char *right) {
+    SuperString both = string.trim(), onLeft = string.trimLeft(), onRight = string.trimRight();
+    SuperString expected = SuperString::Const(trimmed);
+    SuperString expectedLeft = SuperString::Const(left), expectedRight = SuperString::Const(right);
+    bool isOk = both.length() == expected.length() && both == expected &&
+                onLeft.length() == expectedLeft.length() && onLeft == expectedLeft &&
+                onRight.length() == expectedRight.length() && onRight == expectedRight;
+    return expect(name.c_str(), isOk, std::to_string(both.length()) + ", " + std::to_string(onLeft.length()) + ", " +
+                                      std::to_string(onRight.length()) + " code unit(s)");
+}
+
+int main(int argc, char const *argv[]) {
+    const char *spaces = " \t\n \xc2\xa0 ";
+    const char *text = " \xc2\xa0h\xc3\xa9\xf0\x9f\x98\x80 x\t ";
+    const char *trimmed = "h\xc3\xa9\xf0\x9f\x98\x80 x";
+    const char *left = "h\xc3\xa9\xf0\x9f\x98\x80 x\t ";
+    const char *right = " \xc2\xa0h\xc3\xa9\xf0\x9f\x98\x80 x";
+    const int spaces32[] = {' ', '\t', 0xA0, ' ', 0};
+    SuperString::Encoding BE = SuperString::Encoding::UTF16BE, LE = SuperString::Encoding::UTF16LE;
+
+    bool isOk = true;
+    isOk &= expectTrims("empty", SuperString::Const(""), "", "", "");
+    isOk &= expectTrims("white spaces, ASCII", SuperString::Const(" \t \n", SuperString::Encoding::ASCII), "", "", "");
+    isOk &= expectTrims("white spaces, UTF-8", SuperString::Const(spaces), "", "", "");
+    isOk &= expectTrims("white spaces, UTF-8, copy", SuperString::Copy(spaces), "", "", "");
+    isOk &= expectTrims("white spaces, UTF-32", SuperString::Const(spaces32), "", "", "");
+    isOk &= expectTrims("white spaces, substring", SuperString::Const("x \t x").substring(1, 4).ok(), "", "", "");
+    isOk &= expectTrims("white spaces, concatenation", SuperString::Const(spaces) + SuperString::Const(spaces),
+                        "", "", "");
+    isOk &= expectTrims("white spaces, multiple", SuperString::Const(spaces) * 3, "", "", "");
+    isOk &= expectTrims("text, UTF-8", SuperString::Const(text), trimmed, left, right);
+    isOk &= expectTrims("text, concatenation", SuperString::Const(" \xc2\xa0h\xc3\xa9") +
+                                               SuperString::Const("\xf0\x9f\x98\x80 x\t "), trimmed, left, right);
+    for(const char *order : {"BE", "LE"}) {
+        SuperString::Encoding encoding = (order[0] == 'B') ? BE : LE;
+        std::string name = std::string(", ") + order;
+        std::string blank = encode(order, u" \t\n   ");
+        std::string bytes = encode(order, u"  hé\U0001F600 x\t ");
+        isOk &= expectTrims("empty" + name, SuperString::ConstUTF16("", 0, encoding), "", "", "");
+        isOk &= expectTrims("white spaces" + name, SuperString::ConstUTF16(blank.data(), blank.size(), encoding),
+                            "", "", "");
+        isOk &= expectTrims("white spaces, copy" + name, SuperString::CopyUTF16(blank.data(), blank.size(), encoding),
+                            "", "", "");
+        isOk &= expectTrims("text" + name, SuperString::ConstUTF16(bytes.data(), bytes.size(), encoding),
+                            trimmed, left, right);
+        isOk &= expectTrims("text, copy" + name, SuperString::CopyUTF16(bytes.data(), bytes.size(), encoding),
+                            trimmed, left, right);
+    }
+    return isOk ? 0 : 1;
+}
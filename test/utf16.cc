@@ -0,0 +1,67 @@
+#include <sstream>
+#include <string>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// the UTF-16 [bytes] in the byte order of [order] ("BE" or "LE"), for the text "hé€\U0001F600" and [ascii]
+static std::string encode(const char *order, const std::string &ascii) {
+    std::u16string text = u"hé€\U0001F600" + std::u16string(ascii.begin(), ascii.end());
+    std::string bytes;
+    for(std::size_t i = 0; i < text.size(); i++) {
+        char high = (char) (text[i] >> 8), low = (char) text[i];
+        bytes += (order[0] == 'B') ? std::string(1, high) + low : std::string(1, low) + high;
+    }
+    return bytes;
+}
+
+// [string] is a single leaf in [encoding], holding the same text as the UTF-8 [expected], the BOM left out
+static bool expectDecoded(const char *name, const SuperString &string, SuperString::Encoding encoding,
+                          const std::string &expected) {
+    std::size_t chunks = 0;
+    bool isOk = true;
+    string.forEachChunk([&](const SuperString::Chunk &chunk) -> bool {
+        chunks++;
+        isOk &= chunk.encoding() == encoding;
+        return true;
+    });
+    SuperString utf8 = SuperString::Const(expected.c_str());
+    std::ostringstream stream;
+    stream << string;
+    isOk &= chunks <= 1 && string.length() == utf8.length() && string == utf8 && stream.str() == expected;
+    for(std::size_t i = 0; isOk && i < utf8.length(); i++) {
+        isOk &= string.codeUnitAt(i).ok() == utf8.codeUnitAt(i).ok();
+    }
+    return expect(name, isOk, std::to_string(string.length()) + " code unit(s)");
+}
+
+int main(int argc, char const *argv[]) {
+    std::string text = "h\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+    std::string ascii = " and some text, longer than a vector of code units";
+    std::string be = encode("BE", ""), le = encode("LE", "");
+    std::string bomBE = "\xfe\xff" + be, bomLE = "\xff\xfe" + le;
+    std::string oddLE = bomLE + "!";
+    std::string longLE = "\xff\xfe" + encode("LE", ascii + ascii);
+    SuperString::Encoding BE = SuperString::Encoding::UTF16BE, LE = SuperString::Encoding::UTF16LE;
+
+    bool isOk = true;
+    isOk &= expectDecoded("BOM, LE", SuperString::ConstUTF16(bomLE.data(), bomLE.size()), LE, text);
+    isOk &= expectDecoded("BOM, BE", SuperString::ConstUTF16(bomBE.data(), bomBE.size()), BE, text);
+    isOk &= expectDecoded("BOM, LE over BE", SuperString::ConstUTF16(bomLE.data(), bomLE.size(), BE), LE, text);
+    isOk &= expectDecoded("BOM, BE over LE", SuperString::ConstUTF16(bomBE.data(), bomBE.size(), LE), BE, text);
+    isOk &= expectDecoded("no BOM", SuperString::ConstUTF16(be.data(), be.size()), BE, text);
+    isOk &= expectDecoded("no BOM, LE", SuperString::ConstUTF16(le.data(), le.size(), LE), LE, text);
+    isOk &= expectDecoded("copy, BOM, LE", SuperString::CopyUTF16(bomLE.data(), bomLE.size()), LE, text);
+    isOk &= expectDecoded("copy, BOM, BE", SuperString::CopyUTF16(bomBE.data(), bomBE.size(), LE), BE, text);
+    isOk &= expectDecoded("copy, no BOM", SuperString::CopyUTF16(le.data(), le.size(), LE), LE, text);
+    isOk &= expectDecoded("BOM only", SuperString::ConstUTF16("\xff\xfe", 2), LE, "");
+    isOk &= expectDecoded("odd length", SuperString::ConstUTF16(oddLE.data(), oddLE.size()), LE, text);
+    isOk &= expectDecoded("long, LE", SuperString::ConstUTF16(longLE.data(), longLE.size()), LE,
+                          text + ascii + ascii);
+    isOk &= expectDecoded("long, LE, copy", SuperString::CopyUTF16(longLE.data(), longLE.size()), LE,
+                          text + ascii + ascii);
+    // a BOM only counts at the start, elsewhere it is a character
+    std::string inner = le + "\xff\xfe";
+    isOk &= expectDecoded("inner BOM", SuperString::ConstUTF16(inner.data(), inner.size(), LE), LE,
+                          text + "\xef\xbb\xbf");
+    return isOk ? 0 : 1;
+}
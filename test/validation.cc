@@ -0,0 +1,44 @@
+#include <string>
+#include "SuperString.hh"
+#include "expect.hh"
+
+static bool expectValid(const char *name, const char *chars, SuperString::Encoding encoding, std::size_t length) {
+    SuperString::Result<SuperString, SuperString::Error> result = SuperString::ConstValidated(chars, encoding);
+    bool isOk = result.isOk() && result.ok().length() == length;
+    return expect(name, isOk, "valid");
+}
+
+static bool expectInvalid(const char *name, const char *chars, SuperString::Encoding encoding, std::size_t offset) {
+    std::size_t invalidOffset = (std::size_t) -1;
+    SuperString::Result<SuperString, SuperString::Error> result = SuperString::CopyValidated(chars, encoding,
+                                                                                            &invalidOffset);
+    bool isOk = result.isErr() && result.err() == SuperString::Error::InvalidByteSequence && invalidOffset == offset;
+    return expect(name, isOk, "invalid at " + std::to_string(invalidOffset));
+}
+
+int main(int argc, char const *argv[]) {
+    // long enough to go through whole blocks of the vectorized validator
+    std::string text;
+    for(int i = 0; i < 100; i++) {
+        text += "h\xc3\xa9llo w\xc3\xb6rld \xe2\x82\xac \xf0\x9f\x98\x80 ";
+    }
+    std::string truncated = text + "\xe2\x82";
+    std::string surrogate = text + "\xed\xa0\x80";
+
+    bool isOk = true;
+    isOk &= expectValid("empty", "", SuperString::Encoding::UTF8, 0);
+    isOk &= expectValid("ascii", "Hello", SuperString::Encoding::ASCII, 5);
+    isOk &= expectValid("utf8", text.c_str(), SuperString::Encoding::UTF8, 1600);
+    isOk &= expectValid("utf16be", "\x00h\xd8\x3d\xde\x00\x00\x00", SuperString::Encoding::UTF16BE, 2);
+    isOk &= expectInvalid("ascii high bit", "Hel\xe9o", SuperString::Encoding::ASCII, 3);
+    isOk &= expectInvalid("stray continuation", "ab\x80", SuperString::Encoding::UTF8, 2);
+    isOk &= expectInvalid("overlong", "a\xc0\xaf", SuperString::Encoding::UTF8, 1);
+    isOk &= expectInvalid("above U+10FFFF", "\xf4\x90\x80\x80", SuperString::Encoding::UTF8, 0);
+    isOk &= expectInvalid("truncated", truncated.c_str(), SuperString::Encoding::UTF8, text.size());
+    isOk &= expectInvalid("surrogate", surrogate.c_str(), SuperString::Encoding::UTF8, text.size());
+    isOk &= expectInvalid("lone low surrogate", "\x00h\xde\x00\x00\x00", SuperString::Encoding::UTF16BE, 2);
+
+    SuperString string = SuperString::CopyValidated(text.c_str()).ok();
+    isOk &= string.codeUnitAt(1).ok() == 0xe9 && string.codeUnitAt(14).ok() == 0x1f600;
+    return isOk ? 0 : 1;
+}
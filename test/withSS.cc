@@ -1,32 +1,14 @@
-#include <stdio.h>
-#include <stdlib.h>
 #include <vector>
 
 #include "../src/SuperString.cc"
 
-int main() {
-    char *content;
-    // file reading
-    FILE *f = fopen("/Users/btwael/Downloads/longtextfile.txt", "r+");
-    fseek(f, 0, SEEK_END);
-    long fsize = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    content = (char *) malloc(fsize + 1);
-    fread(content, fsize, 1, f);
-    fclose(f);
-
-    SuperString string = SuperString::Copy(content, SuperString::Encoding::ASCII);
-    free(content);
+int main(int argc, char const *argv[]) {
+    // file mapping, pages are read in as the lines are split
+    const char *path = (argc > 1) ? argv[1] : "/Users/btwael/Downloads/longtextfile.txt";
+    SuperString string = SuperString::Map(path, SuperString::Encoding::ASCII, SuperString::Access::Sequential).ok();
 
     std::vector<SuperString> lines;
-    std::size_t last = 0;
-    for(std::size_t i = 0, length = string.length(); i < length; i++) {
-        int c = string.codeUnitAt(i).ok();
-        if(c == '\n') {
-            lines.push_back(string.substring(last, i).ok());
-            last = i + 1;
-        }
-    }
+    string.splitLines(lines);
 
     return 0;
 }
@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <unistd.h>
+#include "SuperString.hh"
+#include "expect.hh"
+
+// writes [string] to a temporary file, by its descriptor or by a `FILE *` holding [prefix] in its buffer,
+// and compares the bytes read back to [prefix] and [expected]
+static bool expectWritten(const char *name, const SuperString &string, const std::string &expected, bool isFile,
+                          const std::string &prefix = "") {
+    char path[] = "/tmp/SuperString.test.write.XXXXXX";
+    int fd = mkstemp(path);
+    std::FILE *file = fdopen(fd, "w+");
+    if(isFile) {
+        std::fputs(prefix.c_str(), file);
+    }
+    SuperString::Result<std::size_t, SuperString::Error> result = isFile ? string.writeTo(file) : string.writeTo(fd);
+    std::string content;
+    char buffer[4096];
+    std::rewind(file);
+    for(std::size_t count; (count = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+        content.append(buffer, count);
+    }
+    std::fclose(file);
+    unlink(path);
+    bool isOk = result.isOk() && result.ok() == expected.size() && content == prefix + expected;
+    return expect(name, isOk, std::to_string(content.size()) + " byte(s)");
+}
+
+int main(int argc, char const *argv[]) {
+    // more large chunks than the vectors of one `writev`, between small chunks in UTF-16 and UTF-32
+    std::deque<std::string> lines;
+    SuperString gathered;
+    std::string gatheredText;
+    int codeUnits[] = {0xe9, 0x1f600, '\n', 0};
+    SuperString utf32 = SuperString::Const(codeUnits);
+    SuperString utf16 = SuperString::Const("\x20\xac\x00\n", 4, SuperString::Encoding::UTF16BE);
+    for(std::size_t i = 0; i < 600; i++) {
+        lines.push_back(std::string(1024 + i, (char) ('a' + i % 26)) + "\n");
+        gathered = gathered + SuperString::Const(lines.back().c_str(), SuperString::Encoding::ASCII) +
+                   ((i % 2 == 0) ? utf16 : utf32);
+        gatheredText += lines.back() + ((i % 2 == 0) ? "\xe2\x82\xac\n" : "\xc3\xa9\xf0\x9f\x98\x80\n");
+    }
+    // text to transcode, many times the buffer, half of it ASCII
+    std::string utf16Bytes, utf16LEBytes, transcodedText;
+    for(std::size_t i = 0; i < 40000; i++) {
+        int codeUnit = (i % 64 < 32) ? 'a' + (int) (i % 26) : (i % 3 == 0) ? 0xe9 : 0x20ac;
+        utf16Bytes += (char) (codeUnit >> 8);
+        utf16Bytes += (char) codeUnit;
+        utf16LEBytes += (char) codeUnit;
+        utf16LEBytes += (char) (codeUnit >> 8);
+        transcodedText += (codeUnit < 0x80) ? std::string(1, (char) codeUnit) :
+                          (codeUnit == 0xe9) ? std::string("\xc3\xa9") : std::string("\xe2\x82\xac");
+    }
+    SuperString transcoded = SuperString::Const(utf16Bytes.data(), utf16Bytes.size(), SuperString::Encoding::UTF16BE) +
+                             SuperString::Const(utf16LEBytes.data(), utf16LEBytes.size(),
+                                                SuperString::Encoding::UTF16LE);
+    transcodedText += transcodedText;
+
+    bool isOk = true;
+    isOk &= expectWritten("empty", SuperString::Const(""), "", false);
+    isOk &= expectWritten("default", SuperString(), "", false);
+    isOk &= expectWritten("small, mixed", SuperString::Const("ab") + utf16 + utf32,
+                          "ab\xe2\x82\xac\n\xc3\xa9\xf0\x9f\x98\x80\n", false);
+    isOk &= expectWritten("gathered", gathered, gatheredText, false);
+    isOk &= expectWritten("gathered, to a file", gathered, gatheredText, true, "buffered ");
+    isOk &= expectWritten("transcoded", transcoded, transcodedText, false);
+    isOk &= expectWritten("transcoded, to a file", transcoded, transcodedText, true, "buffered ");
+    isOk &= expectWritten("repeated", (gathered + transcoded) * 2,
+                          gatheredText + transcodedText + gatheredText + transcodedText, false);
+    bool isError = SuperString::Const("text").writeTo(-1).isErr();
+    isOk &= expect("bad descriptor", isError, "error");
+    return isOk ? 0 : 1;
+}